@@ -34,17 +34,66 @@
 #define TO_USING_RECURSIVE_MUTEX    1
 #define TO_USING_SEMAPHORE          1
 #define TO_USING_QUEUE              1
+#define TO_USING_QUEUE_SET          1   /* select on several semaphores / queues */
+#define TO_USING_PRIO_QUEUE         1   /* message queue ordered by per-message priority */
+#define TO_USING_QUEUE_STAMP        0   /* per-item enqueue ticks, age-based drop, latency statistics */
+#define TO_USING_TOPIC              1   /* latest-value publish/subscribe topic */
+#define TO_USING_EVENT              1
+#define TO_USING_CONDVAR            1   /* condition variable paired with a mutex */
+#define TO_USING_RWLOCK             1   /* reader-writer lock, writer preference */
+#define TO_USING_MAILBOX            1   /* mailbox of t_uint32_t messages */
+#define TO_USING_BUFPOOL            1   /* reference-counted fixed-size buffers for zero-copy frames */
+#define TO_USING_BARRIER            1   /* N-party barrier, last arrival releases all */
+#define TO_USING_RENDEZVOUS         1   /* unbuffered channel, sender and receiver meet */
+#define TO_USING_MPOOL              1   /* O(1) fixed-size block pools, lock-free alloc/free */
+#define TO_USING_IPC_PRIO_BITMAP    0   /* O(1) PRIO wait queues, costs 4 * TO_THREAD_PRIORITY_MAX bytes per IPC object */
+#define TO_USING_IPC_FAST_PATH      1   /* uncontended sema/mutex take/give by CAS, interrupts stay enabled */
+
+#define TO_USING_STREAM             1   /* stream / message buffer (single reader, single writer) */
+#define TO_USING_NOTIFY             1   /* per-thread direct notifications */
 
 #define TO_DEBUG                    1
 
 #if (1 == (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX || TO_USING_SEMAPHORE || \
-     TO_USING_QUEUE)) && (0 == TO_USING_IPC)
-#error "TO_USING_IPC must be set to 1 when MUTEX/RECURSIVE_MUTEX/SEMAPHORE/QUEUE is enabled."
+     TO_USING_QUEUE || TO_USING_EVENT || TO_USING_CONDVAR || TO_USING_RWLOCK || \
+     TO_USING_MAILBOX || TO_USING_BUFPOOL || TO_USING_BARRIER || TO_USING_RENDEZVOUS || \
+     TO_USING_MPOOL)) && (0 == TO_USING_IPC)
+#error "TO_USING_IPC must be set to 1 when MUTEX/RECURSIVE_MUTEX/SEMAPHORE/QUEUE/EVENT/CONDVAR/RWLOCK/MAILBOX/BUFPOOL/BARRIER/RENDEZVOUS/MPOOL is enabled."
 #endif
 
 #if (0 == (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX || TO_USING_SEMAPHORE || \
-     TO_USING_QUEUE)) && (1 == TO_USING_IPC)
-#error " When TO_USING_IPC is enabled, at least one of MUTEX/RECURSIVE_MUTEX/SEMAPHORE/QUEUE must be set to 1."
+     TO_USING_QUEUE || TO_USING_EVENT || TO_USING_CONDVAR || TO_USING_RWLOCK || \
+     TO_USING_MAILBOX || TO_USING_BUFPOOL || TO_USING_BARRIER || TO_USING_RENDEZVOUS || \
+     TO_USING_MPOOL)) && (1 == TO_USING_IPC)
+#error " When TO_USING_IPC is enabled, at least one of MUTEX/RECURSIVE_MUTEX/SEMAPHORE/QUEUE/EVENT/CONDVAR/RWLOCK/MAILBOX/BUFPOOL/BARRIER/RENDEZVOUS/MPOOL must be set to 1."
+#endif
+
+#if (1 == TO_USING_IPC_PRIO_BITMAP) && (0 == TO_USING_IPC)
+#error "TO_USING_IPC must be set to 1 when TO_USING_IPC_PRIO_BITMAP is enabled."
+#endif
+
+#if (1 == TO_USING_QUEUE_SET) && (0 == TO_USING_QUEUE)
+#error "TO_USING_QUEUE must be set to 1 when TO_USING_QUEUE_SET is enabled."
+#endif
+
+#if (1 == TO_USING_PRIO_QUEUE) && (0 == TO_USING_QUEUE)
+#error "TO_USING_QUEUE must be set to 1 when TO_USING_PRIO_QUEUE is enabled."
+#endif
+
+#if (1 == TO_USING_QUEUE_STAMP) && (0 == TO_USING_QUEUE)
+#error "TO_USING_QUEUE must be set to 1 when TO_USING_QUEUE_STAMP is enabled."
+#endif
+
+#if (1 == TO_USING_TOPIC) && (0 == TO_USING_QUEUE)
+#error "TO_USING_QUEUE must be set to 1 when TO_USING_TOPIC is enabled."
+#endif
+
+#if (1 == TO_USING_RENDEZVOUS) && (0 == TO_USING_QUEUE)
+#error "TO_USING_QUEUE must be set to 1 when TO_USING_RENDEZVOUS is enabled."
+#endif
+
+#if (1 == TO_USING_CONDVAR) && (0 == (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX))
+#error "TO_USING_MUTEX or TO_USING_RECURSIVE_MUTEX must be set to 1 when TO_USING_CONDVAR is enabled."
 #endif
 
 #endif /* __TORTOS_CONFIG_H_ */
@@ -41,6 +41,8 @@
 #define IS_ENABLE_SEMA_TEST     1
 #define IS_ENABLE_MUTEX_TEST    0
 #define IS_ENABLE_QUEUE_TEST    0
+#define IS_ENABLE_STREAM_TEST   0
+#define IS_ENABLE_EVENT_TEST    0
 
 #define THREAD_STACK_SIZE       512
 
@@ -136,6 +138,41 @@ t_thread_t *queue_recv_thread_handle;
 void queue_send_thread(void *arg);
 void queue_recv_thread(void *arg);
 #endif /* IS_ENABLE_QUEUE_TEST */
+#if (IS_ENABLE_STREAM_TEST)
+#define TEST_STREAM_SIZE    256
+#define TEST_UART_DMA_SIZE  64
+static t_uint8_t uart_dma_buf[TEST_UART_DMA_SIZE];  /* USART1 RX DMA runs in circular mode */
+static t_uint16_t uart_dma_pos;
+#if (IS_ENABLE_STATIC_ALLOCATION_TEST)
+t_stream_t stream1;
+t_stream_t *stream1_handle = &stream1;
+t_uint8_t stream_pool[TEST_STREAM_SIZE];
+t_thread_t stream_recv_thread_instance;
+t_uint8_t stream_recv_thread_stack[THREAD_STACK_SIZE];
+#else
+t_stream_t *stream1_handle;
+t_thread_t *stream_recv_thread_handle;
+#endif /* IS_ENABLE_STATIC_ALLOCATION_TEST */
+void stream_recv_thread(void *arg);
+#endif /* IS_ENABLE_STREAM_TEST */
+#if (IS_ENABLE_EVENT_TEST)
+#define EVENT_SENSOR_READY  (1UL << 0)
+#define EVENT_LINK_UP       (1UL << 1)
+#if (IS_ENABLE_STATIC_ALLOCATION_TEST)
+t_ipc_t event1;
+t_ipc_t *event1_handle = &event1;
+t_thread_t event_set_thread_instance;
+t_thread_t event_wait_thread_instance;
+t_uint8_t event_set_thread_stack[THREAD_STACK_SIZE];
+t_uint8_t event_wait_thread_stack[THREAD_STACK_SIZE];
+#else
+t_ipc_t *event1_handle;
+t_thread_t *event_set_thread_handle;
+t_thread_t *event_wait_thread_handle;
+#endif /* IS_ENABLE_STATIC_ALLOCATION_TEST */
+void event_set_thread(void *arg);
+void event_wait_thread(void *arg);
+#endif /* IS_ENABLE_EVENT_TEST */
 
 /* USER CODE END 0 */
 
@@ -301,6 +338,66 @@ int main(void)
     t_thread_startup(queue_recv_thread_handle);   
 #endif /* IS_ENABLE_STATIC_ALLOCATION_TEST */   
 #endif /* IS_ENABLE_QUEUE_TEST */
+#if (IS_ENABLE_STREAM_TEST)
+#if (IS_ENABLE_STATIC_ALLOCATION_TEST)
+    T_STREAM_CREATE_STATIC(stream_pool, TEST_STREAM_SIZE, 16, &stream1);
+    t_thread_create_static(stream_recv_thread,
+                  stream_recv_thread_stack,
+                  THREAD_STACK_SIZE,
+                  11,
+                  NULL,
+                  500,
+                  &stream_recv_thread_instance);
+    t_thread_startup(&stream_recv_thread_instance);
+#else
+    T_STREAM_CREATE(TEST_STREAM_SIZE, 16, &stream1_handle);
+    t_thread_create(stream_recv_thread,
+                  THREAD_STACK_SIZE,
+                  11,
+                  NULL,
+                  500,
+                  &stream_recv_thread_handle);
+    t_thread_startup(stream_recv_thread_handle);
+#endif /* IS_ENABLE_STATIC_ALLOCATION_TEST */
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart1, uart_dma_buf, TEST_UART_DMA_SIZE);
+#endif /* IS_ENABLE_STREAM_TEST */
+#if (IS_ENABLE_EVENT_TEST)
+#if (IS_ENABLE_STATIC_ALLOCATION_TEST)
+    T_EVENT_CREATE_STATIC(TO_IPC_FLAG_PRIO, &event1);
+    t_thread_create_static(event_set_thread,
+                  event_set_thread_stack,
+                  THREAD_STACK_SIZE,
+                  12,
+                  NULL,
+                  500,
+                  &event_set_thread_instance);
+    t_thread_startup(&event_set_thread_instance);
+    t_thread_create_static(event_wait_thread,
+                  event_wait_thread_stack,
+                  THREAD_STACK_SIZE,
+                  11,
+                  NULL,
+                  500,
+                  &event_wait_thread_instance);
+    t_thread_startup(&event_wait_thread_instance);
+#else
+    T_EVENT_CREATE(TO_IPC_FLAG_PRIO, &event1_handle);
+    t_thread_create(event_set_thread,
+                  THREAD_STACK_SIZE,
+                  12,
+                  NULL,
+                  500,
+                  &event_set_thread_handle);
+    t_thread_startup(event_set_thread_handle);
+    t_thread_create(event_wait_thread,
+                  THREAD_STACK_SIZE,
+                  11,
+                  NULL,
+                  500,
+                  &event_wait_thread_handle);
+    t_thread_startup(event_wait_thread_handle);
+#endif /* IS_ENABLE_STATIC_ALLOCATION_TEST */
+#endif /* IS_ENABLE_EVENT_TEST */
     t_sched_start();
     /* USER CODE END 2 */
 
@@ -531,6 +628,71 @@ void queue_recv_thread(void *arg)
     }
 }
 #endif
+#if (IS_ENABLE_STREAM_TEST)
+/* Called on half/full transfer and on line idle; pos is the DMA write index */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t pos)
+{
+    t_uint8_t woken = 0;
+
+    if (huart != &huart1)
+        return;
+    if (pos != uart_dma_pos)
+    {
+        if (pos > uart_dma_pos)
+        {
+            T_STREAM_SEND_ISR(stream1_handle, &uart_dma_buf[uart_dma_pos], pos - uart_dma_pos, NULL, &woken);
+        }
+        else
+        {
+            T_STREAM_SEND_ISR(stream1_handle, &uart_dma_buf[uart_dma_pos], TEST_UART_DMA_SIZE - uart_dma_pos, NULL, &woken);
+            T_STREAM_SEND_ISR(stream1_handle, uart_dma_buf, pos, NULL, &woken);
+        }
+        uart_dma_pos = (pos == TEST_UART_DMA_SIZE) ? 0 : pos;
+    }
+    t_isr_yield(woken);     /* at most one PendSV for both writes */
+}
+void stream_recv_thread(void *arg)
+{
+    t_uint8_t buf[32];
+    t_uint32_t len;
+    while (1)
+    {
+        /* Wakes at 16 bytes, or after 100 ticks with whatever arrived */
+        if (T_OK == T_STREAM_RECV(stream1_handle, buf, sizeof(buf) - 1, &len, 100))
+        {
+            buf[len] = '\0';
+            DEBUG_OUT("stream recv, tick=%d, len=%d, data=%s", t_tick_get(), len, buf);
+        }
+    }
+}
+#endif
+#if (IS_ENABLE_EVENT_TEST)
+void event_set_thread(void *arg)
+{
+    while (1)
+    {
+        T_EVENT_SET(event1_handle, EVENT_SENSOR_READY);
+        DEBUG_OUT("event set sensor, tick=%d", t_tick_get());
+        t_mdelay(300);
+        T_EVENT_SET(event1_handle, EVENT_LINK_UP);
+        DEBUG_OUT("event set link, tick=%d", t_tick_get());
+        t_mdelay(700);
+    }
+}
+void event_wait_thread(void *arg)
+{
+    t_uint32_t recved;
+    while (1)
+    {
+        /* Both conditions in one wait; bits are consumed on return */
+        if (T_OK == T_EVENT_WAIT(event1_handle, EVENT_SENSOR_READY | EVENT_LINK_UP,
+                                 TO_EVENT_AND | TO_EVENT_CLEAR, 2000, &recved))
+            DEBUG_OUT("event wait ok, tick=%d, recved=0x%x", t_tick_get(), recved);
+        else
+            DEBUG_OUT("event wait timeout, tick=%d", t_tick_get());
+    }
+}
+#endif
 /* USER CODE END 4 */
 
 /**
@@ -46,6 +46,91 @@ t_uint32_t t_irq_disable(void);
  */
 void t_irq_enable(t_uint32_t disirq);
 
+/**
+ * @brief Atomic compare-and-swap on a halfword.
+ * @param addr Target.
+ * @param expected Value *addr must hold.
+ * @param desired Value stored if it does.
+ * @return 1 if swapped, 0 if *addr did not hold expected.
+ * @note LDREXH/STREXH on Cortex-M. Exception entry clears the exclusive
+ *       monitor, so plain stores made under t_irq_disable() by a handler or
+ *       another thread make the pending store fail instead of being lost.
+ */
+t_inline t_uint8_t t_atomic_cas16(volatile t_uint16_t *addr, t_uint16_t expected, t_uint16_t desired)
+{
+#if defined(__CC_ARM)
+    do
+    {
+        if (__ldrex(addr) != expected)
+        {
+            __clrex();
+            return 0;
+        }
+    } while (__strex(desired, addr));
+    T_BARRIER();
+    return 1;
+#elif defined(__GNUC__) || defined(__CLANG_ARM)
+    return __atomic_compare_exchange_n(addr, &expected, desired, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#else
+    t_uint32_t level = t_irq_disable();
+    t_uint8_t swapped = (*addr == expected);
+    if (swapped)
+        *addr = desired;
+    t_irq_enable(level);
+    return swapped;
+#endif
+}
+
+/**
+ * @brief Atomic compare-and-swap on a word, see t_atomic_cas16().
+ */
+t_inline t_uint8_t t_atomic_cas32(volatile t_uint32_t *addr, t_uint32_t expected, t_uint32_t desired)
+{
+#if defined(__CC_ARM)
+    do
+    {
+        if (__ldrex(addr) != expected)
+        {
+            __clrex();
+            return 0;
+        }
+    } while (__strex(desired, addr));
+    T_BARRIER();
+    return 1;
+#elif defined(__GNUC__) || defined(__CLANG_ARM)
+    return __atomic_compare_exchange_n(addr, &expected, desired, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#else
+    t_uint32_t level = t_irq_disable();
+    t_uint8_t swapped = (*addr == expected);
+    if (swapped)
+        *addr = desired;
+    t_irq_enable(level);
+    return swapped;
+#endif
+}
+
+/**
+ * @brief Atomic compare-and-swap on a pointer, see t_atomic_cas16().
+ */
+t_inline t_uint8_t t_atomic_casp(void *volatile *addr, void *expected, void *desired)
+{
+#if defined(__CC_ARM)
+    return t_atomic_cas32((volatile t_uint32_t *)addr, (t_uint32_t)expected, (t_uint32_t)desired);
+#elif defined(__GNUC__) || defined(__CLANG_ARM)
+    return __atomic_compare_exchange_n(addr, &expected, desired, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#else
+    t_uint32_t level = t_irq_disable();
+    t_uint8_t swapped = (*addr == expected);
+    if (swapped)
+        *addr = desired;
+    t_irq_enable(level);
+    return swapped;
+#endif
+}
+
 /**
  * @brief Initialize a thread stack frame (Cortex-M PSP layout).
  * @param stackaddr Top address of stack (end of buffer).
@@ -86,6 +171,8 @@ void t_sched_start(void);
 void t_sched_suspend(void);
 void t_sched_resume(void);
 void t_sched_switch(void);
+t_uint8_t t_sched_need_switch(void);
+void t_isr_yield(t_uint8_t woken);
 void t_sched_remove_thread(t_thread_t *thread);
 void t_sched_insert_thread(t_thread_t *thread);
 void t_thread_timeslice_expire(void);
@@ -141,6 +228,21 @@ t_status_t t_thread_delete(t_thread_t *thread);
 t_status_t t_thread_suspend(t_thread_t *thread);
 t_status_t t_thread_ctrl(t_thread_t *thread, t_uint32_t cmd, void *arg);
 t_status_t t_thread_restart(t_thread_t *thread);
+void t_thread_requeue(t_thread_t *thread, t_uint8_t priority);
+
+#if TO_USING_NOTIFY
+/* Direct-to-thread notifications (no wait list: only the owner waits) */
+t_status_t t_thread_notify(t_thread_t *thread, t_uint32_t value, t_uint8_t action);
+t_status_t t_thread_notify_isr(t_thread_t *thread, t_uint32_t value, t_uint8_t action, t_uint8_t *woken);
+t_status_t t_thread_notify_wait(t_uint32_t clear_on_entry, t_uint32_t clear_on_exit, t_uint32_t *value, t_int32_t timeout);
+t_status_t t_thread_notify_take(t_uint8_t clear, t_uint32_t *value, t_int32_t timeout);
+
+#define T_NOTIFY_GIVE(thread)                   t_thread_notify(thread, 0, TO_NOTIFY_INCREMENT)
+#define T_NOTIFY_GIVE_ISR(thread, woken)        t_thread_notify_isr(thread, 0, TO_NOTIFY_INCREMENT, woken)
+#define T_NOTIFY_TAKE(timeout)                  t_thread_notify_take(0, NULL, timeout)
+#define T_NOTIFY_SET_BITS(thread, bits)         t_thread_notify(thread, bits, TO_NOTIFY_SET_BITS)
+#define T_NOTIFY_WAIT_BITS(bits_out, timeout)   t_thread_notify_wait(0, 0xFFFFFFFFUL, bits_out, timeout)
+#endif /* TO_USING_NOTIFY */
 
 /* Timer subsystem */
 void t_timer_list_init(void);
@@ -155,10 +257,19 @@ t_status_t t_timer_ctrl(t_timer_t *timer, t_uint32_t cmd, void *arg);
 t_status_t t_timer_stop(t_timer_t *timer);
 t_status_t t_timer_start(t_timer_t *timer);
 void timeout_function(void *p);
+/* Deadline of a blocking call on the current thread's timer, kept across retries */
+void t_timeout_arm(t_int32_t timeout, t_uint8_t *armed);
+t_uint8_t t_timeout_passed(t_uint8_t armed);
+void t_timeout_done(t_uint8_t armed);
 
 #if TO_USING_IPC
-/* IPC: semaphore / mutex / message queue APIs */
+/* IPC: semaphore / mutex / message queue / event group APIs */
 t_status_t t_ipc_delete(t_ipc_t *ipc);
+void t_ipc_requeue(t_thread_t *thread, t_uint8_t priority);
+void t_ipc_unlink(t_thread_t *thread);
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+void t_mutex_requeue(t_thread_t *thread);
+#endif
 
 #if TO_USING_SEMAPHORE
 #if (TO_USING_STATIC_ALLOCATION)
@@ -168,6 +279,7 @@ t_status_t t_sema_create_static(t_uint16_t max_count, t_uint16_t init_count, t_u
 t_status_t t_sema_create(t_uint16_t max_count, t_uint16_t init_count, t_uint8_t mode, t_ipc_t **ipc_handle);
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 t_status_t t_sema_send(t_ipc_t *ipc);
+t_status_t t_sema_send_isr(t_ipc_t *ipc, t_uint8_t *woken);
 t_status_t t_sema_recv(t_ipc_t *ipc, t_int32_t timeout);
 
 #if (TO_USING_STATIC_ALLOCATION)
@@ -179,6 +291,7 @@ t_status_t t_sema_recv(t_ipc_t *ipc, t_int32_t timeout);
 #define T_SEMA_DELETE(sema)             t_ipc_delete(sema)
 #define T_SEMA_ACQUIRE(sema, timeout)   t_sema_recv(sema, timeout) 
 #define T_SEMA_RELEASE(sema)            t_sema_send(sema)  
+#define T_SEMA_RELEASE_ISR(sema, woken) t_sema_send_isr(sema, woken)
 #endif /* TO_USING_SEMAPHORE */
 
 #if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
@@ -188,15 +301,25 @@ t_status_t t_mutex_create_static_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_i
 #if (TO_USING_DYNAMIC_ALLOCATION)
 t_status_t t_mutex_create_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_ipc_t **ipc_handle);
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_mutex_create_ceiling_static_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_uint8_t ceiling, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_mutex_create_ceiling_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_uint8_t ceiling, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
 t_status_t t_mutex_send_base(t_ipc_t *ipc);
 t_status_t t_mutex_recv_base(t_ipc_t *ipc, t_int32_t timeout);
 #endif
 #if TO_USING_MUTEX
 #if (TO_USING_STATIC_ALLOCATION)
 #define T_MUTEX_CREATE_STATIC(mode, mutex)  t_mutex_create_static_base(IPC_MUTEX, mode, mutex)
+#define T_MUTEX_CEILING_CREATE_STATIC(mode, ceiling, mutex) \
+        t_mutex_create_ceiling_static_base(IPC_MUTEX, mode, ceiling, mutex)
 #endif /* TO_USING_STATIC_ALLOCATION */
 #if (TO_USING_DYNAMIC_ALLOCATION)
-#define T_MUTEX_CREATE(mode, mutex_handle)  t_mutex_create_static_base(IPC_MUTEX, mode, mutex_handle)
+#define T_MUTEX_CREATE(mode, mutex_handle)  t_mutex_create_base(IPC_MUTEX, mode, mutex_handle)
+#define T_MUTEX_CEILING_CREATE(mode, ceiling, mutex_handle) \
+        t_mutex_create_ceiling_base(IPC_MUTEX, mode, ceiling, mutex_handle)
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 #define T_MUTEX_DELETE(mutex)           t_ipc_delete(mutex)      
 #define T_MUTEX_ACQUIRE(mutex, timeout) t_mutex_recv_base(mutex, timeout) 
@@ -205,14 +328,40 @@ t_status_t t_mutex_recv_base(t_ipc_t *ipc, t_int32_t timeout);
 #if TO_USING_RECURSIVE_MUTEX
 #if (TO_USING_STATIC_ALLOCATION)
 #define T_MUTEX_RECURSIVE_CREATE_STATIC(mode, mutex)    t_mutex_create_static_base(IPC_RECURSIVE_MUTEX, mode, mutex)
+#define T_MUTEX_RECURSIVE_CEILING_CREATE_STATIC(mode, ceiling, mutex) \
+        t_mutex_create_ceiling_static_base(IPC_RECURSIVE_MUTEX, mode, ceiling, mutex)
 #endif /* TO_USING_STATIC_ALLOCATION */
 #if (TO_USING_DYNAMIC_ALLOCATION)
 #define T_MUTEX_RECURSIVE_CREATE(mode, mutex_handle)    t_mutex_create_base(IPC_RECURSIVE_MUTEX, mode, mutex_handle)
+#define T_MUTEX_RECURSIVE_CEILING_CREATE(mode, ceiling, mutex_handle) \
+        t_mutex_create_ceiling_base(IPC_RECURSIVE_MUTEX, mode, ceiling, mutex_handle)
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 #define T_MUTEX_RECURSIVE_DELETE(mutex)             t_ipc_delete(mutex) 
 #define T_MUTEX_RECURSIVE_ACQUIRE(mutex, timeout)   t_mutex_recv_base(mutex, timeout) 
 #define T_MUTEX_RECURSIVE_RELEASE(mutex)            t_mutex_send_base(mutex)
 #endif
+#if TO_USING_CONDVAR
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_cond_create_static(t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_cond_create(t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_cond_wait(t_ipc_t *cond, t_ipc_t *mutex, t_int32_t timeout);
+t_status_t t_cond_signal(t_ipc_t *cond);
+t_status_t t_cond_broadcast(t_ipc_t *cond);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_COND_CREATE_STATIC(mode, cond)    t_cond_create_static(mode, cond)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_COND_CREATE(mode, cond_handle)    t_cond_create(mode, cond_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_COND_DELETE(cond)                 t_ipc_delete(cond)
+#define T_COND_WAIT(cond, mutex, timeout)   t_cond_wait(cond, mutex, timeout)
+#define T_COND_SIGNAL(cond)                 t_cond_signal(cond)
+#define T_COND_BROADCAST(cond)              t_cond_broadcast(cond)
+#endif
 #if TO_USING_QUEUE
 #if (TO_USING_STATIC_ALLOCATION)
 t_status_t t_queue_create_static(void *queue_pool, t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc);
@@ -222,6 +371,24 @@ t_status_t t_queue_create(t_uint16_t queue_length, t_uint16_t item_size, t_uint8
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 t_status_t t_queue_send(t_ipc_t *ipc, const void *data, t_int32_t timeout);
 t_status_t t_queue_recv(t_ipc_t *ipc, void *data, t_int32_t timeout);
+t_status_t t_queue_send_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken);
+t_status_t t_queue_send_front(t_ipc_t *ipc, const void *data, t_int32_t timeout);
+t_status_t t_queue_send_front_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken);
+t_status_t t_queue_recv_isr(t_ipc_t *ipc, void *data, t_uint8_t *woken);
+t_status_t t_queue_overwrite(t_ipc_t *ipc, const void *data);
+t_status_t t_queue_overwrite_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken);
+t_uint32_t t_queue_dropped(t_ipc_t *ipc);
+t_status_t t_queue_reserve(t_ipc_t *ipc, void **slot, t_int32_t timeout);
+t_status_t t_queue_commit(t_ipc_t *ipc, void *slot);
+t_status_t t_queue_peek(t_ipc_t *ipc, void **slot, t_int32_t timeout);
+t_status_t t_queue_release(t_ipc_t *ipc, void *slot);
+t_status_t t_queue_send_n(t_ipc_t *ipc, const void *data, t_uint16_t count, t_uint16_t *sent, t_int32_t timeout);
+t_status_t t_queue_recv_n(t_ipc_t *ipc, void *data, t_uint16_t max_count, t_uint16_t min_count, t_uint16_t *received, t_int32_t timeout);
+#if TO_USING_QUEUE_STAMP
+t_status_t t_queue_stamp_attach(t_ipc_t *ipc, t_queue_stamp_t *stamp, t_uint32_t *ticks, t_uint32_t max_age);
+t_status_t t_queue_stats_get(t_ipc_t *ipc, t_queue_stats_t *stats);
+t_status_t t_queue_stats_reset(t_ipc_t *ipc);
+#endif
 
 #if (TO_USING_STATIC_ALLOCATION)
 #define T_QUEUE_CREATE_STATIC(queue_pool, queue_length, item_size, mode, queue)\
@@ -234,9 +401,345 @@ t_status_t t_queue_recv(t_ipc_t *ipc, void *data, t_int32_t timeout);
 #define T_QUEUE_DELETE(queue)               t_ipc_delete(queue) 
 #define T_QUEUE_SEND(queue, data, timeout)  t_queue_send(queue, data, timeout)    
 #define T_QUEUE_RECV(queue, data, timeout)  t_queue_recv(queue, data, timeout)
+#define T_QUEUE_SEND_ISR(queue, data, woken) t_queue_send_isr(queue, data, woken)
+#define T_QUEUE_RECV_ISR(queue, data, woken) t_queue_recv_isr(queue, data, woken)
+#define T_QUEUE_SEND_FRONT(queue, data, timeout) t_queue_send_front(queue, data, timeout)
+#define T_QUEUE_SEND_FRONT_ISR(queue, data, woken) t_queue_send_front_isr(queue, data, woken)
+#define T_QUEUE_OVERWRITE(queue, data)      t_queue_overwrite(queue, data)
+#define T_QUEUE_OVERWRITE_ISR(queue, data, woken) t_queue_overwrite_isr(queue, data, woken)
+#define T_QUEUE_DROPPED(queue)              t_queue_dropped(queue)
+#define T_QUEUE_RESERVE(queue, slot, timeout) t_queue_reserve(queue, slot, timeout)
+#define T_QUEUE_COMMIT(queue, slot)         t_queue_commit(queue, slot)
+#define T_QUEUE_PEEK(queue, slot, timeout)  t_queue_peek(queue, slot, timeout)
+#define T_QUEUE_RELEASE(queue, slot)        t_queue_release(queue, slot)
+#define T_QUEUE_SEND_N(queue, data, count, sent, timeout)\
+            t_queue_send_n(queue, data, count, sent, timeout)
+#define T_QUEUE_RECV_N(queue, data, max_count, min_count, received, timeout)\
+            t_queue_recv_n(queue, data, max_count, min_count, received, timeout)
+#if TO_USING_QUEUE_STAMP
+#define T_QUEUE_STAMP_ATTACH(queue, stamp, ticks, max_age)\
+            t_queue_stamp_attach(queue, stamp, ticks, max_age)
+#define T_QUEUE_STATS_GET(queue, stats)     t_queue_stats_get(queue, stats)
+#define T_QUEUE_STATS_RESET(queue)          t_queue_stats_reset(queue)
+#endif
+#endif
+#if TO_USING_PRIO_QUEUE
+/* Bytes of pool needed by t_pqueue_create_static() */
+#define T_PQUEUE_POOL_SIZE(queue_length, item_size)\
+            (((((t_uint32_t)(queue_length) * (item_size)) + 1UL) & ~1UL) +\
+             ((t_uint32_t)(queue_length) + TO_PQUEUE_PRIO_MAX) * sizeof(t_uint16_t))
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_pqueue_create_static(void *queue_pool, t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_pqueue_create(t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_pqueue_send(t_ipc_t *ipc, const void *data, t_uint8_t prio, t_int32_t timeout);
+t_status_t t_pqueue_recv(t_ipc_t *ipc, void *data, t_uint8_t *prio, t_int32_t timeout);
+t_status_t t_pqueue_send_isr(t_ipc_t *ipc, const void *data, t_uint8_t prio, t_uint8_t *woken);
+t_status_t t_pqueue_recv_isr(t_ipc_t *ipc, void *data, t_uint8_t *prio, t_uint8_t *woken);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_PQUEUE_CREATE_STATIC(queue_pool, queue_length, item_size, mode, queue)\
+            t_pqueue_create_static(queue_pool, queue_length, item_size, mode, queue)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_PQUEUE_CREATE(queue_length, item_size, mode, queue_handle)\
+            t_pqueue_create(queue_length, item_size, mode, queue_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_PQUEUE_DELETE(queue)                      t_ipc_delete(queue)
+#define T_PQUEUE_SEND(queue, data, prio, timeout)   t_pqueue_send(queue, data, prio, timeout)
+#define T_PQUEUE_RECV(queue, data, prio, timeout)   t_pqueue_recv(queue, data, prio, timeout)
+#define T_PQUEUE_SEND_ISR(queue, data, prio, woken) t_pqueue_send_isr(queue, data, prio, woken)
+#define T_PQUEUE_RECV_ISR(queue, data, prio, woken) t_pqueue_recv_isr(queue, data, prio, woken)
+#endif
+#if TO_USING_BUFPOOL
+/* Payload of a buffer */
+#define T_BUF_DATA(buf)     ((void *)((t_buf_t *)(buf) + 1))
+/* Bytes one buffer occupies in the pool (header + payload rounded to TO_ALIGN_SIZE) */
+#define T_BUF_STRIDE(buf_size)\
+            (sizeof(t_buf_t) + T_ALIGN_UP((t_uint32_t)(buf_size), TO_ALIGN_SIZE))
+/* Bytes of pool needed by t_bufpool_create_static() */
+#define T_BUFPOOL_POOL_SIZE(count, buf_size)    ((t_uint32_t)(count) * T_BUF_STRIDE(buf_size))
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_bufpool_create_static(void *pool, t_uint16_t count, t_uint16_t buf_size, t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_bufpool_create(t_uint16_t count, t_uint16_t buf_size, t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_bufpool_stats(t_ipc_t *ipc, t_uint16_t *free_now, t_uint16_t *min_free, t_uint32_t *allocs);
+t_status_t t_buf_alloc(t_ipc_t *ipc, t_buf_t **buf, t_int32_t timeout);
+t_status_t t_buf_alloc_isr(t_ipc_t *ipc, t_buf_t **buf);
+t_status_t t_buf_ref(t_buf_t *buf);
+t_status_t t_buf_free(t_buf_t *buf);
+t_status_t t_buf_free_isr(t_buf_t *buf, t_uint8_t *woken);
+t_status_t t_buf_chain(t_buf_t *head, t_buf_t *tail);
+#if (TO_USING_QUEUE || TO_USING_MAILBOX)
+t_status_t t_buf_send(t_ipc_t *ipc, t_buf_t *buf, t_int32_t timeout);
+t_status_t t_buf_share(t_ipc_t *ipc, t_buf_t *buf, t_int32_t timeout);
+t_status_t t_buf_recv(t_ipc_t *ipc, t_buf_t **buf, t_int32_t timeout);
+#endif
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_BUFPOOL_CREATE_STATIC(pool, count, buf_size, mode, bufpool)\
+            t_bufpool_create_static(pool, count, buf_size, mode, bufpool)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_BUFPOOL_CREATE(count, buf_size, mode, bufpool_handle)\
+            t_bufpool_create(count, buf_size, mode, bufpool_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_BUFPOOL_DELETE(bufpool)                   t_ipc_delete(bufpool)
+#define T_BUF_ALLOC(bufpool, buf, timeout)          t_buf_alloc(bufpool, buf, timeout)
+#define T_BUF_ALLOC_ISR(bufpool, buf)               t_buf_alloc_isr(bufpool, buf)
+#define T_BUF_REF(buf)                              t_buf_ref(buf)
+#define T_BUF_FREE(buf)                             t_buf_free(buf)
+#define T_BUF_FREE_ISR(buf, woken)                  t_buf_free_isr(buf, woken)
+#define T_BUF_CHAIN(head, tail)                     t_buf_chain(head, tail)
+#if (TO_USING_QUEUE || TO_USING_MAILBOX)
+#define T_BUF_SEND(ipc, buf, timeout)               t_buf_send(ipc, buf, timeout)
+#define T_BUF_SHARE(ipc, buf, timeout)              t_buf_share(ipc, buf, timeout)
+#define T_BUF_RECV(ipc, buf, timeout)               t_buf_recv(ipc, buf, timeout)
+#endif
+#endif
+#if TO_USING_TOPIC
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_topic_create_static(void *sample_buf, t_uint16_t sample_size, t_ipc_t *topic);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_topic_create(t_uint16_t sample_size, t_ipc_t **topic_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_topic_publish(t_ipc_t *topic, const void *data);
+t_status_t t_topic_publish_isr(t_ipc_t *topic, const void *data, t_uint8_t *woken);
+t_status_t t_topic_subscribe(t_ipc_t *topic, t_topic_sub_t *sub);
+t_status_t t_topic_read(t_topic_sub_t *sub, void *data, t_int32_t timeout);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_TOPIC_CREATE_STATIC(sample_buf, sample_size, topic)\
+            t_topic_create_static(sample_buf, sample_size, topic)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_TOPIC_CREATE(sample_size, topic_handle)   t_topic_create(sample_size, topic_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_TOPIC_DELETE(topic)                       t_ipc_delete(topic)
+#define T_TOPIC_PUBLISH(topic, data)                t_topic_publish(topic, data)
+#define T_TOPIC_PUBLISH_ISR(topic, data, woken)     t_topic_publish_isr(topic, data, woken)
+#define T_TOPIC_SUBSCRIBE(topic, sub)               t_topic_subscribe(topic, sub)
+#define T_TOPIC_READ(sub, data, timeout)            t_topic_read(sub, data, timeout)
+#endif
+#if TO_USING_BARRIER
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_barrier_create_static(t_uint16_t parties, t_ipc_t *barrier);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_barrier_create(t_uint16_t parties, t_ipc_t **barrier_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_barrier_wait(t_ipc_t *barrier, t_int32_t timeout);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_BARRIER_CREATE_STATIC(parties, barrier)   t_barrier_create_static(parties, barrier)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_BARRIER_CREATE(parties, barrier_handle)   t_barrier_create(parties, barrier_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_BARRIER_DELETE(barrier)                   t_ipc_delete(barrier)
+#define T_BARRIER_WAIT(barrier, timeout)            t_barrier_wait(barrier, timeout)
+#endif
+#if TO_USING_RENDEZVOUS
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_rendezvous_create_static(t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_rendezvous_create(t_uint16_t item_size, t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_rendezvous_send(t_ipc_t *ipc, const void *data, t_int32_t timeout);
+t_status_t t_rendezvous_recv(t_ipc_t *ipc, void *data, t_int32_t timeout);
+t_status_t t_rendezvous_send_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken);
+t_status_t t_rendezvous_recv_isr(t_ipc_t *ipc, void *data, t_uint8_t *woken);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_RENDEZVOUS_CREATE_STATIC(item_size, mode, rendezvous)\
+            t_rendezvous_create_static(item_size, mode, rendezvous)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_RENDEZVOUS_CREATE(item_size, mode, rendezvous_handle)\
+            t_rendezvous_create(item_size, mode, rendezvous_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_RENDEZVOUS_DELETE(rendezvous)                 t_ipc_delete(rendezvous)
+#define T_RENDEZVOUS_SEND(rendezvous, data, timeout)    t_rendezvous_send(rendezvous, data, timeout)
+#define T_RENDEZVOUS_RECV(rendezvous, data, timeout)    t_rendezvous_recv(rendezvous, data, timeout)
+#define T_RENDEZVOUS_SEND_ISR(rendezvous, data, woken)  t_rendezvous_send_isr(rendezvous, data, woken)
+#define T_RENDEZVOUS_RECV_ISR(rendezvous, data, woken)  t_rendezvous_recv_isr(rendezvous, data, woken)
+#endif
+#if TO_USING_MPOOL
+/* Bytes one block occupies in the pool (block_size rounded to TO_ALIGN_SIZE) */
+#define T_MPOOL_STRIDE(block_size)\
+            T_ALIGN_UP((t_uint32_t)(block_size) < sizeof(t_uint16_t) ? sizeof(t_uint16_t) : (t_uint32_t)(block_size), TO_ALIGN_SIZE)
+/* Bytes of pool needed by t_mpool_create_static() */
+#define T_MPOOL_POOL_SIZE(count, block_size)    ((t_uint32_t)(count) * T_MPOOL_STRIDE(block_size))
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_mpool_create_static(void *pool, t_uint16_t count, t_uint16_t block_size, t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_mpool_create(t_uint16_t count, t_uint16_t block_size, t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_mpool_alloc(t_ipc_t *ipc, void **block, t_int32_t timeout);
+t_status_t t_mpool_alloc_isr(t_ipc_t *ipc, void **block);
+t_status_t t_mpool_free(t_ipc_t *ipc, void *block);
+t_status_t t_mpool_free_isr(t_ipc_t *ipc, void *block, t_uint8_t *woken);
+t_uint16_t t_mpool_available(t_ipc_t *ipc);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_MPOOL_CREATE_STATIC(pool, count, block_size, mode, mpool)\
+            t_mpool_create_static(pool, count, block_size, mode, mpool)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_MPOOL_CREATE(count, block_size, mode, mpool_handle)\
+            t_mpool_create(count, block_size, mode, mpool_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_MPOOL_DELETE(mpool)                       t_ipc_delete(mpool)
+#define T_MPOOL_ALLOC(mpool, block, timeout)        t_mpool_alloc(mpool, block, timeout)
+#define T_MPOOL_ALLOC_ISR(mpool, block)             t_mpool_alloc_isr(mpool, block)
+#define T_MPOOL_FREE(mpool, block)                  t_mpool_free(mpool, block)
+#define T_MPOOL_FREE_ISR(mpool, block, woken)       t_mpool_free_isr(mpool, block, woken)
+#define T_MPOOL_AVAILABLE(mpool)                    t_mpool_available(mpool)
+#endif
+#if TO_USING_MAILBOX
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_mailbox_create_static(t_uint32_t *mailbox_pool, t_uint16_t size, t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_mailbox_create(t_uint16_t size, t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_mailbox_post(t_ipc_t *ipc, t_uint32_t msg, t_int32_t timeout);
+t_status_t t_mailbox_fetch(t_ipc_t *ipc, t_uint32_t *msg, t_int32_t timeout);
+t_status_t t_mailbox_post_isr(t_ipc_t *ipc, t_uint32_t msg, t_uint8_t *woken);
+t_status_t t_mailbox_fetch_isr(t_ipc_t *ipc, t_uint32_t *msg, t_uint8_t *woken);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_MAILBOX_CREATE_STATIC(mailbox_pool, size, mode, mailbox)\
+            t_mailbox_create_static(mailbox_pool, size, mode, mailbox)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_MAILBOX_CREATE(size, mode, mailbox_handle)\
+            t_mailbox_create(size, mode, mailbox_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_MAILBOX_DELETE(mailbox)                   t_ipc_delete(mailbox)
+#define T_MAILBOX_POST(mailbox, msg, timeout)       t_mailbox_post(mailbox, msg, timeout)
+#define T_MAILBOX_FETCH(mailbox, msg, timeout)      t_mailbox_fetch(mailbox, msg, timeout)
+#define T_MAILBOX_POST_ISR(mailbox, msg, woken)     t_mailbox_post_isr(mailbox, msg, woken)
+#define T_MAILBOX_FETCH_ISR(mailbox, msg, woken)    t_mailbox_fetch_isr(mailbox, msg, woken)
+#endif
+#if TO_USING_QUEUE_SET
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_queue_set_create_static(void *set_pool, t_uint16_t length, t_uint8_t mode, t_ipc_t *set);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_queue_set_create(t_uint16_t length, t_uint8_t mode, t_ipc_t **set_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_queue_set_add(t_ipc_t *set, t_ipc_t *member);
+t_status_t t_queue_set_remove(t_ipc_t *set, t_ipc_t *member);
+t_status_t t_queue_set_select(t_ipc_t *set, t_ipc_t **member, t_int32_t timeout);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_QUEUE_SET_CREATE_STATIC(set_pool, length, mode, set)\
+            t_queue_set_create_static(set_pool, length, mode, set)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_QUEUE_SET_CREATE(length, mode, set_handle)\
+            t_queue_set_create(length, mode, set_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_QUEUE_SET_DELETE(set)                 t_ipc_delete(set)
+#define T_QUEUE_SET_ADD(set, member)            t_queue_set_add(set, member)
+#define T_QUEUE_SET_REMOVE(set, member)         t_queue_set_remove(set, member)
+#define T_QUEUE_SET_SELECT(set, member, timeout) t_queue_set_select(set, member, timeout)
+#endif
+#if TO_USING_EVENT
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_event_create_static(t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_event_create(t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_event_send(t_ipc_t *ipc, t_uint32_t set);
+t_status_t t_event_send_isr(t_ipc_t *ipc, t_uint32_t set, t_uint8_t *woken);
+t_status_t t_event_clear(t_ipc_t *ipc, t_uint32_t clear);
+t_status_t t_event_recv(t_ipc_t *ipc, t_uint32_t set, t_uint8_t option, t_int32_t timeout, t_uint32_t *recved);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_EVENT_CREATE_STATIC(mode, event)  t_event_create_static(mode, event)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_EVENT_CREATE(mode, event_handle)  t_event_create(mode, event_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_EVENT_DELETE(event)               t_ipc_delete(event)
+#define T_EVENT_SET(event, set)             t_event_send(event, set)
+#define T_EVENT_SET_ISR(event, set, woken)  t_event_send_isr(event, set, woken)
+#define T_EVENT_CLEAR(event, clear)         t_event_clear(event, clear)
+#define T_EVENT_WAIT(event, set, option, timeout, recved)\
+            t_event_recv(event, set, option, timeout, recved)
+#endif
+#if TO_USING_RWLOCK
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_rwlock_create_static(t_uint8_t mode, t_ipc_t *ipc);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_rwlock_create(t_uint8_t mode, t_ipc_t **ipc_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_rwlock_read_lock(t_ipc_t *ipc, t_int32_t timeout);
+t_status_t t_rwlock_read_unlock(t_ipc_t *ipc);
+t_status_t t_rwlock_write_lock(t_ipc_t *ipc, t_int32_t timeout);
+t_status_t t_rwlock_write_unlock(t_ipc_t *ipc);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_RWLOCK_CREATE_STATIC(mode, rwlock)    t_rwlock_create_static(mode, rwlock)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_RWLOCK_CREATE(mode, rwlock_handle)    t_rwlock_create(mode, rwlock_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_RWLOCK_DELETE(rwlock)                 t_ipc_delete(rwlock)
+#define T_RWLOCK_READ_LOCK(rwlock, timeout)     t_rwlock_read_lock(rwlock, timeout)
+#define T_RWLOCK_READ_UNLOCK(rwlock)            t_rwlock_read_unlock(rwlock)
+#define T_RWLOCK_WRITE_LOCK(rwlock, timeout)    t_rwlock_write_lock(rwlock, timeout)
+#define T_RWLOCK_WRITE_UNLOCK(rwlock)           t_rwlock_write_unlock(rwlock)
 #endif
 
 #endif /* TO_USING_IPC */
+
+#if TO_USING_STREAM
+/* Stream buffer / message buffer APIs */
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_stream_create_static(void *buffer, t_uint32_t size, t_uint32_t trigger, t_uint8_t mode, t_stream_t *sb);
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_stream_create(t_uint32_t size, t_uint32_t trigger, t_uint8_t mode, t_stream_t **sb_handle);
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+t_status_t t_stream_delete(t_stream_t *sb);
+t_status_t t_stream_send(t_stream_t *sb, const void *data, t_uint32_t len, t_uint32_t *sent, t_int32_t timeout);
+t_status_t t_stream_send_isr(t_stream_t *sb, const void *data, t_uint32_t len, t_uint32_t *sent, t_uint8_t *woken);
+t_status_t t_stream_recv(t_stream_t *sb, void *data, t_uint32_t len, t_uint32_t *received, t_int32_t timeout);
+t_uint32_t t_stream_available(t_stream_t *sb);
+
+#if (TO_USING_STATIC_ALLOCATION)
+#define T_STREAM_CREATE_STATIC(buffer, size, trigger, sb)\
+            t_stream_create_static(buffer, size, trigger, TO_STREAM_BYTES, sb)
+#define T_MSGBUF_CREATE_STATIC(buffer, size, mb)\
+            t_stream_create_static(buffer, size, 1, TO_STREAM_MESSAGE, mb)
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+#define T_STREAM_CREATE(size, trigger, sb_handle)\
+            t_stream_create(size, trigger, TO_STREAM_BYTES, sb_handle)
+#define T_MSGBUF_CREATE(size, mb_handle)\
+            t_stream_create(size, 1, TO_STREAM_MESSAGE, mb_handle)
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+#define T_STREAM_DELETE(sb)                         t_stream_delete(sb)
+#define T_STREAM_SEND(sb, data, len, sent, timeout) t_stream_send(sb, data, len, sent, timeout)
+#define T_STREAM_SEND_ISR(sb, data, len, sent, woken) t_stream_send_isr(sb, data, len, sent, woken)
+#define T_STREAM_RECV(sb, data, len, received, timeout) t_stream_recv(sb, data, len, received, timeout)
+#define T_MSGBUF_DELETE(mb)                         t_stream_delete(mb)
+#define T_MSGBUF_SEND(mb, data, len, timeout)       t_stream_send(mb, data, len, NULL, timeout)
+#define T_MSGBUF_RECV(mb, data, len, received, timeout) t_stream_recv(mb, data, len, received, timeout)
+#endif /* TO_USING_STREAM */
+
 #if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)
 /**
  * @brief Find first (least significant) bit set.
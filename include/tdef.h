@@ -11,6 +11,7 @@
 #define __TDEF_H_
 
 #include "ToRTOS_Config.h"
+#include <stddef.h>
 
 /* Fixed width integer aliases */
 typedef signed char         t_int8_t;
@@ -80,6 +81,27 @@ typedef struct thread
     t_uint32_t  remaining_tick;     /**< Remaining time slice */
     t_int32_t   status;             /**< Thread lifecycle status flags */
     t_timer_t   timer;              /**< Per-thread sleep/timeout timer */
+#if TO_USING_IPC
+    void        *ipc_data;          /**< Caller buffer parked while blocked on a queue */
+    t_int32_t   ipc_status;         /**< Wait result written by the waker */
+    t_uint8_t   ipc_flag;           /**< Blocked as sender or receiver */
+    struct ipc  *pend_on;           /**< Object blocked on (NULL: none) */
+#endif
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    t_uint8_t   base_priority;      /**< Priority without inheritance */
+    t_list_t    held_list;          /**< Owned mutexes / write-held rwlocks that have waiters */
+#endif
+#if TO_USING_NOTIFY
+    t_uint32_t  notify_value;       /**< Direct notification value */
+    t_uint8_t   notify_state;       /**< TO_NOTIFY_STATE_* */
+#endif
+#if TO_USING_EVENT
+    t_uint32_t  event_set;          /**< Awaited mask; matched flags once woken */
+    t_uint8_t   event_info;         /**< TO_EVENT_AND / TO_EVENT_OR (| TO_EVENT_CLEAR) */
+#endif
+#if TO_USING_STREAM
+    t_uint8_t   stream_gone;        /**< Set when the stream buffer waited on is deleted */
+#endif
 
 #if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
     t_uint8_t   is_static_allocated;
@@ -99,10 +121,66 @@ typedef enum
     IPC_RECURSIVE_MUTEX,    /* Recursive Mutex */
 #endif
 #if TO_USING_QUEUE
-    IPC_QUEUE         /* Message Queue */
+    IPC_QUEUE,        /* Message Queue */
+#endif
+#if TO_USING_EVENT
+    IPC_EVENT,        /* Event Group */
+#endif
+#if TO_USING_CONDVAR
+    IPC_COND,         /* Condition Variable */
+#endif
+#if TO_USING_RWLOCK
+    IPC_RWLOCK,       /* Reader-Writer Lock */
+#endif
+#if TO_USING_MAILBOX
+    IPC_MAILBOX,      /* Mailbox of t_uint32_t messages */
+#endif
+#if TO_USING_PRIO_QUEUE
+    IPC_PRIO_QUEUE,   /* Message queue ordered by message priority */
+#endif
+#if TO_USING_TOPIC
+    IPC_TOPIC,        /* Latest-value publish/subscribe topic */
+#endif
+#if TO_USING_BUFPOOL
+    IPC_BUFPOOL,      /* Pool of reference-counted buffers */
+#endif
+#if TO_USING_BARRIER
+    IPC_BARRIER,      /* N-party barrier */
+#endif
+#if TO_USING_RENDEZVOUS
+    IPC_RENDEZVOUS,   /* Unbuffered rendezvous channel */
+#endif
+#if TO_USING_MPOOL
+    IPC_MPOOL,        /* Fixed-size block memory pool */
 #endif
 } t_ipc_type_t;
 
+/* Item copy routine selected per queue at creation */
+typedef void (*t_queue_copy_t)(t_uint8_t *dst, const t_uint8_t *src, size_t len);
+
+#if TO_USING_QUEUE_STAMP
+#define TO_QUEUE_LAT_BUCKETS 12    /* log2 latency histogram, last bucket >= 1024 ticks */
+
+/* Enqueue-to-dequeue latency of a queue, in ticks */
+typedef struct
+{
+    t_uint32_t  count;      /* Items delivered (direct handoffs count as 0 ticks) */
+    t_uint32_t  expired;    /* Items dropped for being older than max_age */
+    t_uint32_t  min;        /* Shortest latency */
+    t_uint32_t  max;        /* Longest latency */
+    t_uint64_t  sum;        /* Sum of latencies, average = sum / count */
+    t_uint32_t  hist[TO_QUEUE_LAT_BUCKETS]; /* [0]: 0 ticks, [b]: 2^(b-1)..2^b-1, last one open-ended */
+} t_queue_stats_t;
+
+/* Timestamp block attached to a queue by t_queue_stamp_attach() */
+typedef struct
+{
+    t_uint32_t      *ticks;     /* Enqueue tick of each ring slot (queue_length entries) */
+    t_uint32_t      max_age;    /* Receivers drop items older than this (0: never) */
+    t_queue_stats_t stats;
+} t_queue_stamp_t;
+#endif
+
 /* Queue buffer pointers */
 typedef struct
 {
@@ -110,6 +188,13 @@ typedef struct
     t_uint8_t *tail;       /* End marker */
     t_uint8_t *read_from;  /* Last read position */
     t_uint8_t *write_to;   /* Next write position */
+    t_uint8_t *reserved;   /* Slot handed out by t_queue_reserve (NULL: none) */
+    t_uint8_t *peeked;     /* Slot handed out by t_queue_peek (NULL: none) */
+    t_queue_copy_t copy;   /* Item copy kernel matched to item_size */
+    t_uint32_t dropped;    /* Oldest items discarded by t_queue_overwrite */
+#if TO_USING_QUEUE_STAMP
+    t_queue_stamp_t *stamp; /* Item timestamps and statistics (NULL: off) */
+#endif
 } t_queue_pointers_t;
 
 /* Mutex / Semaphore extra information */
@@ -117,36 +202,193 @@ typedef struct
 {
     t_thread_t  *holder;        /* Current mutex owner */
     t_uint16_t  recursive;      /* Recursive count for mutex */
-    t_uint8_t   original_prio;  /* Owner's original priority */
+    t_uint8_t   ceiling;        /* Priority ceiling (DUMMY_PRIORITY: inheritance) */
 } t_sema_data_t;
 
+#if TO_USING_RWLOCK
+/* Reader-writer lock state */
+typedef struct
+{
+    t_thread_t  *writer;          /* Thread holding write access (NULL: none) */
+    t_uint16_t  readers;          /* Threads holding read access */
+    t_uint16_t  writers_waiting;  /* Queued writers; new readers block while > 0 */
+    t_uint8_t   original_prio;    /* Writer's original priority (no mutex support) */
+} t_rwlock_data_t;
+#endif
+
+#if TO_USING_MAILBOX
+/* Mailbox ring of word-sized messages */
+typedef struct
+{
+    t_uint32_t  *pool;      /* Ring of length words */
+    t_uint16_t  in;         /* Next slot to post into */
+    t_uint16_t  out;        /* Next slot to fetch from */
+} t_mailbox_data_t;
+#endif
+
+#if TO_USING_PRIO_QUEUE
+/* Priority message queue: one chain of slots per message priority */
+typedef struct
+{
+    t_uint8_t      *items;  /* length slots of item_size bytes */
+    t_uint16_t     *link;   /* Per-slot successor in its level ring or the free chain */
+    t_uint16_t     *last;   /* Newest slot of each level, valid while its group bit is set */
+    t_queue_copy_t copy;    /* Item copy kernel matched to item_size */
+    t_uint32_t     group;   /* Bit p set: messages of priority p are queued */
+    t_uint16_t     free;    /* First free slot (TO_PQUEUE_NIL: full) */
+} t_pqueue_data_t;
+#endif
+
+#if TO_USING_BUFPOOL
+/* Buffer header; item_size payload bytes follow it (T_BUF_DATA) */
+typedef struct buf
+{
+    struct buf  *next;      /* Next buffer of a chained frame / free list link */
+    struct ipc  *pool;      /* Owning pool */
+    t_uint16_t  refcnt;     /* References held (0: free) */
+    t_uint16_t  len;        /* Payload bytes in use, maintained by the user */
+    t_uint8_t   chained;    /* 1: another buffer's next points here */
+} t_buf_t;
+
+/* Buffer pool state */
+typedef struct
+{
+    t_buf_t     *free;      /* Free list */
+    t_uint32_t  allocs;     /* Buffers handed out so far */
+    t_uint16_t  min_free;   /* Lowest free count seen (low-water mark) */
+} t_bufpool_data_t;
+#endif
+
+#if TO_USING_MPOOL
+#define TO_MPOOL_NIL        (0xFFFF)    /* End of the free list */
+
+/* Fixed-size block pool: free blocks hold the index of the next free one */
+typedef struct
+{
+    t_uint8_t           *blocks;    /* length blocks of stride bytes */
+    volatile t_uint32_t head;       /* Tag (high half) | first free index (low half) */
+    t_uint16_t          stride;     /* Block size rounded to TO_ALIGN_SIZE */
+} t_mpool_data_t;
+#endif
+
+#if TO_USING_TOPIC
+/* Topic: the latest published sample */
 typedef struct
+{
+    t_uint8_t           *sample;     /* item_size bytes */
+    t_queue_copy_t      copy;        /* Sample copy kernel matched to item_size */
+    volatile t_uint32_t generation;  /* Bumped by every publish (0: nothing yet) */
+} t_topic_data_t;
+#endif
+
+typedef struct ipc
 {
     t_ipc_type_t   type;          /* IPC type */
     union
     {
         t_queue_pointers_t queue;     /* Used for queue */
         t_sema_data_t   sema;      /* Used for semaphore/mutex */
+#if TO_USING_EVENT
+        t_uint32_t      event;     /* Used for event group: current flags */
+#endif
+#if TO_USING_RWLOCK
+        t_rwlock_data_t rwlock;    /* Used for reader-writer lock */
+#endif
+#if TO_USING_MAILBOX
+        t_mailbox_data_t mailbox;  /* Used for mailbox */
+#endif
+#if TO_USING_PRIO_QUEUE
+        t_pqueue_data_t pqueue;    /* Used for priority message queue */
+#endif
+#if TO_USING_TOPIC
+        t_topic_data_t  topic;     /* Used for publish/subscribe topic */
+#endif
+#if TO_USING_BUFPOOL
+        t_bufpool_data_t bufpool;  /* Used for buffer pool */
+#endif
+#if TO_USING_BARRIER
+        t_uint32_t      barrier;   /* Used for barrier: generation, bumped on every release */
+#endif
+#if TO_USING_RENDEZVOUS
+        t_queue_copy_t  rendezvous; /* Used for rendezvous: item copy kernel */
+#endif
+#if TO_USING_MPOOL
+        t_mpool_data_t  mpool;     /* Used for fixed-size block pool */
+#endif
     } u;
 
     t_list_t     wait_list;      /* Thread wait list */
+    t_uint16_t   wait_count[2];  /* Waiters per direction, indexed by TO_IPC_WAIT_RECV/SEND */
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    t_list_t     held;           /* Node in the owner's held_list while it lends priority */
+    t_thread_t   *held_by;       /* Thread whose held_list has that node (valid while linked) */
+#endif
+#if TO_USING_IPC_PRIO_BITMAP
+    t_uint32_t   prio_group;     /* Priorities that have a waiter (PRIO mode) */
+    t_list_t     *prio_head[TO_THREAD_PRIORITY_MAX]; /* First waiter of each priority */
+#endif
 
     t_uint16_t   msg_waiting;    /* Current item count or resource count */
     t_uint16_t   length;         /* Max number of items or max count */
     t_uint16_t   item_size;      /* Size of each item */
     t_uint8_t    status;         /* 1=valid, 0=deleted */
     t_uint8_t    mode;           /* FIFO / PRIO */
+#if TO_USING_QUEUE_SET
+    struct ipc   *set;           /* Queue set this object is registered in */
+    t_list_t     set_node;       /* Member: link in its set's list; set: head of that list */
+#endif
 #if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
     t_uint8_t   is_static_allocated;
 #endif
 } t_ipc_t;
-#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+
+#if TO_USING_TOPIC
+/* Subscriber state, owned by the reading thread */
+typedef struct
+{
+    t_ipc_t     *topic;      /* Topic subscribed to */
+    t_uint32_t  seen;        /* Generation of the last sample read */
+} t_topic_sub_t;
+#endif
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX || TO_USING_RWLOCK)
 #define DUMMY_PRIORITY  (0xFF)
 #endif
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+#define MUTEX_CONTENDED (2)     /* msg_waiting: held and waited on, release takes the lock */
+#define MUTEX_INHERIT_DEPTH_MAX (8) /* Blocked owners followed per inheritance update */
+#endif
 #endif /* TO_USING_IPC */
 
+#if TO_USING_STREAM
+/**
+ * @brief Stream / message buffer control block (one reader, one writer).
+ */
+typedef struct
+{
+    t_uint8_t   *buffer;            /**< Byte ring storage */
+    t_uint32_t  size;               /**< Ring size in bytes (one byte kept free) */
+    volatile t_uint32_t head;       /**< Next write index (writer side only) */
+    volatile t_uint32_t tail;       /**< Next read index (reader side only) */
+    t_uint32_t  trigger;            /**< Buffered bytes needed to wake the reader */
+    t_thread_t  *volatile reader;   /**< Reader blocked for data */
+    t_thread_t  *volatile writer;   /**< Writer blocked for space */
+    t_uint8_t   mode;               /**< TO_STREAM_BYTES / TO_STREAM_MESSAGE */
+    t_uint8_t   status;             /**< 1=valid, 0=deleted */
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    t_uint8_t   is_static_allocated;
+#endif
+} t_stream_t;
+#endif /* TO_USING_STREAM */
+
 #define t_inline static inline __attribute__((always_inline))
 
+/* Compiler barrier: orders plain memory accesses around lock-free publishes */
+#if defined(__CC_ARM)
+#define T_BARRIER()     __schedule_barrier()
+#else
+#define T_BARRIER()     __asm volatile ("" ::: "memory")
+#endif
+
 /* Thread status flags */
 #define TO_THREAD_READY       0x01
 #define TO_THREAD_SUSPEND     0x02
@@ -171,18 +413,57 @@ typedef struct
 #define TO_DEBUG_ERR  0x03
 #endif
 
+/* Nonzero if priority a outranks priority b */
+#if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)
+#define T_PRIO_HIGHER(a, b)   ((a) < (b))
+#else
+#define T_PRIO_HIGHER(a, b)   ((a) > (b))
+#endif
+
+#define TO_WAITING_FOREVER (0xFFFFFFFFUL) /**< Block forever */
+#define TO_WAITING_NO      ((t_int32_t)(0))  /**< Non-blocking */
+
 #if TO_USING_IPC
 #define TO_IPC_FLAG_FIFO  0x00 /**< FIFO ordering */
 #define TO_IPC_FLAG_PRIO  0x01 /**< Priority ordering */
-#define TO_WAITING_FOREVER (0xFFFFFFFFUL) /**< Block forever */
-#define TO_WAITING_NO      ((t_int32_t)(0))  /**< Non-blocking */
+
+#define TO_IPC_WAIT_RECV  0x00 /**< Blocked waiting for an item */
+#define TO_IPC_WAIT_SEND  0x01 /**< Blocked waiting for free space */
 
 #if TO_USING_RECURSIVE_MUTEX
 #define MUTEX_RECURSIVE_COUNT_MAX 0xFF
 #endif
 
+#if TO_USING_PRIO_QUEUE
+#define TO_PQUEUE_PRIO_MAX  32     /**< Message priorities 0..31, ordered like thread priorities */
+#define TO_PQUEUE_NIL       0xFFFF /**< End of a slot chain */
+#endif
+
+#if TO_USING_EVENT
+#define TO_EVENT_AND    0x01 /**< Wait for all bits of the mask */
+#define TO_EVENT_OR     0x02 /**< Wait for any bit of the mask */
+#define TO_EVENT_CLEAR  0x04 /**< Clear the matched bits on return */
+#endif
+
 #endif /* TO_USING_IPC */
 
+#if TO_USING_NOTIFY
+#define TO_NOTIFY_SET_BITS      0x01 /**< value |= arg */
+#define TO_NOTIFY_INCREMENT     0x02 /**< value += 1 (arg ignored) */
+#define TO_NOTIFY_OVERWRITE     0x03 /**< value = arg */
+#define TO_NOTIFY_NO_OVERWRITE  0x04 /**< value = arg unless one is pending */
+
+#define TO_NOTIFY_STATE_NONE    0x00
+#define TO_NOTIFY_STATE_WAITING 0x01
+#define TO_NOTIFY_STATE_PENDING 0x02
+#endif /* TO_USING_NOTIFY */
+
+#if TO_USING_STREAM
+#define TO_STREAM_BYTES    0x00 /**< Byte stream with trigger level */
+#define TO_STREAM_MESSAGE  0x01 /**< Length-prefixed messages */
+#define TO_STREAM_MSG_HDR  2    /**< Bytes of length prefix per message */
+#endif /* TO_USING_STREAM */
+
 #ifndef __weak
 #define __weak  __attribute__((weak))
 #endif
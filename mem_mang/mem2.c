@@ -0,0 +1,558 @@
+/**
+ * @file mem2.c
+ * @brief Two-Level Segregated Fit (TLSF) allocator for ToRTOS.
+ *
+ * A dynamic memory allocator with bounded, constant-time allocation and
+ * release, intended for real-time use where the search of mem0.c (size
+ * ordered list, O(n) insert) and mem1.c (first fit, O(fragments)) cannot
+ * be bounded:
+ *
+ *  1. **Segregated free lists** – free blocks are kept in
+ *     @c T_TLSF_FL_COUNT x @c T_TLSF_SL_COUNT lists.  The first level
+ *     splits sizes by power of two, the second level splits every power
+ *     of two into @c T_TLSF_SL_COUNT equal ranges.
+ *
+ *  2. **Two-level bitmap** – one bit per non-empty list.  Finding a list
+ *     that is guaranteed to fit is two find-first-set operations, no
+ *     list is ever walked.
+ *
+ *  3. **Immediate coalescing** – a released block is merged with its
+ *     free physical neighbours before it is filed, so the pool never
+ *     holds two adjacent free blocks.  Neighbours are found in O(1)
+ *     through the size field (next) and a back pointer (previous).
+ *
+ *  4. **Multi-instance support** – each @c t_tlsf_pool_t is
+ *     self-contained.  A default singleton pool backs the legacy
+ *     @c t_malloc / @c t_free API, as in mem1.c.
+ *
+ * Block layout (every block starts with this header):
+ *   @code
+ *   [prev_phys]   →  previous block in address order (valid while it is free)
+ *   [size]        →  payload bytes | T_TLSF_FREE | T_TLSF_PREV_FREE
+ *   [next_free]   ┐  free list links, stored in the payload of free
+ *   [prev_free]   ┘  blocks only
+ *   @endcode
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author
+ *   Donzel
+ */
+#include "ToRTOS.h"
+#include <stddef.h>
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+
+/* ================================================================== */
+/*                         Configuration                              */
+/* ================================================================== */
+#define T_BYTE_ALIGN                8u
+#define T_BYTE_ALIGN_MASK           (T_BYTE_ALIGN - 1u)
+#define T_BYTE_ALIGN_LOG2           3u
+
+/* Second level: each power of two is split into 2^T_TLSF_SL_LOG2 lists. */
+#define T_TLSF_SL_LOG2              4u
+#define T_TLSF_SL_COUNT             (1u << T_TLSF_SL_LOG2)
+
+/*
+ * First level: largest block is just under 2^(T_TLSF_FL_MAX + 1) bytes.
+ * Sizes below T_TLSF_SMALL_BLOCK share first-level list 0, linearly
+ * split into T_TLSF_SL_COUNT ranges of T_BYTE_ALIGN bytes.
+ */
+#ifndef T_TLSF_FL_MAX
+#define T_TLSF_FL_MAX               18u     /* blocks up to 512 KiB */
+#endif
+#define T_TLSF_FL_SHIFT             (T_TLSF_SL_LOG2 + T_BYTE_ALIGN_LOG2)
+#define T_TLSF_FL_COUNT             (T_TLSF_FL_MAX - T_TLSF_FL_SHIFT + 2u)
+#define T_TLSF_SMALL_BLOCK          (1u << T_TLSF_FL_SHIFT)
+#define T_TLSF_BLOCK_MAX            ((((size_t)1u) << (T_TLSF_FL_MAX + 1u)) - T_BYTE_ALIGN)
+
+/* Bitmaps are one word per level. */
+typedef char t_tlsf_fl_count_check[(T_TLSF_FL_COUNT <= 32u && T_TLSF_SL_COUNT <= 32u) ? 1 : -1];
+
+typedef struct t_tlsf_block
+{
+    struct t_tlsf_block *prev_phys;  /**< Previous block in address order (valid if T_TLSF_PREV_FREE) */
+    size_t              size;        /**< Payload bytes | flag bits */
+    struct t_tlsf_block *next_free;  /**< Free list links, payload of free blocks only */
+    struct t_tlsf_block *prev_free;
+} t_tlsf_block_t;
+
+/* Header kept by every block; the free list links live in the payload. */
+#define T_TLSF_HEADER_SIZE          (offsetof(t_tlsf_block_t, next_free))
+/* Smallest payload: must hold the free list links. */
+#define T_TLSF_PAYLOAD_MIN          ((sizeof(t_tlsf_block_t) - T_TLSF_HEADER_SIZE + T_BYTE_ALIGN_MASK) & ~((size_t)T_BYTE_ALIGN_MASK))
+
+/* Header must keep the payload aligned. */
+typedef char t_tlsf_header_check[((T_TLSF_HEADER_SIZE & T_BYTE_ALIGN_MASK) == 0u) ? 1 : -1];
+
+/* Flag bits in the low bits of size (sizes are T_BYTE_ALIGN multiples). */
+#define T_TLSF_FREE                 ((size_t)1u)
+#define T_TLSF_PREV_FREE            ((size_t)2u)
+#define T_TLSF_FLAGS                (T_TLSF_FREE | T_TLSF_PREV_FREE)
+
+/* Pool identification magic. */
+#define T_TLSF_POOL_MAGIC           ((t_uint32_t) 0x544C5346UL)   /* "TLSF" */
+
+/* ================================================================== */
+/*                     Block header access macros                     */
+/* ================================================================== */
+#define BLOCK_SIZE(blk)             ((blk)->size & ~T_TLSF_FLAGS)
+#define BLOCK_IS_FREE(blk)          ((blk)->size & T_TLSF_FREE)
+#define BLOCK_PAYLOAD(blk)          ((void *)((t_uint8_t *)(blk) + T_TLSF_HEADER_SIZE))
+#define BLOCK_FROM_PAYLOAD(ptr)     ((t_tlsf_block_t *)((t_uint8_t *)(ptr) - T_TLSF_HEADER_SIZE))
+/** Next block in address order (the end sentinel has none). */
+#define BLOCK_NEXT_PHYS(blk)        ((t_tlsf_block_t *)((t_uint8_t *)(blk) + T_TLSF_HEADER_SIZE + BLOCK_SIZE(blk)))
+
+/**
+ * @brief TLSF pool control block.
+ *
+ * Holds the bitmaps and list heads; the managed memory is separate and
+ * supplied by the caller.  Multiple pools can coexist independently.
+ */
+typedef struct t_tlsf_pool
+{
+    t_uint32_t      fl_bitmap;                      /**< Bit f: sl_bitmap[f] != 0 */
+    t_uint32_t      sl_bitmap[T_TLSF_FL_COUNT];     /**< Bit s: blocks[f][s] non-empty */
+    t_tlsf_block_t  *blocks[T_TLSF_FL_COUNT][T_TLSF_SL_COUNT]; /**< Free list heads */
+    t_uint8_t       *pool_start;                    /**< First block */
+    t_uint8_t       *pool_end;                      /**< End sentinel block */
+    size_t          available;                      /**< Payload bytes held by free blocks */
+    t_uint32_t      pool_id;                        /**< Magic number for pool validation */
+} t_tlsf_pool_t;
+
+/* ── TLSF pool multi-instance API ── */
+t_status_t  t_tlsf_pool_create(t_tlsf_pool_t *pool, void *pool_start, size_t pool_size);
+void        *t_tlsf_pool_alloc(t_tlsf_pool_t *pool, size_t size);
+t_status_t  t_tlsf_pool_free(t_tlsf_pool_t *pool, void *ptr);
+size_t      t_tlsf_pool_available(t_tlsf_pool_t *pool);
+t_status_t  t_tlsf_pool_delete(t_tlsf_pool_t *pool);
+
+/* ================================================================== */
+/*                       Bit scan and size mapping                    */
+/* ================================================================== */
+
+/**
+ * @brief Index of the most significant set bit (word must be non-zero).
+ */
+static t_uint32_t _t_tlsf_fls(t_uint32_t word)
+{
+#if defined(__CC_ARM)
+    return 31u - __clz(word);
+#elif defined(__GNUC__) || defined(__CLANG_ARM)
+    return 31u - (t_uint32_t)__builtin_clz(word);
+#else
+    t_uint32_t bit = 0u;
+    while (word >>= 1)
+        bit++;
+    return bit;
+#endif
+}
+
+/**
+ * @brief Index of the least significant set bit (word must be non-zero).
+ */
+static t_uint32_t _t_tlsf_ffs(t_uint32_t word)
+{
+    return _t_tlsf_fls(word & (~word + 1u));
+}
+
+/**
+ * @brief List that a free block of @p size bytes is filed in.
+ */
+static void _t_tlsf_mapping(size_t size, t_uint32_t *fl, t_uint32_t *sl)
+{
+    t_uint32_t f;
+
+    if (size < T_TLSF_SMALL_BLOCK)
+    {
+        *fl = 0u;
+        *sl = (t_uint32_t)size / (T_TLSF_SMALL_BLOCK / T_TLSF_SL_COUNT);
+        return;
+    }
+    f = _t_tlsf_fls((t_uint32_t)size);
+    *sl = ((t_uint32_t)(size >> (f - T_TLSF_SL_LOG2))) ^ T_TLSF_SL_COUNT;
+    *fl = f - (T_TLSF_FL_SHIFT - 1u);
+}
+
+/**
+ * @brief First list whose every block can hold @p size bytes.
+ *
+ * The size is rounded up to the next list boundary so that any block
+ * taken from the returned list (or a higher one) fits without a walk.
+ */
+static void _t_tlsf_mapping_search(size_t size, t_uint32_t *fl, t_uint32_t *sl)
+{
+    if (size >= T_TLSF_SMALL_BLOCK)
+        size += (((size_t)1u) << (_t_tlsf_fls((t_uint32_t)size) - T_TLSF_SL_LOG2)) - 1u;
+    _t_tlsf_mapping(size, fl, sl);
+}
+
+/* ================================================================== */
+/*                        Free list maintenance                       */
+/* ================================================================== */
+
+static void _t_tlsf_insert(t_tlsf_pool_t *pool, t_tlsf_block_t *block)
+{
+    t_uint32_t fl, sl;
+    t_tlsf_block_t *head;
+
+    _t_tlsf_mapping(BLOCK_SIZE(block), &fl, &sl);
+    head = pool->blocks[fl][sl];
+    block->next_free = head;
+    block->prev_free = NULL;
+    if (head)
+        head->prev_free = block;
+    pool->blocks[fl][sl] = block;
+    pool->fl_bitmap |= (1u << fl);
+    pool->sl_bitmap[fl] |= (1u << sl);
+    pool->available += BLOCK_SIZE(block);
+}
+
+static void _t_tlsf_remove(t_tlsf_pool_t *pool, t_tlsf_block_t *block)
+{
+    t_uint32_t fl, sl;
+
+    _t_tlsf_mapping(BLOCK_SIZE(block), &fl, &sl);
+    if (block->next_free)
+        block->next_free->prev_free = block->prev_free;
+    if (block->prev_free)
+        block->prev_free->next_free = block->next_free;
+    else
+    {
+        pool->blocks[fl][sl] = block->next_free;
+        if (!block->next_free)
+        {
+            pool->sl_bitmap[fl] &= ~(1u << sl);
+            if (0u == pool->sl_bitmap[fl])
+                pool->fl_bitmap &= ~(1u << fl);
+        }
+    }
+    pool->available -= BLOCK_SIZE(block);
+}
+
+/**
+ * @brief Mark a block free/used and mirror the state into its successor.
+ */
+static void _t_tlsf_set_free(t_tlsf_block_t *block, t_uint8_t is_free)
+{
+    t_tlsf_block_t *next = BLOCK_NEXT_PHYS(block);
+
+    if (is_free)
+    {
+        block->size |= T_TLSF_FREE;
+        next->size |= T_TLSF_PREV_FREE;
+        next->prev_phys = block;
+    }
+    else
+    {
+        block->size &= ~T_TLSF_FREE;
+        next->size &= ~T_TLSF_PREV_FREE;
+    }
+}
+
+/* ================================================================== */
+/*                       TLSF Pool Public API                         */
+/* ================================================================== */
+
+/**
+ * @brief Create (initialise) a TLSF memory pool.
+ *
+ *   @verbatim
+ *   Pool memory layout after creation:
+ *
+ *   aligned_start                                   pool_end
+ *   ┌───────────┬──────────┬─── ─── ─── ───┬───────────┬──────────┐
+ *   │ prev_phys │ size|FREE│   free space  │ prev_phys │ 0 | PREV │
+ *   │ = NULL    │          │               │ → first   │   _FREE  │
+ *   └───────────┴──────────┴─── ─── ─── ───┴───────────┴──────────┘
+ *    ← one free block covering the pool →   sentinel (always used)
+ *   @endverbatim
+ *
+ * Memory beyond the largest block size (T_TLSF_BLOCK_MAX) is left unused.
+ *
+ * @param pool       Pointer to a caller-provided pool control block.
+ * @param pool_start Start address of the raw memory region.
+ * @param pool_size  Total byte count of the raw memory region.
+ * @return T_OK on success, T_INVALID on bad parameters.
+ */
+t_status_t t_tlsf_pool_create(t_tlsf_pool_t *pool,
+                              void          *pool_start,
+                              size_t         pool_size)
+{
+    t_uint8_t      *aligned_start;
+    size_t          aligned_size;
+    size_t          block_size;
+    t_tlsf_block_t *first;
+    t_tlsf_block_t *end;
+    t_uint32_t      fl, sl;
+
+    if (!pool || !pool_start)
+        return T_INVALID;
+
+    /* Align the start address upward. */
+    aligned_start = (t_uint8_t *)
+        (((size_t)pool_start + T_BYTE_ALIGN_MASK) & ~((size_t)T_BYTE_ALIGN_MASK));
+    if (pool_size < (size_t)(aligned_start - (t_uint8_t *)pool_start)
+                    + 2u * T_TLSF_HEADER_SIZE + T_TLSF_PAYLOAD_MIN)
+        return T_INVALID;
+
+    aligned_size = pool_size - (size_t)(aligned_start - (t_uint8_t *)pool_start);
+    aligned_size &= ~((size_t)T_BYTE_ALIGN_MASK);
+
+    block_size = aligned_size - 2u * T_TLSF_HEADER_SIZE;
+    if (block_size > T_TLSF_BLOCK_MAX)
+        block_size = T_TLSF_BLOCK_MAX;
+
+    pool->fl_bitmap = 0u;
+    for (fl = 0u; fl < T_TLSF_FL_COUNT; fl++)
+    {
+        pool->sl_bitmap[fl] = 0u;
+        for (sl = 0u; sl < T_TLSF_SL_COUNT; sl++)
+            pool->blocks[fl][sl] = NULL;
+    }
+
+    first = (t_tlsf_block_t *)aligned_start;
+    first->prev_phys = NULL;
+    first->size = block_size;               /* previous block: none, never free */
+
+    /* End sentinel: size 0, always used, stops the merge of the last block. */
+    end = BLOCK_NEXT_PHYS(first);
+    end->size = 0u;
+
+    pool->pool_start = aligned_start;
+    pool->pool_end   = (t_uint8_t *)end;
+    pool->available  = 0u;
+
+    _t_tlsf_set_free(first, 1u);
+    _t_tlsf_insert(pool, first);
+    pool->pool_id = T_TLSF_POOL_MAGIC;
+
+    return T_OK;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Allocate memory from a TLSF pool in bounded time.
+ *
+ * Two bitmap lookups find a non-empty list whose blocks all fit; its
+ * first block is taken and the tail beyond the request is split off
+ * and filed as a new free block.
+ *
+ * @param pool  Pool control block.
+ * @param size  Requested payload bytes (0 → returns NULL).
+ * @return Pointer to usable memory (T_BYTE_ALIGN aligned), or NULL.
+ */
+void *t_tlsf_pool_alloc(t_tlsf_pool_t *pool, size_t size)
+{
+    t_tlsf_block_t *block = NULL;
+    t_tlsf_block_t *rest;
+    t_uint32_t      fl, sl, map;
+
+    if (!pool || T_TLSF_POOL_MAGIC != pool->pool_id || 0u == size || size > T_TLSF_BLOCK_MAX)
+        return NULL;
+
+    /* Round up to alignment boundary and to room for the free links. */
+    size = (size + T_BYTE_ALIGN_MASK) & ~((size_t)T_BYTE_ALIGN_MASK);
+    if (size < T_TLSF_PAYLOAD_MIN)
+        size = T_TLSF_PAYLOAD_MIN;
+
+    _t_tlsf_mapping_search(size, &fl, &sl);
+    if (fl >= T_TLSF_FL_COUNT)
+        return NULL;
+
+    t_sched_suspend();
+    {
+        /* A list in the same first level at or above sl, else the next
+           non-empty first level. */
+        map = pool->sl_bitmap[fl] & (~0u << sl);
+        if (0u == map)
+        {
+            map = (fl + 1u < T_TLSF_FL_COUNT) ? (pool->fl_bitmap & (~0u << (fl + 1u))) : 0u;
+            if (map)
+            {
+                fl = _t_tlsf_ffs(map);
+                map = pool->sl_bitmap[fl];
+            }
+        }
+        if (map)
+        {
+            sl = _t_tlsf_ffs(map);
+            block = pool->blocks[fl][sl];
+            _t_tlsf_remove(pool, block);
+
+            /* ── Split if the leftover can stand as a block ── */
+            if (BLOCK_SIZE(block) >= size + T_TLSF_HEADER_SIZE + T_TLSF_PAYLOAD_MIN)
+            {
+                rest = (t_tlsf_block_t *)((t_uint8_t *)BLOCK_PAYLOAD(block) + size);
+                rest->size = BLOCK_SIZE(block) - size - T_TLSF_HEADER_SIZE;
+                block->size = size | (block->size & T_TLSF_FLAGS);
+                _t_tlsf_set_free(rest, 1u);
+                /* rest's predecessor (block) is about to be used */
+                _t_tlsf_insert(pool, rest);
+            }
+            _t_tlsf_set_free(block, 0u);
+        }
+    }
+    t_sched_resume();
+
+    return block ? BLOCK_PAYLOAD(block) : NULL;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Release memory back to a TLSF pool in bounded time.
+ *
+ * The block is merged with a free predecessor and/or successor before
+ * it is filed, so free blocks are never adjacent.  A header swallowed by
+ * a merge keeps its free flag, so a second free of that pointer is still
+ * caught until the memory is handed out and overwritten.
+ *
+ * @param pool  Pool the memory was allocated from.
+ * @param ptr   Pointer previously returned by t_tlsf_pool_alloc / t_malloc.
+ * @return T_OK on success, T_NULL / T_INVALID on error (including a
+ *         pointer outside the pool or a block that is already free).
+ */
+t_status_t t_tlsf_pool_free(t_tlsf_pool_t *pool, void *ptr)
+{
+    t_tlsf_block_t *block;
+    t_tlsf_block_t *next;
+    t_tlsf_block_t *prev;
+
+    if (!ptr)
+        return T_NULL;
+    if (!pool || T_TLSF_POOL_MAGIC != pool->pool_id)
+        return T_INVALID;
+
+    block = BLOCK_FROM_PAYLOAD(ptr);
+    if ((t_uint8_t *)block < pool->pool_start || (t_uint8_t *)block >= pool->pool_end ||
+        ((size_t)ptr & T_BYTE_ALIGN_MASK))
+        return T_INVALID;
+
+    t_sched_suspend();
+    if (BLOCK_IS_FREE(block))
+    {
+        t_sched_resume();
+        return T_INVALID;
+    }
+    {
+        /* ── Merge with the previous block ── */
+        if (block->size & T_TLSF_PREV_FREE)
+        {
+            prev = block->prev_phys;
+            _t_tlsf_remove(pool, prev);
+            prev->size += T_TLSF_HEADER_SIZE + BLOCK_SIZE(block);
+            /* The absorbed header now reads as free, so freeing it again fails */
+            block->size = T_TLSF_FREE;
+            block = prev;
+        }
+
+        /* ── Merge with the next block ── */
+        next = BLOCK_NEXT_PHYS(block);
+        if (BLOCK_IS_FREE(next))
+        {
+            _t_tlsf_remove(pool, next);
+            block->size += T_TLSF_HEADER_SIZE + BLOCK_SIZE(next);
+        }
+
+        _t_tlsf_set_free(block, 1u);
+        _t_tlsf_insert(pool, block);
+    }
+    t_sched_resume();
+
+    return T_OK;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Query free payload bytes in a TLSF pool.
+ *
+ * @note Spread over several blocks; the largest single allocation may
+ *       be smaller than the returned value.
+ */
+size_t t_tlsf_pool_available(t_tlsf_pool_t *pool)
+{
+    if (!pool || T_TLSF_POOL_MAGIC != pool->pool_id)
+        return 0u;
+    return pool->available;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Delete (invalidate) a TLSF pool.
+ *
+ * After deletion the pool must not be used until re-created with
+ * @c t_tlsf_pool_create.
+ */
+t_status_t t_tlsf_pool_delete(t_tlsf_pool_t *pool)
+{
+    if (!pool)
+        return T_NULL;
+
+    t_sched_suspend();
+    {
+        pool->pool_id = 0u;            /* invalidate */
+    }
+    t_sched_resume();
+
+    return T_OK;
+}
+
+/* ================================================================== */
+/*        Default (singleton) pool  +  legacy-compatible API          */
+/* ================================================================== */
+
+/** Raw backing store for the default TLSF pool. */
+static t_uint8_t      _t_default_mem[TO_DYNAMIC_MEM_SIZE];
+
+/** Default pool control block. */
+static t_tlsf_pool_t  _t_default_pool;
+
+/** One-shot flag guarding lazy initialisation. */
+static t_uint8_t      _t_default_pool_inited = 0u;
+
+/**
+ * @brief Ensure the default pool has been created (lazy init, once only).
+ */
+static void _t_ensure_default_pool(void)
+{
+    if (!_t_default_pool_inited)
+    {
+        t_tlsf_pool_create(&_t_default_pool,
+                           _t_default_mem,
+                           TO_DYNAMIC_MEM_SIZE);
+        _t_default_pool_inited = 1u;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Allocate from the default TLSF pool (drop-in replacement).
+ */
+void *t_malloc(size_t wanted_size)
+{
+    _t_ensure_default_pool();
+    return t_tlsf_pool_alloc(&_t_default_pool, wanted_size);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Free memory back to the default pool (drop-in replacement).
+ */
+void t_free(void *ptr)
+{
+    t_tlsf_pool_free(&_t_default_pool, ptr);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return free payload bytes in the default pool.
+ */
+size_t t_get_free_mem_size(void)
+{
+    _t_ensure_default_pool();
+    return t_tlsf_pool_available(&_t_default_pool);
+}
+/*-----------------------------------------------------------*/
+
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
@@ -1,6 +1,7 @@
 /**
  * @file ipc.c
- * @brief IPC primitives: semaphore, mutex, message queue and suspend helpers.
+ * @brief IPC primitives: semaphore, mutex, condition variable, message queue,
+ *        mailbox, event group, reader-writer lock and suspend helpers.
  * @version 1.0.0
  * @date 2026-01-19
  * @author
@@ -10,58 +11,180 @@
 #include "ToRTOS.h"
 
 #if TO_USING_IPC
+#if TO_USING_QUEUE_SET
+static t_uint8_t _t_queue_set_post(t_ipc_t *member);
+static void _t_queue_set_detach(t_ipc_t *ipc);
+#endif
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+static void _t_mutex_disown(t_ipc_t *ipc);
+#endif
+
+#if TO_USING_IPC_PRIO_BITMAP
+t_inline t_uint32_t _t_ipc_highest_priority(t_uint32_t group)
+{
+#if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)
+    return __t_ffs(group) - 1;
+#else
+    return __t_fls(group) - 1;
+#endif
+}
+
 /**
- * @brief Suspend a thread into an IPC wait list (FIFO or PRIO).
- * @param sentinel Suspend list sentinel.
- * @param thread Thread to suspend.
- * @param flag TO_IPC_FLAG_FIFO or TO_IPC_FLAG_PRIO.
+ * @brief O(1) priority insert: the wait list stays one sorted list, and
+ *        prio_head/prio_group index the first waiter of each priority the
+ *        way the ready lists are indexed by the scheduler.
  */
-t_status_t t_ipc_suspend(t_list_t *sentinel, t_thread_t *thread, t_uint8_t flag)
+static void _t_ipc_prio_insert(t_ipc_t *ipc, t_thread_t *thread)
 {
-    register t_uint32_t level;
-    t_list_t *p;
+    t_uint8_t prio = thread->current_priority;
+    t_uint32_t lower;
+    t_list_t *pos = &ipc->wait_list;
 
-    if (!sentinel || !thread)
-        return T_NULL;
+    /* Same priority stays FIFO: go in front of the best lower level */
+#if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)
+    lower = ipc->prio_group & ~((2UL << prio) - 1);
+#else
+    lower = ipc->prio_group & ((1UL << prio) - 1);
+#endif
+    if (lower)
+        pos = ipc->prio_head[_t_ipc_highest_priority(lower)];
+    t_list_insert_before(pos, &thread->tlist);
 
-    /* enter critical */
-    level = t_irq_disable();
+    if (!(ipc->prio_group & (1UL << prio)))
+    {
+        ipc->prio_group |= 1UL << prio;
+        ipc->prio_head[prio] = &thread->tlist;
+    }
+}
+#endif /* TO_USING_IPC_PRIO_BITMAP */
 
-    /* remove from ready queue (if any) and mark blocked */
-    t_sched_remove_thread(thread);
-    thread->status = TO_THREAD_SUSPEND;    
+/**
+ * @brief Take a thread off the wait list of ipc, keeping the index and
+ *        the per-direction counts valid.
+ */
+static void _t_ipc_remove(t_ipc_t *ipc, t_thread_t *thread)
+{
+#if TO_USING_IPC_PRIO_BITMAP
+    t_uint8_t prio = thread->current_priority;
+    t_list_t *next = thread->tlist.next;
+
+    if (TO_IPC_FLAG_PRIO == ipc->mode && (ipc->prio_group & (1UL << prio)) &&
+        ipc->prio_head[prio] == &thread->tlist)
+    {
+        if (next != &ipc->wait_list &&
+            T_LIST_ENTRY(next, t_thread_t, tlist)->current_priority == prio)
+            ipc->prio_head[prio] = next;
+        else
+            ipc->prio_group &= ~(1UL << prio);
+    }
+#endif
+    if (thread->tlist.next != &thread->tlist)
+        ipc->wait_count[thread->ipc_flag]--;
+    t_list_delete(&thread->tlist);
+}
+
+/**
+ * @brief Link a thread into a wait list by FIFO or priority order.
+ */
+static void _t_ipc_insert(t_list_t *sentinel, t_thread_t *thread, t_uint8_t flag)
+{
+    t_list_t *p;
+
+    if (thread->pend_on && sentinel == &thread->pend_on->wait_list)
+        thread->pend_on->wait_count[thread->ipc_flag]++;
 
-    /* insert into suspend list according to flag */
     switch (flag)
     {
     case TO_IPC_FLAG_FIFO:
         t_list_insert_before(sentinel, &thread->tlist);
         break;
     case TO_IPC_FLAG_PRIO: /* PRIO */
+#if TO_USING_IPC_PRIO_BITMAP
+        if (thread->pend_on && sentinel == &thread->pend_on->wait_list)
+        {
+            _t_ipc_prio_insert(thread->pend_on, thread);
+            break;
+        }
+#endif
         p = sentinel;
         while (p->next != sentinel)
         {
             t_thread_t *next_thread = T_LIST_ENTRY(p->next, t_thread_t, tlist);
-#if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)            
-            if (thread->current_priority < next_thread->current_priority)
-#else
-            if (thread->current_priority > next_thread->current_priority)
-#endif
+            if (T_PRIO_HIGHER(thread->current_priority, next_thread->current_priority))
                 break;
             p = p->next;
         }
-        t_list_insert_before(p, &thread->tlist);
+        t_list_insert_after(p, &thread->tlist);
         break;
     default:
         /* Unsupported flag -> append FIFO style */
         t_list_insert_before(sentinel, &thread->tlist);
         break;
     }
+}
+
+/**
+ * @brief Suspend a thread into an IPC wait list (FIFO or PRIO).
+ * @param sentinel Suspend list sentinel.
+ * @param thread Thread to suspend.
+ * @param flag TO_IPC_FLAG_FIFO or TO_IPC_FLAG_PRIO.
+ */
+t_status_t t_ipc_suspend(t_list_t *sentinel, t_thread_t *thread, t_uint8_t flag)
+{
+    register t_uint32_t level;
+
+    if (!sentinel || !thread)
+        return T_NULL;
+
+    /* enter critical */
+    level = t_irq_disable();
+
+    /* remove from ready queue (if any) and mark blocked */
+    t_sched_remove_thread(thread);
+    thread->status = TO_THREAD_SUSPEND;    
+
+    /* insert into suspend list according to flag */
+    _t_ipc_insert(sentinel, thread, flag);
 
     t_irq_enable(level);
     return T_OK;
 }
 
+/**
+ * @brief Change the priority of a blocked thread and re-sort it.
+ * @note Caller holds the IRQ lock. FIFO lists keep their order.
+ */
+void t_ipc_requeue(t_thread_t *thread, t_uint8_t priority)
+{
+    t_ipc_t *ipc = thread->pend_on;
+
+    /* Off the list already, or FIFO: only the priority changes */
+    if (thread->tlist.next == &thread->tlist || TO_IPC_FLAG_PRIO != ipc->mode)
+    {
+        thread->current_priority = priority;
+        thread->number_mask = 1UL << priority;
+        return;
+    }
+    _t_ipc_remove(ipc, thread);
+    thread->current_priority = priority;
+    thread->number_mask = 1UL << priority;
+    _t_ipc_insert(&ipc->wait_list, thread, ipc->mode);
+}
+
+/**
+ * @brief Take a thread off the IPC wait list it is blocked on (if any).
+ * @note Caller holds the IRQ lock. Also used by the sleep timeout, where
+ *       the thread is on no IPC list.
+ */
+void t_ipc_unlink(t_thread_t *thread)
+{
+    if (thread->pend_on)
+        _t_ipc_remove(thread->pend_on, thread);
+    else
+        t_list_delete(&thread->tlist);
+    thread->pend_on = NULL;
+}
+
 /**
  * @brief Resume all threads in given suspend list (no immediate schedule).
  * @param sentinel Suspend list sentinel.
@@ -79,7 +202,8 @@ t_status_t t_ipc_list_resume_all(t_list_t *sentinel)
     {
         level = t_irq_disable();
         thread = T_LIST_ENTRY(sentinel->next, t_thread_t, tlist);
-        t_list_delete(&thread->tlist);
+        t_ipc_unlink(thread);
+        t_timer_stop(&thread->timer);
         thread->status = TO_THREAD_READY;
         t_sched_insert_thread(thread);
         t_irq_enable(level);
@@ -87,24 +211,152 @@ t_status_t t_ipc_list_resume_all(t_list_t *sentinel)
     return T_OK;
 }
 
+/**
+ * @brief Take a thread off an IPC wait list and make it ready.
+ * @param thread Waiting thread (caller holds the IRQ lock).
+ * @param status Wait result handed to the thread (T_OK: request completed).
+ * @note A final wake stops the timeout timer. T_BUSY leaves it running:
+ *       the retry keeps the call's deadline, and a timer that fires before
+ *       the thread runs only marks that deadline as passed.
+ */
+static void _t_ipc_wake(t_thread_t *thread, t_status_t status)
+{
+    t_ipc_unlink(thread);
+    if (T_BUSY != status)
+        t_timer_stop(&thread->timer);
+    thread->ipc_status = status;
+    thread->status = TO_THREAD_READY;
+    t_sched_insert_thread(thread);
+}
+
+/**
+ * @brief Return the first waiter blocked in the given direction.
+ * @param ipc IPC object.
+ * @param dir TO_IPC_WAIT_RECV or TO_IPC_WAIT_SEND.
+ * @note O(1) unless both directions wait at once (a reserve or peek
+ *       outstanding on a full queue, readers queued ahead of a writer):
+ *       only then it walks past the waiters of the other direction.
+ */
+static t_thread_t *_t_ipc_waiter(t_ipc_t *ipc, t_uint8_t dir)
+{
+    t_list_t *p;
+
+    if (!ipc->wait_count[dir])
+        return NULL;
+    for (p = ipc->wait_list.next; p != &ipc->wait_list; p = p->next)
+    {
+        t_thread_t *th = T_LIST_ENTRY(p, t_thread_t, tlist);
+        if (dir == th->ipc_flag)
+            return th;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Block the current thread on an IPC object until woken or timed out.
+ * @param ipc IPC object.
+ * @param data Buffer parked for direct handoff (NULL: wake up only).
+ * @param dir TO_IPC_WAIT_SEND or TO_IPC_WAIT_RECV.
+ * @param timeout Timeout of the whole call.
+ * @param armed Caller's flag, 0 on the first attempt; set once the timeout
+ *        timer runs so retries keep the original deadline.
+ * @param level IRQ level saved by the caller, restored before switching.
+ * @return T_OK if handed off, T_BUSY to retry, else T_DELETED / T_ERR / T_UNSUPPORTED.
+ * @note The wake reason is read from ipc_status, never from the object,
+ *       which may be gone. Only T_BUSY leaves the timer armed: a caller
+ *       that then returns without waiting again calls _t_ipc_wait_done().
+ */
+static t_status_t _t_ipc_wait(t_ipc_t *ipc, void *data, t_uint8_t dir,
+                              t_int32_t *timeout, t_uint8_t *armed,
+                              t_uint32_t level)
+{
+    t_thread_t *self = t_current_thread;
+
+    if (0 == *timeout)
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+    if (!self)
+    {
+        t_irq_enable(level);
+        return T_UNSUPPORTED;
+    }
+    /* The deadline passed while we were retrying */
+    if (t_timeout_passed(*armed))
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+
+    /* Park the caller's buffer so the other side can complete the call */
+    self->ipc_data = data;
+    self->ipc_flag = dir;
+    self->ipc_status = T_BUSY;
+    self->pend_on = ipc;
+
+    t_ipc_suspend(&ipc->wait_list, self, ipc->mode);
+
+    t_timeout_arm(*timeout, armed);
+
+    t_irq_enable(level);
+    t_sched_switch();
+
+    /* ---- after wake up: the waker or the timer left the reason ---- */
+    switch (self->ipc_status)
+    {
+    case T_OK:
+    case T_DELETED:
+        return self->ipc_status;
+    case T_TIMEOUT:
+        return T_ERR;
+    default:
+        return T_BUSY;
+    }
+}
+
+/**
+ * @brief Cancel the timeout of a call that was woken to retry and returns
+ *        without waiting again.
+ * @note Caller holds the IRQ lock.
+ */
+t_inline void _t_ipc_wait_done(t_uint8_t armed)
+{
+    t_timeout_done(armed);
+}
+
 /* Delete an IPC object and wake waiting threads */
 t_status_t t_ipc_delete(t_ipc_t *ipc)
 {
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+
     if (!ipc) 
         return T_NULL;
     if (0 == ipc->status) 
         return T_OK;
 
-    if (!t_list_isempty(&ipc->wait_list))
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    _t_mutex_disown(ipc);
+#endif
+    /* Invalidate first so woken waiters cannot retry on the object */
+    level = t_irq_disable();
+    ipc->status = 0;
+#if TO_USING_QUEUE_SET
+    _t_queue_set_detach(ipc);
+#endif
+    while (!t_list_isempty(&ipc->wait_list))
     {
-        t_ipc_list_resume_all(&ipc->wait_list);
-        t_sched_switch();
+        _t_ipc_wake(T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist), T_DELETED);
+        need_schedule = 1;
     }
-
-    ipc->status = 0;
     ipc->msg_waiting = 0;
     ipc->length = 0;
     ipc->item_size = 0;
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
 
 #if ((1 == TO_USING_DYNAMIC_ALLOCATION) && (0 == TO_USING_STATIC_ALLOCATION))
     t_free(ipc);     
@@ -127,6 +379,14 @@ t_status_t t_sema_create_static(t_uint16_t max_count, t_uint16_t init_count, t_u
         return T_NULL;
 
     t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
     ipc->type = IPC_SEMA;
     ipc->status = 1;
@@ -157,6 +417,14 @@ t_status_t t_sema_create(t_uint16_t max_count, t_uint16_t init_count, t_uint8_t
         return T_ERR;
 
     t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
     ipc->type = IPC_SEMA;
     ipc->status = 1;
@@ -180,10 +448,66 @@ t_status_t t_sema_create(t_uint16_t max_count, t_uint16_t init_count, t_uint8_t
 }
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 
+/**
+ * @brief Hand one count straight to the first waiter (caller holds the IRQ lock).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return 1 if a waiter took the count, 0 if nobody was waiting.
+ * @note The waiter returns T_OK without retrying, so a thread that runs
+ *       first cannot take the count from under it.
+ */
+static t_uint8_t _t_sema_handoff(t_ipc_t *ipc, t_uint8_t *need_schedule)
+{
+    if (t_list_isempty(&ipc->wait_list))
+        return 0;
+    _t_ipc_wake(T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist), T_OK);
+    *need_schedule = 1;
+    return 1;
+}
+
+/**
+ * @brief Take one count without masking interrupts.
+ * @return 1 on success, 0 if the count is zero.
+ */
+t_inline t_uint8_t _t_sema_try_take(t_ipc_t *ipc)
+{
+    t_uint16_t count;
+
+    do
+    {
+        count = *(volatile t_uint16_t *)&ipc->msg_waiting;
+        if (0 == count)
+            return 0;
+    } while (!t_atomic_cas16(&ipc->msg_waiting, count, count - 1));
+    return 1;
+}
+
+/**
+ * @brief Give one count (caller holds the IRQ lock, never switches).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if the count is at its maximum, T_DELETED.
+ */
+static t_status_t _t_sema_give(t_ipc_t *ipc, t_uint8_t *need_schedule)
+{
+    if (0 == ipc->status)
+        return T_DELETED;
+    if (_t_sema_handoff(ipc, need_schedule))
+        return T_OK;
+    if (ipc->msg_waiting >= ipc->length)
+        return T_ERR;
+
+    ipc->msg_waiting++;
+#if TO_USING_QUEUE_SET
+    if (ipc->set && _t_queue_set_post(ipc))
+        *need_schedule = 1;
+#endif
+    return T_OK;
+}
+
 t_status_t t_sema_send(t_ipc_t *ipc)
 {
     register t_uint32_t level;
     t_uint8_t need_schedule = 0;
+    t_status_t ret;
 
     if (!ipc) 
         return T_NULL;
@@ -192,36 +516,77 @@ t_status_t t_sema_send(t_ipc_t *ipc)
     if(IPC_SEMA != ipc->type)
         return T_INVALID;   
 
-    level = t_irq_disable();
-
-    if (0 == ipc->status)
-    {
-        t_irq_enable(level);
-        return T_DELETED;
-    }
-    if (ipc->msg_waiting < ipc->length)
+#if TO_USING_IPC_FAST_PATH
+    /* Nobody waiting: bump the count without masking interrupts.
+       Queue set members always post under the lock. */
+#if TO_USING_QUEUE_SET
+    if (!ipc->set && t_list_isempty(&ipc->wait_list))
+#else
+    if (t_list_isempty(&ipc->wait_list))
+#endif
     {
-        ipc->msg_waiting++;
-        if (!t_list_isempty(&ipc->wait_list))
+        t_uint16_t count;
+        do
         {
-            t_thread_t *th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
-            t_list_delete(&th->tlist);
-            th->status = TO_THREAD_READY;
-            t_sched_insert_thread(th);
-            need_schedule = 1;
-        }
+            count = *(volatile t_uint16_t *)&ipc->msg_waiting;
+            if (count >= ipc->length)
+                return T_ERR;
+        } while (!t_atomic_cas16(&ipc->msg_waiting, count, count + 1));
+
+        if (t_list_isempty(&ipc->wait_list))
+            return T_OK;
+
+        /* A taker queued between the check and the increment: hand it
+           the count unless someone already took it */
+        level = t_irq_disable();
+        if (ipc->msg_waiting > 0 && _t_sema_handoff(ipc, &need_schedule))
+            ipc->msg_waiting--;
         t_irq_enable(level);
+
         if (need_schedule)
             t_sched_switch();
         return T_OK;
     }
-    return T_ERR;
+#endif /* TO_USING_IPC_FAST_PATH */
+
+    level = t_irq_disable();
+    ret = _t_sema_give(ipc, &need_schedule);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_sema_send(): never blocks or switches.
+ * @param woken Optional; set to 1 if a thread that should preempt the
+ *        interrupted one was woken (never cleared). Pass it to t_isr_yield().
+ */
+t_status_t t_sema_send_isr(t_ipc_t *ipc, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if(IPC_SEMA != ipc->type)
+        return T_INVALID;   
+
+    level = t_irq_disable();
+    ret = _t_sema_give(ipc, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
 }
 
 t_status_t t_sema_recv(t_ipc_t *ipc, t_int32_t timeout)
 {
     register t_uint32_t level;
-    t_uint32_t start_tick = 0;
+    t_uint8_t armed = 0;
+    t_status_t ret;
 
     if (!ipc) 
         return T_NULL;
@@ -229,59 +594,33 @@ t_status_t t_sema_recv(t_ipc_t *ipc, t_int32_t timeout)
         return T_DELETED;   
     if(IPC_SEMA != ipc->type)
         return T_INVALID;   
+#if TO_USING_IPC_FAST_PATH
+    if (_t_sema_try_take(ipc))
+        return T_OK;
+#endif
     while (1)
     {
         level = t_irq_disable();
 
         if (0 == ipc->status)
         {
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
             return T_DELETED;
         } 
         if (ipc->msg_waiting > 0)
         {
             ipc->msg_waiting--;
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
             return T_OK;
         }
 
-        if (0 == timeout)
-        {
-            t_irq_enable(level);
-            return T_ERR;
-        }
-
-        /* suspend current thread */
-        t_ipc_suspend(&ipc->wait_list, t_current_thread, ipc->mode);       
-
-        /* Start timer if timeout specified */
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            if (start_tick == 0)
-                start_tick = t_tick_get();
-            t_timer_ctrl(&t_current_thread->timer, TO_TIMER_SET_TIME, &timeout);
-            t_timer_start(&t_current_thread->timer);
-        }
-
-        t_irq_enable(level);
-        t_sched_switch();   /* thread will sleep */
-
-        /* ---- after wake up ---- */
-        if (0 == ipc->status)
-            return T_DELETED;
-
-        /* check timeout */
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            t_uint32_t now = t_tick_get();
-            t_uint32_t elapsed = get_tick_diff(start_tick, now);
-            if (elapsed >= timeout)
-                return T_ERR;
-            timeout -= elapsed;
-            start_tick = now;
-        }
-        /* retry */
-        continue;
+        /* T_OK: the giver handed its count to us */
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
     }             
 }
 
@@ -295,6 +634,14 @@ t_status_t t_mutex_create_static_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_i
         return T_NULL;
 
     t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
     ipc->type = ipc_type;
     ipc->status = 1;
@@ -305,7 +652,8 @@ t_status_t t_mutex_create_static_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_i
 
     ipc->u.sema.holder = NULL;
     ipc->u.sema.recursive = 0;
-    ipc->u.sema.original_prio = DUMMY_PRIORITY;
+    t_list_init(&ipc->held);
+    ipc->u.sema.ceiling = DUMMY_PRIORITY;
 
     ipc->msg_waiting = 1; /* mutex available */
 
@@ -325,6 +673,14 @@ t_status_t t_mutex_create_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_ipc_t **
         return T_ERR;
 
     t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
     ipc->type = ipc_type;
     ipc->status = 1;
@@ -335,7 +691,8 @@ t_status_t t_mutex_create_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_ipc_t **
 
     ipc->u.sema.holder = NULL;
     ipc->u.sema.recursive = 0;
-    ipc->u.sema.original_prio = DUMMY_PRIORITY;
+    t_list_init(&ipc->held);
+    ipc->u.sema.ceiling = DUMMY_PRIORITY;
 
     ipc->msg_waiting = 1; /* mutex available */
 
@@ -349,32 +706,242 @@ t_status_t t_mutex_create_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_ipc_t **
 }   
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 
-
-t_status_t t_mutex_send_base(t_ipc_t *ipc)
+/**
+ * @brief Create a mutex using the immediate priority-ceiling protocol.
+ * @param ceiling Priority the owner runs at while holding the mutex; must be
+ *        at least the priority of every thread that takes it.
+ */
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_mutex_create_ceiling_static_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_uint8_t ceiling, t_ipc_t *ipc)
 {
-    register t_uint32_t level;
-    t_uint32_t start_tick = 0;
-    (void)start_tick;
-    t_uint8_t need_schedule = 0;
+    t_status_t ret;
 
-    if (!ipc) 
-        return T_NULL;
-    if (0 == ipc->status) 
-        return T_DELETED;
+    if (ceiling >= TO_THREAD_PRIORITY_MAX)
+        return T_INVALID;
+    ret = t_mutex_create_static_base(ipc_type, mode, ipc);
+    if (T_OK == ret)
+        ipc->u.sema.ceiling = ceiling;
+    return ret;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
 
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_mutex_create_ceiling_base(t_ipc_type_t ipc_type, t_uint8_t mode, t_uint8_t ceiling, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc;
+    t_status_t ret;
+
+    if (ceiling >= TO_THREAD_PRIORITY_MAX)
+        return T_INVALID;
+    ret = t_mutex_create_base(ipc_type, mode, &ipc);
+    if (T_OK != ret)
+        return ret;
+    ipc->u.sema.ceiling = ceiling;
+    if (ipc_handle)
+        *ipc_handle = ipc;
+    return T_OK;
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+t_inline t_uint8_t _t_is_mutex(t_ipc_t *ipc)
+{
+#if TO_USING_MUTEX
+    if (IPC_MUTEX == ipc->type)
+        return 1;
+#endif
+#if TO_USING_RECURSIVE_MUTEX
+    if (IPC_RECURSIVE_MUTEX == ipc->type)
+        return 1;
+#endif
+    return 0;
+}
+
+/**
+ * @brief Best of prio and the priorities of threads waiting on a mutex.
+ * @note O(1) for PRIO-mode objects; FIFO mode walks every waiter.
+ */
+static t_uint8_t _t_mutex_top_waiter(t_ipc_t *ipc, t_uint8_t prio)
+{
+    t_list_t *p;
+
+    for (p = ipc->wait_list.next; p != &ipc->wait_list; p = p->next)
+    {
+        t_thread_t *th = T_LIST_ENTRY(p, t_thread_t, tlist);
+        if (T_PRIO_HIGHER(th->current_priority, prio))
+            prio = th->current_priority;
+        if (TO_IPC_FLAG_PRIO == ipc->mode)
+            break;      /* sorted: the head is the best */
+    }
+    return prio;
+}
+
+/**
+ * @brief Priority a thread is entitled to: its base priority raised to the
+ *        ceiling of every ceiling mutex it holds and to the best waiter of
+ *        every contended inheritance mutex or write-held rwlock it holds.
+ */
+static t_uint8_t _t_mutex_entitled(t_thread_t *thread)
+{
+    t_uint8_t prio = thread->base_priority;
+    t_ipc_t *ipc;
+    t_list_t *p;
+
+    for (p = thread->held_list.next; p != &thread->held_list; p = p->next)
+    {
+        ipc = T_LIST_ENTRY(p, t_ipc_t, held);
+#if TO_USING_RWLOCK
+        if (IPC_RWLOCK == ipc->type)
+            prio = _t_mutex_top_waiter(ipc, prio);
+        else
+#endif
+        if (DUMMY_PRIORITY == ipc->u.sema.ceiling)
+            prio = _t_mutex_top_waiter(ipc, prio);
+        else if (T_PRIO_HIGHER(ipc->u.sema.ceiling, prio))
+            prio = ipc->u.sema.ceiling;
+    }
+    return prio;
+}
+
+/**
+ * @brief Owner of the lock a thread is blocked on, if that lock lends priority.
+ */
+static t_thread_t *_t_mutex_blocker(t_thread_t *thread)
+{
+    if (TO_THREAD_SUSPEND != thread->status || !thread->pend_on)
+        return NULL;
+    if (_t_is_mutex(thread->pend_on))
+        return thread->pend_on->u.sema.holder;
+#if TO_USING_RWLOCK
+    if (IPC_RWLOCK == thread->pend_on->type)
+        return thread->pend_on->u.rwlock.writer;
+#endif
+    return NULL;
+}
+
+/**
+ * @brief Re-evaluate inheritance for a mutex owner and pass any change
+ *        along the chain of owners it is blocked behind.
+ * @param owner Thread whose entitlement may have changed (NULL: none).
+ * @param prio Priority of a thread about to block on owner, not yet in any
+ *        wait list (DUMMY_PRIORITY: none).
+ * @note Caller holds the IRQ lock. At most MUTEX_INHERIT_DEPTH_MAX owners
+ *       are visited, which bounds the time spent with interrupts masked
+ *       for PRIO-mode locks. Each visit scans the owner's held locks, and
+ *       a FIFO-mode one also walks all of its waiters.
+ */
+static void _t_mutex_pi_update(t_thread_t *owner, t_uint8_t prio)
+{
+    t_uint8_t depth;
+    t_uint8_t target;
+
+    for (depth = 0; owner && depth < MUTEX_INHERIT_DEPTH_MAX; depth++)
+    {
+        target = _t_mutex_entitled(owner);
+        if (DUMMY_PRIORITY != prio && T_PRIO_HIGHER(prio, target))
+            target = prio;
+        if (target == owner->current_priority)
+            break;
+        t_thread_requeue(owner, target);
+
+        /* An owner that is itself blocked on a lock passes the change on */
+        owner = _t_mutex_blocker(owner);
+        prio = DUMMY_PRIORITY;
+    }
+}
+
+/**
+ * @brief Record a contended lock in its owner's held_list.
+ * @note Caller holds the IRQ lock. A waiter that blocked while a lock-free
+ *       acquire had taken the word but not yet written the holder tracked
+ *       the previous owner: the lock moves to the real one, and the thread
+ *       it was lent to drops what it no longer holds.
+ */
+static void _t_mutex_track(t_ipc_t *ipc, t_thread_t *owner)
+{
+    t_thread_t *prev;
+
+    if (!owner)
+        return;
+    if (ipc->held.next != &ipc->held)
+    {
+        if (ipc->held_by == owner)
+            return;
+        prev = ipc->held_by;
+        t_list_delete(&ipc->held);
+        t_list_insert_before(&owner->held_list, &ipc->held);
+        ipc->held_by = owner;
+        _t_mutex_pi_update(prev, DUMMY_PRIORITY);
+        return;
+    }
+    t_list_insert_before(&owner->held_list, &ipc->held);
+    ipc->held_by = owner;
+}
+
+/**
+ * @brief Apply the new holder's priority after it took a mutex: a ceiling
+ *        mutex raises it to the ceiling, a contended one lets the waiters lend.
+ * @note Caller holds the IRQ lock.
+ */
+static void _t_mutex_claim(t_ipc_t *ipc)
+{
+    if (MUTEX_CONTENDED == ipc->msg_waiting || DUMMY_PRIORITY != ipc->u.sema.ceiling)
+    {
+        _t_mutex_track(ipc, ipc->u.sema.holder);
+        _t_mutex_pi_update(ipc->u.sema.holder, DUMMY_PRIORITY);
+    }
+}
+
+/**
+ * @brief Apply a changed base priority to a thread that may hold or wait
+ *        for locks.
+ * @note Caller holds the IRQ lock. The thread keeps what its held locks
+ *       still lend and is re-sorted wherever it is linked; the owner it is
+ *       blocked behind, and that owner's chain, are re-evaluated.
+ */
+void t_mutex_requeue(t_thread_t *thread)
+{
+    t_thread_requeue(thread, _t_mutex_entitled(thread));
+    _t_mutex_pi_update(_t_mutex_blocker(thread), DUMMY_PRIORITY);
+}
+
+/**
+ * @brief Detach a mutex or rwlock that is being deleted from its owner.
+ */
+static void _t_mutex_disown(t_ipc_t *ipc)
+{
+    register t_uint32_t level;
+    t_thread_t *owner;
+
+    if (_t_is_mutex(ipc))
+        owner = ipc->u.sema.holder;
+#if TO_USING_RWLOCK
+    else if (IPC_RWLOCK == ipc->type)
+        owner = ipc->u.rwlock.writer;
+#endif
+    else
+        return;
     level = t_irq_disable();
+    t_list_delete(&ipc->held);
+    _t_mutex_pi_update(owner, DUMMY_PRIORITY);
+    t_irq_enable(level);
+}
+
+/**
+ * @brief Release a mutex held by the current thread.
+ * @param ipc Mutex.
+ * @param need_schedule Set to 1 if a waiter was woken.
+ * @note Caller holds the IRQ lock; never switches.
+ */
+static t_status_t _t_mutex_release(t_ipc_t *ipc, t_uint8_t *need_schedule)
+{
+    t_thread_t *th;
+    t_uint8_t prio;
 
     if (0 == ipc->status)
-    {
-        t_irq_enable(level);
         return T_DELETED;
-    }
     /* Only owner can release */
     if (t_current_thread != ipc->u.sema.holder)
-    {
-        t_irq_enable(level);
         return T_ERR;
-    }
 #if (TO_USING_RECURSIVE_MUTEX)
     if(IPC_RECURSIVE_MUTEX == ipc->type)
     {
@@ -384,66 +951,147 @@ t_status_t t_mutex_send_base(t_ipc_t *ipc)
 
         /* Still held by recursion */
         if (ipc->u.sema.recursive > 0)
-        {
-            t_irq_enable(level);
             return T_OK;
-        }
     }   
 #endif
 
-    /* Fully release mutex */
-    ipc->msg_waiting = 1;
-    ipc->u.sema.holder = NULL;
+    /* --- Restore priority: keep only what the other held mutexes lend --- */
+    t_list_delete(&ipc->held);
+    th = t_current_thread;
+    prio = _t_mutex_entitled(th);
+    if (th->current_priority != prio)
+    {
+        t_thread_requeue(th, prio);
+        *need_schedule = 1;
+    }
 
-    /* --- Restore priority --- */
-    if (ipc->u.sema.original_prio != DUMMY_PRIORITY &&
-        t_current_thread->current_priority != ipc->u.sema.original_prio)
+    if (t_list_isempty(&ipc->wait_list))
     {
-        t_thread_ctrl(t_current_thread, TO_THREAD_SET_PRIORITY,
-                    &ipc->u.sema.original_prio);
-        ipc->u.sema.original_prio = DUMMY_PRIORITY;
+        /* Fully release mutex */
+        ipc->msg_waiting = 1;
+        ipc->u.sema.holder = NULL;
+        return T_OK;
     }
 
-    /* Wake one waiting thread */
-    if (!t_list_isempty(&ipc->wait_list))
+    /* Hand ownership to the first waiter: it returns from recv without
+       retrying, so no thread that runs first can barge in */
+    th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+    _t_ipc_wake(th, T_OK);
+    ipc->u.sema.holder = th;
+    ipc->u.sema.recursive = 1;
+    ipc->msg_waiting = t_list_isempty(&ipc->wait_list) ? 0 : MUTEX_CONTENDED;
+    _t_mutex_claim(ipc);
+    *need_schedule = 1;
+    return T_OK;
+}
+
+t_status_t t_mutex_send_base(t_ipc_t *ipc)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+#if TO_USING_IPC_FAST_PATH
+    t_thread_t *self = t_current_thread;
+#endif
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+
+#if TO_USING_IPC_FAST_PATH
+    /* Uncontended fast path: no waiter marked the mutex, so it lends no
+       priority and the release walks no list. A ceiling mutex always has a
+       priority to drop, so it takes the locked path */
+    if (self && self == ipc->u.sema.holder &&
+        DUMMY_PRIORITY == ipc->u.sema.ceiling)
     {
-        t_thread_t *th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
-        t_list_delete(&th->tlist);
-        th->status = TO_THREAD_READY;
-        t_sched_insert_thread(th);
-        need_schedule = 1;
+#if (TO_USING_RECURSIVE_MUTEX)
+        if (IPC_RECURSIVE_MUTEX == ipc->type && ipc->u.sema.recursive > 1)
+        {
+            ipc->u.sema.recursive--;
+            return T_OK;
+        }
+#endif
+        /* The holder stays set until the word says free, so a waiter that
+           marks the mutex in between still finds whom to lend to; the CAS
+           then fails and the release goes through the lock. Nobody reads
+           recursive of a mutex they do not hold */
+        ipc->u.sema.recursive = 0;
+        if (MUTEX_CONTENDED != ipc->msg_waiting &&
+            t_atomic_cas16(&ipc->msg_waiting, 0, 1))
+        {
+            /* A thread that preempted us may already have taken it */
+            t_atomic_casp((void *volatile *)&ipc->u.sema.holder, self, NULL);
+            return T_OK;
+        }
+        ipc->u.sema.recursive = 1;
     }
+#endif /* TO_USING_IPC_FAST_PATH */
 
+    level = t_irq_disable();
+    ret = _t_mutex_release(ipc, &need_schedule);
     t_irq_enable(level);
+
     if (need_schedule)
         t_sched_switch();
-    return T_OK;    
+    return ret;    
 }
 
 t_status_t t_mutex_recv_base(t_ipc_t *ipc, t_int32_t timeout)
 {
     register t_uint32_t level;
-    t_uint32_t start_tick = 0;
+    t_uint8_t armed = 0;
+    t_status_t ret;
 
     if (!ipc) 
         return T_NULL;
     if (0 == ipc->status) 
         return T_DELETED;  
+    /* A thread above the ceiling would break the protocol's guarantees */
+    if (t_current_thread && DUMMY_PRIORITY != ipc->u.sema.ceiling &&
+        T_PRIO_HIGHER(t_current_thread->base_priority, ipc->u.sema.ceiling))
+        return T_INVALID;
+
+#if TO_USING_IPC_FAST_PATH
+    /* Uncontended fast path: free -> held without masking interrupts. A
+       ceiling mutex must raise the taker atomically with taking it, so it
+       takes the locked path, as on release */
+    if (t_current_thread && DUMMY_PRIORITY == ipc->u.sema.ceiling &&
+        t_atomic_cas16(&ipc->msg_waiting, 1, 0))
+    {
+        ipc->u.sema.holder = t_current_thread;
+        ipc->u.sema.recursive = 1;
+        T_BARRIER();
+        /* Let a waiter that blocked before holder was set lend its
+           priority now */
+        if (MUTEX_CONTENDED == ipc->msg_waiting)
+        {
+            level = t_irq_disable();
+            _t_mutex_claim(ipc);
+            t_irq_enable(level);
+        }
+        return T_OK;
+    }
+#endif /* TO_USING_IPC_FAST_PATH */
     while (1)
     {
         level = t_irq_disable();
 
         if (0 == ipc->status)
         {
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
             return T_DELETED;
         }
         if (1 == ipc->msg_waiting)
         {
-            ipc->msg_waiting = 0;
+            /* Keep the mark while others still wait so release takes the lock */
+            ipc->msg_waiting = t_list_isempty(&ipc->wait_list) ? 0 : MUTEX_CONTENDED;
             ipc->u.sema.holder = t_current_thread;
             ipc->u.sema.recursive = 1;
-            ipc->u.sema.original_prio = t_current_thread->current_priority;
+            _t_mutex_claim(ipc);
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
             return T_OK;
         }
@@ -454,6 +1102,7 @@ t_status_t t_mutex_recv_base(t_ipc_t *ipc, t_int32_t timeout)
             if(IPC_RECURSIVE_MUTEX == ipc->type)
                 ipc->u.sema.recursive++;
 #endif
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
             return T_OK;
         }
@@ -463,304 +1112,4245 @@ t_status_t t_mutex_recv_base(t_ipc_t *ipc, t_int32_t timeout)
             t_irq_enable(level);
             return T_ERR;
         }
-
-        /* apply priority inheritance if needed */
-#if TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY
-        if (ipc->u.sema.holder &&
-            t_current_thread->current_priority < ipc->u.sema.holder->current_priority)
-#else
-        if (ipc->u.sema.holder &&
-            t_current_thread->current_priority > ipc->u.sema.holder->current_priority)
-#endif
+        if (!t_current_thread)
         {
-            if (DUMMY_PRIORITY == ipc->u.sema.original_prio)
-                ipc->u.sema.original_prio = ipc->u.sema.holder->current_priority;
-            t_thread_ctrl(ipc->u.sema.holder,
-                            TO_THREAD_SET_PRIORITY,
-                            &t_current_thread->current_priority);
+            t_irq_enable(level);
+            return T_UNSUPPORTED;
         }
 
-        /* suspend and start timer */
-        t_ipc_suspend(&ipc->wait_list, t_current_thread, ipc->mode);
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            if (start_tick == 0)
-                start_tick = t_tick_get();
-            t_timer_ctrl(&t_current_thread->timer, TO_TIMER_SET_TIME, &timeout);
-            t_timer_start(&t_current_thread->timer);
-        }
+        /* The mark sends the owner's release through the lock, which
+           hands the mutex over; T_OK means we already own it */
+        ipc->msg_waiting = MUTEX_CONTENDED;
+        /* Lend our priority to the holder and whoever it is blocked behind;
+           a ceiling holder already runs at the ceiling */
+        _t_mutex_track(ipc, ipc->u.sema.holder);
+        if (DUMMY_PRIORITY == ipc->u.sema.ceiling)
+            _t_mutex_pi_update(ipc->u.sema.holder, t_current_thread->current_priority);
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_OK == ret || T_DELETED == ret)
+            return ret;
 
+        /* Gave up or woken without the mutex: take back what we lent */
+        level = t_irq_disable();
+        if (ipc->status)
+            _t_mutex_pi_update(ipc->u.sema.holder, DUMMY_PRIORITY);
         t_irq_enable(level);
-        t_sched_switch();
-
-        /* after wake */
-        if (0 == ipc->status)
-            return T_DELETED;
-        if (ipc->u.sema.holder == t_current_thread)
-            return T_OK;
-
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            t_uint32_t now = t_tick_get();
-            t_uint32_t elapsed = get_tick_diff(start_tick, now);
-            if (elapsed >= timeout)
-                return T_ERR;
-            timeout -= elapsed;
-            start_tick = now;
-        }
-        continue;
+        if (T_BUSY != ret)
+            return ret;
     }
       
 }
 
-#endif
-
-#if TO_USING_QUEUE
-static void __t_memcpy(t_uint8_t *dst, const t_uint8_t *src, t_uint16_t len)
-{
-    while (len--)
-        *dst++ = *src++;
-}
-
+#if TO_USING_CONDVAR
 #if (TO_USING_STATIC_ALLOCATION)
-t_status_t t_queue_create_static(void *queue_pool, t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc)
+t_status_t t_cond_create_static(t_uint8_t mode, t_ipc_t *ipc)
 {
-    if (!queue_pool || !item_size || !queue_length || !ipc) 
+    if (!ipc) 
         return T_NULL;
 
     t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
-    ipc->type = IPC_QUEUE;
+    ipc->type = IPC_COND;
     ipc->status = 1;
     ipc->mode = mode;
     ipc->msg_waiting = 0;
-    ipc->length = queue_length;
-    ipc->item_size = item_size;
-
-    t_uint8_t *base = (t_uint8_t *)queue_pool;
-    ipc->u.queue.head = base;
-    ipc->u.queue.tail = base + (item_size * queue_length);
-    ipc->u.queue.write_to = ipc->u.queue.head;
-    ipc->u.queue.read_from = ipc->u.queue.head;
+    ipc->length = 0;
+    ipc->item_size = 0;
 
 #if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
     ipc->is_static_allocated = 1;
-#endif        
-
+#endif      
+    
     return T_OK;
 }
 #endif /* TO_USING_STATIC_ALLOCATION */
-
 #if (TO_USING_DYNAMIC_ALLOCATION)
-t_status_t t_queue_create(t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t **ipc_handle)
+t_status_t t_cond_create(t_uint8_t mode, t_ipc_t **ipc_handle)
 {
-    if (!item_size || !queue_length) 
-        return T_NULL;
     t_ipc_t *ipc = t_malloc(sizeof(t_ipc_t));
     if(!ipc)
         return T_ERR;
-    void *queue_pool = t_malloc(item_size * queue_length);
-    if(!queue_pool)
-    {
-        t_free(ipc);
-        return T_ERR;
-    }
 
     t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
-    ipc->type = IPC_QUEUE;
+    ipc->type = IPC_COND;
     ipc->status = 1;
     ipc->mode = mode;
     ipc->msg_waiting = 0;
-    ipc->length = queue_length;
-    ipc->item_size = item_size;
-
-    t_uint8_t *base = (t_uint8_t *)queue_pool;
-    ipc->u.queue.head = base;
-    ipc->u.queue.tail = base + (item_size * queue_length);
-    ipc->u.queue.write_to = ipc->u.queue.head;
-    ipc->u.queue.read_from = ipc->u.queue.head;
+    ipc->length = 0;
+    ipc->item_size = 0;
 
 #if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
     ipc->is_static_allocated = 0;
-#endif    
-
+#endif  
     if(ipc_handle)
         *ipc_handle = ipc;
-
-    return T_OK;    
+    
+    return T_OK;
 }
 #endif /* TO_USING_DYNAMIC_ALLOCATION */
 
-t_status_t t_queue_send(t_ipc_t *ipc, const void *data, t_int32_t timeout)
+/**
+ * @brief Release the mutex and wait on the condition in one step.
+ * @param cond Condition variable.
+ * @param mutex Mutex held by the caller (all recursion levels are dropped).
+ * @param timeout Ticks to wait for a signal (0 returns T_ERR at once).
+ * @return T_OK if signalled, T_ERR on timeout or when the caller does not
+ *         own the mutex, T_DELETED if either object was deleted, T_INVALID
+ *         if mutex is not a (recursive) mutex; a failed re-acquire returns
+ *         its own status.
+ * @note The mutex is owned again on every return except T_ERR for a
+ *       non-owner, T_INVALID and a failed re-acquire. Any priority inherited through it is dropped while
+ *       waiting and re-applied by the normal acquire path. Re-check the
+ *       predicate after waking: another thread may run first.
+ */
+t_status_t t_cond_wait(t_ipc_t *cond, t_ipc_t *mutex, t_int32_t timeout)
 {
     register t_uint32_t level;
-    t_uint32_t start_tick = 0;
+    t_uint8_t armed = 0;
     t_uint8_t need_schedule = 0;
+    t_uint16_t recursive;
+    t_status_t ret, held;
 
-    if (!ipc) 
+    if (!cond || !mutex) 
         return T_NULL;
-    if (0 == ipc->status) 
-        return T_DELETED;    
-    if(IPC_QUEUE != ipc->type)
+    if (0 == cond->status || 0 == mutex->status) 
+        return T_DELETED;
+    if(IPC_COND != cond->type)
+        return T_INVALID;
+    if (IPC_MUTEX != mutex->type && IPC_RECURSIVE_MUTEX != mutex->type)
         return T_INVALID;
+    if (0 == timeout)
+        return T_ERR;
+
+    level = t_irq_disable();
+
+    if (!t_current_thread || t_current_thread != mutex->u.sema.holder)
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+
+    /* Drop the mutex and queue on cond under one lock: a signal sent
+       after the release cannot be missed */
+    recursive = mutex->u.sema.recursive;
+    mutex->u.sema.recursive = 1;
+    _t_mutex_release(mutex, &need_schedule);
+
     while (1)
     {
+        ret = _t_ipc_wait(cond, NULL, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+            break;
         level = t_irq_disable();
-    
-        if (ipc->msg_waiting < ipc->length)
+        if (0 == cond->status)
         {
-            /* Write data to queue */
-            __t_memcpy(ipc->u.queue.write_to, data, ipc->item_size);
-            ipc->u.queue.write_to += ipc->item_size;
-            if (ipc->u.queue.write_to >= ipc->u.queue.tail)
-                ipc->u.queue.write_to = ipc->u.queue.head;
-            ipc->msg_waiting++;
-
-            /* Wake one receiver if waiting */
-            if (!t_list_isempty(&ipc->wait_list))
-            {
-                t_thread_t *rth = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
-                t_list_delete(&rth->tlist);
-                rth->status = TO_THREAD_READY;
-                t_sched_insert_thread(rth);
-                need_schedule = 1;
-            }
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
-            if (need_schedule)
-                t_sched_switch();
-            return T_OK;
+            ret = T_DELETED;
+            break;
         }
+    }
 
-        /* Queue is full */
-        if (0 == timeout)
-        {
-            t_irq_enable(level);
-            return T_ERR;
-        }
+    held = t_mutex_recv_base(mutex, TO_WAITING_FOREVER);
+    if (T_OK != held)
+        return held;
+    mutex->u.sema.recursive = recursive;
+    return ret;
+}
 
-        if (!t_current_thread)
-        {
-            t_irq_enable(level);
-            return T_UNSUPPORTED;
-        }
+/**
+ * @brief Wake one or all threads waiting on a condition.
+ * @param all 0: first waiter only, 1: every waiter.
+ */
+static t_status_t _t_cond_wake(t_ipc_t *cond, t_uint8_t all)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
 
-        /* Suspend current thread */
-        t_ipc_suspend(&ipc->wait_list, t_current_thread, ipc->mode);
+    if (!cond) 
+        return T_NULL;
+    if (0 == cond->status) 
+        return T_DELETED;
+    if(IPC_COND != cond->type)
+        return T_INVALID;
 
-        /* Setup timeout timer */
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            if (start_tick == 0)
-                start_tick = t_tick_get();
-            t_timer_ctrl(&t_current_thread->timer, TO_TIMER_SET_TIME, &timeout);
-            t_timer_start(&t_current_thread->timer);
-        }
+    level = t_irq_disable();
+    while (!t_list_isempty(&cond->wait_list))
+    {
+        t_thread_t *th = T_LIST_ENTRY(cond->wait_list.next, t_thread_t, tlist);
+        _t_ipc_wake(th, T_OK);
+        need_schedule = 1;
+        if (!all)
+            break;
+    }
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return T_OK;
+}
+
+/**
+ * @brief Wake the first thread waiting on a condition (no-op if none).
+ */
+t_status_t t_cond_signal(t_ipc_t *cond)
+{
+    return _t_cond_wake(cond, 0);
+}
+
+/**
+ * @brief Wake every thread waiting on a condition.
+ */
+t_status_t t_cond_broadcast(t_ipc_t *cond)
+{
+    return _t_cond_wake(cond, 1);
+}
+#endif /* TO_USING_CONDVAR */
+
+#endif
+
+#if TO_USING_QUEUE
+static void __t_memcpy(t_uint8_t *dst, const t_uint8_t *src, size_t len)
+{
+    while (len--)
+        *dst++ = *src++;
+}
+
+/* Word kernels fall back to bytes when a caller buffer is not word aligned. */
+#define T_COPY_UNALIGNED(dst, src) ((((size_t)(dst)) | ((size_t)(src))) & (sizeof(t_uint32_t) - 1))
+
+/**
+ * @brief Word-wise copy, four words per iteration so the compiler can
+ *        emit LDM/STM pairs. Also copies multi-item runs of the batch
+ *        calls; a len that is not whole words goes byte-wise.
+ */
+static void __t_memcpy_word(t_uint8_t *dst, const t_uint8_t *src, size_t len)
+{
+    t_uint32_t *d = (t_uint32_t *)dst;
+    const t_uint32_t *s = (const t_uint32_t *)src;
+    size_t words = len >> 2;
+
+    if (T_COPY_UNALIGNED(dst, src) || (len & (sizeof(t_uint32_t) - 1)))
+    {
+        __t_memcpy(dst, src, len);
+        return;
+    }
+    while (words >= 4)
+    {
+        t_uint32_t w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+        d[0] = w0; d[1] = w1; d[2] = w2; d[3] = w3;
+        d += 4;
+        s += 4;
+        words -= 4;
+    }
+    while (words--)
+        *d++ = *s++;
+}
+
+static void __t_memcpy_4(t_uint8_t *dst, const t_uint8_t *src, size_t len)
+{
+    if (T_COPY_UNALIGNED(dst, src))
+    {
+        __t_memcpy(dst, src, len);
+        return;
+    }
+    *(t_uint32_t *)dst = *(const t_uint32_t *)src;
+}
+
+static void __t_memcpy_8(t_uint8_t *dst, const t_uint8_t *src, size_t len)
+{
+    t_uint32_t *d = (t_uint32_t *)dst;
+    const t_uint32_t *s = (const t_uint32_t *)src;
+    t_uint32_t w0, w1;
+
+    if (T_COPY_UNALIGNED(dst, src))
+    {
+        __t_memcpy(dst, src, len);
+        return;
+    }
+    w0 = s[0]; w1 = s[1];
+    d[0] = w0; d[1] = w1;
+}
+
+static void __t_memcpy_16(t_uint8_t *dst, const t_uint8_t *src, size_t len)
+{
+    t_uint32_t *d = (t_uint32_t *)dst;
+    const t_uint32_t *s = (const t_uint32_t *)src;
+    t_uint32_t w0, w1, w2, w3;
+
+    if (T_COPY_UNALIGNED(dst, src))
+    {
+        __t_memcpy(dst, src, len);
+        return;
+    }
+    w0 = s[0]; w1 = s[1]; w2 = s[2]; w3 = s[3];
+    d[0] = w0; d[1] = w1; d[2] = w2; d[3] = w3;
+}
+
+static void __t_memcpy_32(t_uint8_t *dst, const t_uint8_t *src, size_t len)
+{
+    t_uint32_t *d = (t_uint32_t *)dst;
+    const t_uint32_t *s = (const t_uint32_t *)src;
+    t_uint32_t w0, w1, w2, w3;
+
+    if (T_COPY_UNALIGNED(dst, src))
+    {
+        __t_memcpy(dst, src, len);
+        return;
+    }
+    w0 = s[0]; w1 = s[1]; w2 = s[2]; w3 = s[3];
+    d[0] = w0; d[1] = w1; d[2] = w2; d[3] = w3;
+    w0 = s[4]; w1 = s[5]; w2 = s[6]; w3 = s[7];
+    d[4] = w0; d[5] = w1; d[6] = w2; d[7] = w3;
+}
+
+/**
+ * @brief Pick the copy kernel for a queue once, at creation time.
+ * @param pool Ring storage; word kernels need every slot word aligned.
+ * @param item_size Fixed item size of the queue.
+ */
+static t_queue_copy_t _t_queue_copy_select(const void *pool, t_uint16_t item_size)
+{
+    if (((size_t)pool & (sizeof(t_uint32_t) - 1)) || (item_size & (sizeof(t_uint32_t) - 1)))
+        return __t_memcpy;
+
+    switch (item_size)
+    {
+    case 4:
+        return __t_memcpy_4;
+    case 8:
+        return __t_memcpy_8;
+    case 16:
+        return __t_memcpy_16;
+    case 32:
+        return __t_memcpy_32;
+    default:
+        return __t_memcpy_word;
+    }
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_queue_create_static(void *queue_pool, t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!queue_pool || !item_size || !queue_length || !ipc) 
+        return T_NULL;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_QUEUE;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = queue_length;
+    ipc->item_size = item_size;
+
+    t_uint8_t *base = (t_uint8_t *)queue_pool;
+    ipc->u.queue.head = base;
+    ipc->u.queue.tail = base + (item_size * queue_length);
+    ipc->u.queue.write_to = ipc->u.queue.head;
+    ipc->u.queue.read_from = ipc->u.queue.head;
+    ipc->u.queue.reserved = NULL;
+    ipc->u.queue.peeked = NULL;
+    ipc->u.queue.copy = _t_queue_copy_select(base, item_size);
+    ipc->u.queue.dropped = 0;
+#if TO_USING_QUEUE_STAMP
+    ipc->u.queue.stamp = NULL;
+#endif
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif        
+
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_queue_create(t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    if (!item_size || !queue_length) 
+        return T_NULL;
+    t_ipc_t *ipc = t_malloc(sizeof(t_ipc_t));
+    if(!ipc)
+        return T_ERR;
+    void *queue_pool = t_malloc(item_size * queue_length);
+    if(!queue_pool)
+    {
+        t_free(ipc);
+        return T_ERR;
+    }
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_QUEUE;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = queue_length;
+    ipc->item_size = item_size;
+
+    t_uint8_t *base = (t_uint8_t *)queue_pool;
+    ipc->u.queue.head = base;
+    ipc->u.queue.tail = base + (item_size * queue_length);
+    ipc->u.queue.write_to = ipc->u.queue.head;
+    ipc->u.queue.read_from = ipc->u.queue.head;
+    ipc->u.queue.reserved = NULL;
+    ipc->u.queue.peeked = NULL;
+    ipc->u.queue.copy = _t_queue_copy_select(base, item_size);
+    ipc->u.queue.dropped = 0;
+#if TO_USING_QUEUE_STAMP
+    ipc->u.queue.stamp = NULL;
+#endif
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+
+    if(ipc_handle)
+        *ipc_handle = ipc;
+
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+#if TO_USING_QUEUE_STAMP
+/**
+ * @brief Stamp n items entering the ring at slot with the current tick.
+ */
+static void _t_queue_stamp(t_ipc_t *ipc, const t_uint8_t *slot, t_uint16_t n)
+{
+    t_queue_stamp_t *st = ipc->u.queue.stamp;
+    t_uint32_t now = t_tick_get();
+    t_uint16_t i = (t_uint16_t)((t_uint32_t)(slot - ipc->u.queue.head) / ipc->item_size);
+
+    while (n--)
+    {
+        st->ticks[i] = now;
+        if (++i == ipc->length)
+            i = 0;
+    }
+}
+
+/**
+ * @brief Account one delivered item in the queue statistics.
+ */
+static void _t_queue_latency(t_queue_stamp_t *st, t_uint32_t latency)
+{
+    t_queue_stats_t *s = &st->stats;
+    t_uint32_t b = 0;
+
+    /* Bucket b holds 2^(b-1) <= latency < 2^b; __t_fls is not built in
+       every priority configuration, and this loop is bounded anyway */
+    if (latency)
+    {
+        for (b = 1; b < TO_QUEUE_LAT_BUCKETS - 1 && (latency >> b); b++)
+            ;
+    }
+    if (0 == s->count || latency < s->min)
+        s->min = latency;
+    if (latency > s->max)
+        s->max = latency;
+    s->count++;
+    s->sum += latency;
+    s->hist[b]++;
+}
+
+/**
+ * @brief Account n items leaving the ring at slot.
+ */
+static void _t_queue_delivered(t_ipc_t *ipc, const t_uint8_t *slot, t_uint16_t n)
+{
+    t_queue_stamp_t *st = ipc->u.queue.stamp;
+    t_uint32_t now = t_tick_get();
+    t_uint16_t i = (t_uint16_t)((t_uint32_t)(slot - ipc->u.queue.head) / ipc->item_size);
+
+    while (n--)
+    {
+        _t_queue_latency(st, get_tick_diff(st->ticks[i], now));
+        if (++i == ipc->length)
+            i = 0;
+    }
+}
+#endif /* TO_USING_QUEUE_STAMP */
+
+/**
+ * @brief Count one more stored item and let a blocked receiver retry.
+ * @return 1 if a thread was woken.
+ */
+static t_uint8_t _t_queue_published(t_ipc_t *ipc)
+{
+    t_thread_t *rth;
+    t_uint8_t woken = 0;
+
+    ipc->msg_waiting++;
+
+#if TO_USING_QUEUE_SET
+    if (ipc->set)
+        woken = _t_queue_set_post(ipc);
+#endif
+
+    /* A peeked head blocks receivers until it is released */
+    if (ipc->u.queue.peeked)
+        return woken;
+    rth = _t_ipc_waiter(ipc, TO_IPC_WAIT_RECV);
+    if (!rth)
+        return woken;
+    _t_ipc_wake(rth, T_BUSY);
+    return 1;
+}
+
+/**
+ * @brief Publish the item at write_to and let a blocked receiver retry.
+ * @return 1 if a thread was woken.
+ */
+static t_uint8_t _t_queue_written(t_ipc_t *ipc)
+{
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_stamp(ipc, ipc->u.queue.write_to, 1);
+#endif
+    ipc->u.queue.write_to += ipc->item_size;
+    if (ipc->u.queue.write_to >= ipc->u.queue.tail)
+        ipc->u.queue.write_to = ipc->u.queue.head;
+    return _t_queue_published(ipc);
+}
+
+/**
+ * @brief Retire the item at read_from and refill / free its slot.
+ * @return 1 if a thread was woken.
+ */
+static t_uint8_t _t_queue_consumed(t_ipc_t *ipc)
+{
+    t_thread_t *sth;
+
+    ipc->u.queue.read_from += ipc->item_size;
+    if (ipc->u.queue.read_from >= ipc->u.queue.tail)
+        ipc->u.queue.read_from = ipc->u.queue.head;
+
+    sth = _t_ipc_waiter(ipc, TO_IPC_WAIT_SEND);
+
+    /* Direct handoff: a blocked sender's item refills the freed slot */
+    if (sth && sth->ipc_data && !ipc->u.queue.reserved)
+    {
+        ipc->u.queue.copy(ipc->u.queue.write_to, sth->ipc_data, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+        if (ipc->u.queue.stamp)
+            _t_queue_stamp(ipc, ipc->u.queue.write_to, 1);
+#endif
+        ipc->u.queue.write_to += ipc->item_size;
+        if (ipc->u.queue.write_to >= ipc->u.queue.tail)
+            ipc->u.queue.write_to = ipc->u.queue.head;
+        _t_ipc_wake(sth, T_OK);
+#if TO_USING_QUEUE_SET
+        /* The refill is a new item as far as the set is concerned */
+        if (ipc->set)
+            _t_queue_set_post(ipc);
+#endif
+        return 1;
+    }
+
+    ipc->msg_waiting--;
+    if (!sth)
+        return 0;
+    _t_ipc_wake(sth, T_BUSY);
+    return 1;
+}
+
+#if TO_USING_QUEUE_STAMP
+/**
+ * @brief Drop head items older than max_age (caller holds the IRQ lock).
+ * @return 1 if a thread was woken.
+ * @note Items refilled from blocked senders are stamped now, so the loop
+ *       stops at them.
+ */
+static t_uint8_t _t_queue_expire(t_ipc_t *ipc)
+{
+    t_queue_stamp_t *st = ipc->u.queue.stamp;
+    t_uint8_t woken = 0;
+    t_uint32_t now;
+    t_uint16_t i;
+
+    if (!st || !st->max_age)
+        return 0;
+    now = t_tick_get();
+    while (ipc->msg_waiting && !ipc->u.queue.peeked)
+    {
+        i = (t_uint16_t)((t_uint32_t)(ipc->u.queue.read_from - ipc->u.queue.head) / ipc->item_size);
+        if (get_tick_diff(st->ticks[i], now) <= st->max_age)
+            break;
+        st->stats.expired++;
+        woken |= _t_queue_consumed(ipc);
+    }
+    return woken;
+}
+#endif /* TO_USING_QUEUE_STAMP */
+
+/**
+ * @brief Enqueue one item without blocking (caller holds the IRQ lock).
+ * @param front 1: store it in front of read_from so it is received next.
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if the queue is full, T_DELETED.
+ */
+static t_status_t _t_queue_put(t_ipc_t *ipc, const void *data, t_uint8_t front, t_uint8_t *need_schedule)
+{
+    t_thread_t *rth;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+
+    /* Direct handoff: copy straight into a blocked receiver's buffer */
+    rth = _t_ipc_waiter(ipc, TO_IPC_WAIT_RECV);
+    if (rth && rth->ipc_data && 0 == ipc->msg_waiting)
+    {
+        ipc->u.queue.copy(rth->ipc_data, data, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+        if (ipc->u.queue.stamp)
+            _t_queue_latency(ipc->u.queue.stamp, 0);
+#endif
+        _t_ipc_wake(rth, T_OK);
+        *need_schedule = 1;
+        return T_OK;
+    }
+
+    if (ipc->msg_waiting >= ipc->length || ipc->u.queue.reserved)
+        return T_ERR;
+    if (!front)
+    {
+        ipc->u.queue.copy(ipc->u.queue.write_to, data, ipc->item_size);
+        if (_t_queue_written(ipc))
+            *need_schedule = 1;
+        return T_OK;
+    }
+
+    /* A peeked head must stay the oldest item until it is released */
+    if (ipc->u.queue.peeked)
+        return T_ERR;
+    if (ipc->u.queue.read_from == ipc->u.queue.head)
+        ipc->u.queue.read_from = ipc->u.queue.tail;
+    ipc->u.queue.read_from -= ipc->item_size;
+    ipc->u.queue.copy(ipc->u.queue.read_from, data, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_stamp(ipc, ipc->u.queue.read_from, 1);
+#endif
+    if (_t_queue_published(ipc))
+        *need_schedule = 1;
+    return T_OK;
+}
+
+/**
+ * @brief Dequeue one item without blocking (caller holds the IRQ lock).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if no item is available, T_DELETED.
+ */
+static t_status_t _t_queue_get(t_ipc_t *ipc, void *data, t_uint8_t *need_schedule)
+{
+    if (0 == ipc->status)
+        return T_DELETED;
+#if TO_USING_QUEUE_STAMP
+    if (_t_queue_expire(ipc))
+        *need_schedule = 1;
+#endif
+    if (0 == ipc->msg_waiting || ipc->u.queue.peeked)
+        return T_ERR;
+
+    ipc->u.queue.copy(data, ipc->u.queue.read_from, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_delivered(ipc, ipc->u.queue.read_from, 1);
+#endif
+    if (_t_queue_consumed(ipc))
+        *need_schedule = 1;
+    return T_OK;
+}
+
+t_status_t t_queue_send(t_ipc_t *ipc, const void *data, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;    
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_queue_put(ipc, data, 0, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        /* Queue is full: wait (a receiver may complete the send for us) */
+        ret = _t_ipc_wait(ipc, (void *)data, TO_IPC_WAIT_SEND,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+t_status_t t_queue_recv(t_ipc_t *ipc, void *data, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;  
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_queue_get(ipc, data, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        /* Queue empty: wait (a sender may hand the item over directly) */
+        ret = _t_ipc_wait(ipc, data, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+        {
+            /* Dropping expired items may have woken blocked senders */
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+    }
+}
+
+/**
+ * @brief Interrupt variant of t_queue_send(): T_ERR instead of blocking
+ *        when full, never switches.
+ * @param woken Optional; set to 1 if a thread that should preempt the
+ *        interrupted one was woken (never cleared). Pass it to t_isr_yield().
+ */
+t_status_t t_queue_send_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_queue_put(ipc, data, 0, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Urgent send: the item goes in front of every queued one and is
+ *        the next one received.
+ * @param timeout Same semantics as t_queue_send().
+ * @note Several urgent items come out newest first. While full the caller
+ *       waits without parking its data, so a receiver never appends it at
+ *       the back; it is woken to retry the front insert instead.
+ */
+t_status_t t_queue_send_front(t_ipc_t *ipc, const void *data, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;    
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_queue_put(ipc, data, 1, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_SEND,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Interrupt variant of t_queue_send_front(): T_ERR instead of
+ *        blocking when full, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_queue_send_front_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_queue_put(ipc, data, 1, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_queue_recv(): T_ERR instead of blocking
+ *        when empty, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_queue_recv_isr(t_ipc_t *ipc, void *data, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_queue_get(ipc, data, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Enqueue one item, dropping the oldest one when full (caller holds
+ *        the IRQ lock).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_BUSY if a reserved or peeked slot pins a full ring,
+ *         T_DELETED.
+ */
+static t_status_t _t_queue_overwrite(t_ipc_t *ipc, const void *data, t_uint8_t *need_schedule)
+{
+    t_status_t ret;
+
+    ret = _t_queue_put(ipc, data, 0, need_schedule);
+    if (T_ERR != ret)
+        return ret;
+    if (ipc->u.queue.reserved || ipc->u.queue.peeked)
+        return T_BUSY;
+
+    /* Full: the new item takes the oldest one's slot. The count is
+       unchanged and nobody can be waiting for data, so no one is woken */
+    ipc->u.queue.read_from += ipc->item_size;
+    if (ipc->u.queue.read_from >= ipc->u.queue.tail)
+        ipc->u.queue.read_from = ipc->u.queue.head;
+    ipc->u.queue.copy(ipc->u.queue.write_to, data, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_stamp(ipc, ipc->u.queue.write_to, 1);
+#endif
+    ipc->u.queue.write_to += ipc->item_size;
+    if (ipc->u.queue.write_to >= ipc->u.queue.tail)
+        ipc->u.queue.write_to = ipc->u.queue.head;
+    ipc->u.queue.dropped++;
+    return T_OK;
+}
+
+/**
+ * @brief Latest-value send: never blocks; when the queue is full the
+ *        oldest item is dropped and counted (see t_queue_dropped()).
+ * @note With queue_length 1 the queue always holds the newest sample.
+ */
+t_status_t t_queue_overwrite(t_ipc_t *ipc, const void *data)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_queue_overwrite(ipc, data, &need_schedule);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_queue_overwrite(), never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_queue_overwrite_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_queue_overwrite(ipc, data, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Number of items t_queue_overwrite() has dropped so far.
+ */
+t_uint32_t t_queue_dropped(t_ipc_t *ipc)
+{
+    if (!ipc || IPC_QUEUE != ipc->type)
+        return 0;
+    return ipc->u.queue.dropped;
+}
+
+/**
+ * @brief Reserve the next free ring slot for in-place writing.
+ * @param ipc Queue object.
+ * @param slot Receives a pointer to item_size bytes inside the ring.
+ * @param timeout Same semantics as t_queue_send().
+ * @return T_OK on success; the slot must be published with t_queue_commit().
+ * @note Only one reservation may be outstanding per queue; other producers
+ *       block until it is committed.
+ */
+t_status_t t_queue_reserve(t_ipc_t *ipc, void **slot, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_status_t ret;
+
+    if (!ipc || !slot) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;    
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+        if (ipc->msg_waiting < ipc->length && !ipc->u.queue.reserved)
+        {
+            ipc->u.queue.reserved = ipc->u.queue.write_to;
+            *slot = ipc->u.queue.reserved;
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_OK;
+        }
+
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_SEND,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Publish a slot obtained from t_queue_reserve().
+ * @param ipc Queue object.
+ * @param slot Pointer returned by t_queue_reserve().
+ * @return T_OK on success, T_INVALID if slot is not the reserved one.
+ */
+t_status_t t_queue_commit(t_ipc_t *ipc, void *slot)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_thread_t *th;
+
+    if (!ipc || !slot) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+
+    if (0 == ipc->status)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    if (slot != ipc->u.queue.reserved)
+    {
+        t_irq_enable(level);
+        return T_INVALID;
+    }
+    ipc->u.queue.reserved = NULL;
+
+    th = _t_ipc_waiter(ipc, TO_IPC_WAIT_RECV);
+    if (th && th->ipc_data && 0 == ipc->msg_waiting)
+    {
+        /* Blocked receiver takes the item; the slot stays free */
+        ipc->u.queue.copy(th->ipc_data, slot, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+        if (ipc->u.queue.stamp)
+            _t_queue_latency(ipc->u.queue.stamp, 0);
+#endif
+        _t_ipc_wake(th, T_OK);
+        need_schedule = 1;
+    }
+    else
+    {
+        need_schedule = _t_queue_written(ipc);
+    }
+
+    /* Producers held off by the reservation may proceed */
+    if (ipc->msg_waiting < ipc->length)
+    {
+        th = _t_ipc_waiter(ipc, TO_IPC_WAIT_SEND);
+        if (th)
+        {
+            _t_ipc_wake(th, T_BUSY);
+            need_schedule = 1;
+        }
+    }
+
+    t_irq_enable(level);
+    if (need_schedule)
+        t_sched_switch();
+    return T_OK;
+}
+
+/**
+ * @brief Access the oldest item in place without copying it out.
+ * @param ipc Queue object.
+ * @param slot Receives a pointer to item_size bytes inside the ring.
+ * @param timeout Same semantics as t_queue_recv().
+ * @return T_OK on success; the slot must be returned with t_queue_release().
+ * @note Only one peek may be outstanding per queue; other consumers
+ *       block until it is released.
+ */
+t_status_t t_queue_peek(t_ipc_t *ipc, void **slot, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !slot) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;    
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+#if TO_USING_QUEUE_STAMP
+        if (_t_queue_expire(ipc))
+            need_schedule = 1;
+#endif
+        if (ipc->msg_waiting > 0 && !ipc->u.queue.peeked)
+        {
+            ipc->u.queue.peeked = ipc->u.queue.read_from;
+            *slot = ipc->u.queue.peeked;
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return T_OK;
+        }
+
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+        {
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+    }
+}
+
+/**
+ * @brief Retire an item obtained from t_queue_peek().
+ * @param ipc Queue object.
+ * @param slot Pointer returned by t_queue_peek().
+ * @return T_OK on success, T_INVALID if slot is not the peeked one.
+ */
+t_status_t t_queue_release(t_ipc_t *ipc, void *slot)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule;
+    t_thread_t *rth;
+
+    if (!ipc || !slot) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+
+    if (0 == ipc->status)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    if (slot != ipc->u.queue.peeked)
+    {
+        t_irq_enable(level);
+        return T_INVALID;
+    }
+    ipc->u.queue.peeked = NULL;
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_delivered(ipc, slot, 1);
+#endif
+    need_schedule = _t_queue_consumed(ipc);
+
+    /* Consumers held off by the peek may proceed */
+    if (ipc->msg_waiting > 0)
+    {
+        rth = _t_ipc_waiter(ipc, TO_IPC_WAIT_RECV);
+        if (rth)
+        {
+            _t_ipc_wake(rth, T_BUSY);
+            need_schedule = 1;
+        }
+    }
+
+    t_irq_enable(level);
+    if (need_schedule)
+        t_sched_switch();
+    return T_OK;
+}
+
+/**
+ * @brief Append n items at write_to using at most two contiguous copies.
+ * @return 1 if a queue set waiter was woken.
+ */
+static t_uint8_t _t_queue_put_n(t_ipc_t *ipc, const t_uint8_t *src, t_uint16_t n)
+{
+    t_uint8_t woken = 0;
+    size_t bytes = (size_t)n * ipc->item_size;
+    size_t first = (size_t)(ipc->u.queue.tail - ipc->u.queue.write_to);
+
+    if (first > bytes)
+        first = bytes;
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_stamp(ipc, ipc->u.queue.write_to, n);
+#endif
+    __t_memcpy_word(ipc->u.queue.write_to, src, first);
+    ipc->u.queue.write_to += first;
+    if (ipc->u.queue.write_to >= ipc->u.queue.tail)
+        ipc->u.queue.write_to = ipc->u.queue.head;
+    if (bytes > first)
+    {
+        __t_memcpy_word(ipc->u.queue.head, src + first, bytes - first);
+        ipc->u.queue.write_to = ipc->u.queue.head + (bytes - first);
+    }
+    ipc->msg_waiting += n;
+
+#if TO_USING_QUEUE_SET
+    while (ipc->set && n--)
+        woken |= _t_queue_set_post(ipc);
+#endif
+    return woken;
+}
+
+/**
+ * @brief Remove n items from read_from using at most two contiguous copies.
+ */
+static void _t_queue_get_n(t_ipc_t *ipc, t_uint8_t *dst, t_uint16_t n)
+{
+    size_t bytes = (size_t)n * ipc->item_size;
+    size_t first = (size_t)(ipc->u.queue.tail - ipc->u.queue.read_from);
+
+    if (first > bytes)
+        first = bytes;
+#if TO_USING_QUEUE_STAMP
+    if (ipc->u.queue.stamp)
+        _t_queue_delivered(ipc, ipc->u.queue.read_from, n);
+#endif
+    __t_memcpy_word(dst, ipc->u.queue.read_from, first);
+    ipc->u.queue.read_from += first;
+    if (ipc->u.queue.read_from >= ipc->u.queue.tail)
+        ipc->u.queue.read_from = ipc->u.queue.head;
+    if (bytes > first)
+    {
+        __t_memcpy_word(dst + first, ipc->u.queue.head, bytes - first);
+        ipc->u.queue.read_from = ipc->u.queue.head + (bytes - first);
+    }
+    ipc->msg_waiting -= n;
+}
+
+/**
+ * @brief Send up to count items in one critical section per attempt.
+ * @param ipc Queue object.
+ * @param data Array of count items.
+ * @param count Number of items to send.
+ * @param sent Optional; receives the number of items actually sent.
+ * @param timeout Same semantics as t_queue_send(); applies until all items are sent.
+ * @return T_OK when all items were sent, T_ERR on timeout (partial count in sent).
+ */
+t_status_t t_queue_send_n(t_ipc_t *ipc, const void *data, t_uint16_t count, t_uint16_t *sent, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    const t_uint8_t *src = (const t_uint8_t *)data;
+    t_uint16_t done = 0;
+    t_uint16_t n;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+    t_thread_t *th;
+
+    if (sent)
+        *sent = 0;
+    if (!ipc || !data) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;    
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+
+        /* One item takes the single-item path, without the run bookkeeping */
+        if (1 == count && T_OK == _t_queue_put(ipc, src, 0, &need_schedule))
+            done = 1;
+
+        /* Direct handoff to receivers already blocked on an empty queue */
+        while (done < count && 0 == ipc->msg_waiting)
+        {
+            th = _t_ipc_waiter(ipc, TO_IPC_WAIT_RECV);
+            if (!th || !th->ipc_data)
+                break;
+            ipc->u.queue.copy(th->ipc_data, src, ipc->item_size);
+#if TO_USING_QUEUE_STAMP
+            if (ipc->u.queue.stamp)
+                _t_queue_latency(ipc->u.queue.stamp, 0);
+#endif
+            _t_ipc_wake(th, T_OK);
+            src += ipc->item_size;
+            done++;
+            need_schedule = 1;
+        }
+
+        /* Remaining items go into the ring in one go */
+        if (done < count && !ipc->u.queue.reserved)
+        {
+            n = ipc->length - ipc->msg_waiting;
+            if (n > count - done)
+                n = count - done;
+            if (n)
+            {
+                if (_t_queue_put_n(ipc, src, n))
+                    need_schedule = 1;
+                src += (size_t)n * ipc->item_size;
+                done += n;
+
+                /* Let blocked receivers retry, at most one per new item */
+                while (n-- && !ipc->u.queue.peeked)
+                {
+                    th = _t_ipc_waiter(ipc, TO_IPC_WAIT_RECV);
+                    if (!th)
+                        break;
+                    _t_ipc_wake(th, T_BUSY);
+                    need_schedule = 1;
+                }
+            }
+        }
+
+        if (sent)
+            *sent = done;
+        if (done == count)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return T_OK;
+        }
+
+        /* Queue full: block (woken receivers run once we switch away) */
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_SEND,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+        {
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+    }
+}
+
+/**
+ * @brief Receive up to max_count items in one critical section per attempt.
+ * @param ipc Queue object.
+ * @param data Buffer for max_count items.
+ * @param max_count Maximum number of items to receive.
+ * @param min_count Block until at least this many items were received (0: never block).
+ * @param received Optional; receives the number of items actually received.
+ * @param timeout Same semantics as t_queue_recv(); applies until min_count is reached.
+ * @return T_OK once min_count items were received, T_ERR on timeout.
+ */
+t_status_t t_queue_recv_n(t_ipc_t *ipc, void *data, t_uint16_t max_count, t_uint16_t min_count, t_uint16_t *received, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t *dst = (t_uint8_t *)data;
+    t_uint16_t done = 0;
+    t_uint16_t n, room;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+    t_thread_t *th;
+
+    if (received)
+        *received = 0;
+    if (!ipc || !data) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;    
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    if (min_count > max_count)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+
+        /* One item takes the single-item path, without the run bookkeeping */
+        if (1 == max_count && T_OK == _t_queue_get(ipc, dst, &need_schedule))
+            done = 1;
+
+#if TO_USING_QUEUE_STAMP
+        if (_t_queue_expire(ipc))
+            need_schedule = 1;
+#endif
+        if (!ipc->u.queue.peeked)
+        {
+            n = ipc->msg_waiting;
+            if (n > max_count - done)
+                n = max_count - done;
+            if (n)
+            {
+                _t_queue_get_n(ipc, dst, n);
+                dst += (size_t)n * ipc->item_size;
+                done += n;
+
+                /* Refill freed slots from blocked senders, one wake-up each.
+                   A reserve / batch waiter claims space itself: leave it a
+                   slot and keep handing off to the plain senders behind it */
+                room = ipc->length - ipc->msg_waiting;
+                while (room)
+                {
+                    th = _t_ipc_waiter(ipc, TO_IPC_WAIT_SEND);
+                    if (!th)
+                        break;
+                    need_schedule = 1;
+                    room--;
+                    if (!th->ipc_data || ipc->u.queue.reserved)
+                    {
+                        _t_ipc_wake(th, T_BUSY);
+                        /* A reservation holds write_to: nothing to refill */
+                        if (ipc->u.queue.reserved)
+                            break;
+                        continue;
+                    }
+                    _t_queue_put_n(ipc, th->ipc_data, 1);
+                    _t_ipc_wake(th, T_OK);
+                }
+            }
+        }
+
+        if (received)
+            *received = done;
+        if (done >= min_count)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return T_OK;
+        }
+
+        /* Not enough yet: block (woken senders run once we switch away) */
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_BUSY != ret)
+        {
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+    }
+}
+
+#if TO_USING_QUEUE_STAMP
+/**
+ * @brief Start (or stop) stamping a queue's items with their enqueue tick.
+ * @param stamp Block holding the statistics; NULL detaches.
+ * @param ticks queue_length words, one enqueue tick per ring slot.
+ * @param max_age Receivers silently drop items older than this many ticks
+ *        and count them in stats.expired (0: never drop).
+ * @return T_OK, T_BUSY if items, a reservation or a peek are outstanding.
+ * @note Statistics are cleared. Items expire on the receive path only:
+ *       t_queue_recv / _isr / _n and t_queue_peek.
+ */
+t_status_t t_queue_stamp_attach(t_ipc_t *ipc, t_queue_stamp_t *stamp, t_uint32_t *ticks, t_uint32_t max_age)
+{
+    register t_uint32_t level;
+    t_uint32_t i;
+
+    if (!ipc || (stamp && !ticks)) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+    if (stamp)
+    {
+        stamp->ticks = ticks;
+        stamp->max_age = max_age;
+        stamp->stats.count = 0;
+        stamp->stats.expired = 0;
+        stamp->stats.min = 0;
+        stamp->stats.max = 0;
+        stamp->stats.sum = 0;
+        for (i = 0; i < TO_QUEUE_LAT_BUCKETS; i++)
+            stamp->stats.hist[i] = 0;
+    }
+
+    level = t_irq_disable();
+    /* Items already queued carry no stamp */
+    if (stamp && (ipc->msg_waiting || ipc->u.queue.reserved || ipc->u.queue.peeked))
+    {
+        t_irq_enable(level);
+        return T_BUSY;
+    }
+    ipc->u.queue.stamp = stamp;
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Snapshot a queue's latency statistics.
+ * @return T_OK, T_INVALID if no stamp block is attached.
+ */
+t_status_t t_queue_stats_get(t_ipc_t *ipc, t_queue_stats_t *stats)
+{
+    register t_uint32_t level;
+
+    if (!ipc || !stats) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (!ipc->u.queue.stamp)
+    {
+        t_irq_enable(level);
+        return T_INVALID;
+    }
+    *stats = ipc->u.queue.stamp->stats;
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Clear a queue's latency statistics, keeping max_age.
+ */
+t_status_t t_queue_stats_reset(t_ipc_t *ipc)
+{
+    register t_uint32_t level;
+    t_queue_stats_t *s;
+    t_uint32_t i;
+
+    if (!ipc) 
+        return T_NULL;
+    if(IPC_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (!ipc->u.queue.stamp)
+    {
+        t_irq_enable(level);
+        return T_INVALID;
+    }
+    s = &ipc->u.queue.stamp->stats;
+    s->count = 0;
+    s->expired = 0;
+    s->min = 0;
+    s->max = 0;
+    s->sum = 0;
+    for (i = 0; i < TO_QUEUE_LAT_BUCKETS; i++)
+        s->hist[i] = 0;
+    t_irq_enable(level);
+    return T_OK;
+}
+#endif /* TO_USING_QUEUE_STAMP */
+
+#if TO_USING_PRIO_QUEUE
+/* Caller parked on a priority queue: its buffer and the message priority */
+typedef struct
+{
+    void      *data;
+    t_uint8_t prio;
+} t_pqueue_park_t;
+
+t_inline t_uint32_t _t_pqueue_highest(t_uint32_t group)
+{
+#if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)
+    return __t_ffs(group) - 1;
+#else
+    return __t_fls(group) - 1;
+#endif
+}
+
+static void _t_pqueue_init(t_ipc_t *ipc, void *pool, t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode)
+{
+    t_uint8_t *base = (t_uint8_t *)pool;
+    t_uint16_t i;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_PRIO_QUEUE;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = queue_length;
+    ipc->item_size = item_size;
+
+    /* Layout matches T_PQUEUE_POOL_SIZE: items, link[length], last[levels] */
+    ipc->u.pqueue.items = base;
+    ipc->u.pqueue.link = (t_uint16_t *)(base + ((((t_uint32_t)queue_length * item_size) + 1UL) & ~1UL));
+    ipc->u.pqueue.last = ipc->u.pqueue.link + queue_length;
+    ipc->u.pqueue.copy = _t_queue_copy_select(base, item_size);
+    ipc->u.pqueue.group = 0;
+
+    /* Every slot starts on the free chain */
+    for (i = 0; i + 1 < queue_length; i++)
+        ipc->u.pqueue.link[i] = i + 1;
+    ipc->u.pqueue.link[queue_length - 1] = TO_PQUEUE_NIL;
+    ipc->u.pqueue.free = 0;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+/**
+ * @brief Create a queue whose receivers always get the most urgent message.
+ * @param queue_pool T_PQUEUE_POOL_SIZE(queue_length, item_size) bytes,
+ *        2-byte aligned at least.
+ */
+t_status_t t_pqueue_create_static(void *queue_pool, t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!queue_pool || !item_size || !queue_length || !ipc) 
+        return T_NULL;
+    if (TO_PQUEUE_NIL == queue_length)
+        return T_INVALID;
+
+    _t_pqueue_init(ipc, queue_pool, queue_length, item_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_pqueue_create(t_uint16_t queue_length, t_uint16_t item_size, t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!item_size || !queue_length) 
+        return T_NULL;
+    if (TO_PQUEUE_NIL == queue_length)
+        return T_INVALID;
+    /* One block for object and pool, so t_ipc_delete frees both */
+    ipc = t_malloc(sizeof(t_ipc_t) + T_PQUEUE_POOL_SIZE(queue_length, item_size));
+    if(!ipc)
+        return T_ERR;
+
+    _t_pqueue_init(ipc, ipc + 1, queue_length, item_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(ipc_handle)
+        *ipc_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Append a filled slot to the FIFO of its priority level.
+ * @note Each level is a ring closed through its newest slot, so
+ *       link[last[prio]] is the oldest one and both ends are O(1).
+ */
+static void _t_pqueue_link(t_pqueue_data_t *pq, t_uint16_t slot, t_uint8_t prio)
+{
+    if (pq->group & (1UL << prio))
+    {
+        pq->link[slot] = pq->link[pq->last[prio]];
+        pq->link[pq->last[prio]] = slot;
+    }
+    else
+    {
+        pq->link[slot] = slot;
+        pq->group |= 1UL << prio;
+    }
+    pq->last[prio] = slot;
+}
+
+/**
+ * @brief Enqueue one message without blocking (caller holds the IRQ lock).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if the queue is full, T_DELETED.
+ * @note Receivers only wait on an empty queue and senders only on a full
+ *       one, so the wait list head is always the thread to serve.
+ */
+static t_status_t _t_pqueue_put(t_ipc_t *ipc, const void *data, t_uint8_t prio, t_uint8_t *need_schedule)
+{
+    t_pqueue_data_t *pq = &ipc->u.pqueue;
+    t_pqueue_park_t *park;
+    t_thread_t *th;
+    t_uint16_t slot;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    if (TO_PQUEUE_NIL == pq->free)
+        return T_ERR;
+
+    if (!t_list_isempty(&ipc->wait_list))
+    {
+        /* Empty with a receiver waiting: it gets the message directly */
+        th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+        park = (t_pqueue_park_t *)th->ipc_data;
+        pq->copy(park->data, data, ipc->item_size);
+        park->prio = prio;
+        _t_ipc_wake(th, T_OK);
+        *need_schedule = 1;
+        return T_OK;
+    }
+
+    slot = pq->free;
+    pq->free = pq->link[slot];
+    pq->copy(pq->items + (t_uint32_t)slot * ipc->item_size, data, ipc->item_size);
+    _t_pqueue_link(pq, slot, prio);
+    ipc->msg_waiting++;
+    return T_OK;
+}
+
+/**
+ * @brief Dequeue the oldest message of the most urgent level without
+ *        blocking (caller holds the IRQ lock).
+ * @param prio Optional; receives the message priority.
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if the queue is empty, T_DELETED.
+ */
+static t_status_t _t_pqueue_get(t_ipc_t *ipc, void *data, t_uint8_t *prio, t_uint8_t *need_schedule)
+{
+    t_pqueue_data_t *pq = &ipc->u.pqueue;
+    t_pqueue_park_t *park;
+    t_thread_t *th;
+    t_uint16_t slot, newest;
+    t_uint8_t level;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    if (0 == pq->group)
+        return T_ERR;
+
+    level = (t_uint8_t)_t_pqueue_highest(pq->group);
+    newest = pq->last[level];
+    slot = pq->link[newest];
+    if (slot == newest)
+        pq->group &= ~(1UL << level);
+    else
+        pq->link[newest] = pq->link[slot];
+
+    pq->copy(data, pq->items + (t_uint32_t)slot * ipc->item_size, ipc->item_size);
+    if (prio)
+        *prio = level;
+
+    if (!t_list_isempty(&ipc->wait_list))
+    {
+        /* Full with a sender waiting: its message takes the freed slot */
+        th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+        park = (t_pqueue_park_t *)th->ipc_data;
+        pq->copy(pq->items + (t_uint32_t)slot * ipc->item_size, park->data, ipc->item_size);
+        _t_pqueue_link(pq, slot, park->prio);
+        _t_ipc_wake(th, T_OK);
+        *need_schedule = 1;
+        return T_OK;
+    }
+    pq->link[slot] = pq->free;
+    pq->free = slot;
+    ipc->msg_waiting--;
+    return T_OK;
+}
+
+/**
+ * @brief Send a message with a priority; receivers get the most urgent
+ *        level first and each level in FIFO order.
+ * @param prio 0..TO_PQUEUE_PRIO_MAX-1, ordered like thread priorities.
+ * @param timeout Ticks to wait while full (0: fail at once).
+ * @return T_OK, T_ERR on timeout, T_DELETED, T_INVALID for a bad prio.
+ */
+t_status_t t_pqueue_send(t_ipc_t *ipc, const void *data, t_uint8_t prio, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_pqueue_park_t park;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_PRIO_QUEUE != ipc->type || prio >= TO_PQUEUE_PRIO_MAX)
+        return T_INVALID;
+    park.data = (void *)data;
+    park.prio = prio;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_pqueue_put(ipc, data, prio, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        /* Full: park the message, a receiver links it into the freed slot */
+        ret = _t_ipc_wait(ipc, &park, TO_IPC_WAIT_SEND, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Receive the most urgent message.
+ * @param prio Optional; receives the message priority.
+ * @param timeout Ticks to wait while empty (0: fail at once).
+ * @return T_OK, T_ERR on timeout, T_DELETED if the queue was deleted.
+ */
+t_status_t t_pqueue_recv(t_ipc_t *ipc, void *data, t_uint8_t *prio, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_pqueue_park_t park;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_PRIO_QUEUE != ipc->type)
+        return T_INVALID;
+    park.data = data;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_pqueue_get(ipc, data, prio, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        /* Empty: a sender writes straight into data */
+        ret = _t_ipc_wait(ipc, &park, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+        if (T_OK == ret && prio)
+            *prio = park.prio;
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Interrupt variant of t_pqueue_send(): T_ERR instead of blocking
+ *        when full, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_pqueue_send_isr(t_ipc_t *ipc, const void *data, t_uint8_t prio, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_PRIO_QUEUE != ipc->type || prio >= TO_PQUEUE_PRIO_MAX)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_pqueue_put(ipc, data, prio, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_pqueue_recv(): T_ERR instead of blocking
+ *        when empty, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_pqueue_recv_isr(t_ipc_t *ipc, void *data, t_uint8_t *prio, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_PRIO_QUEUE != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_pqueue_get(ipc, data, prio, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+#endif /* TO_USING_PRIO_QUEUE */
+
+#if TO_USING_TOPIC
+static void _t_topic_init(t_ipc_t *ipc, void *sample_buf, t_uint16_t sample_size)
+{
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_TOPIC;
+    ipc->status = 1;
+    ipc->mode = TO_IPC_FLAG_FIFO;
+    ipc->msg_waiting = 0;
+    ipc->length = 1;
+    ipc->item_size = sample_size;
+
+    ipc->u.topic.sample = (t_uint8_t *)sample_buf;
+    ipc->u.topic.copy = _t_queue_copy_select(sample_buf, sample_size);
+    ipc->u.topic.generation = 0;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+/**
+ * @brief Create a topic holding the latest published sample.
+ * @param sample_buf sample_size bytes for the sample.
+ */
+t_status_t t_topic_create_static(void *sample_buf, t_uint16_t sample_size, t_ipc_t *topic)
+{
+    if (!sample_buf || !sample_size || !topic) 
+        return T_NULL;
+
+    _t_topic_init(topic, sample_buf, sample_size);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    topic->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_topic_create(t_uint16_t sample_size, t_ipc_t **topic_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!sample_size) 
+        return T_NULL;
+    /* One block for object and sample, so t_ipc_delete frees both */
+    ipc = t_malloc(sizeof(t_ipc_t) + sample_size);
+    if(!ipc)
+        return T_ERR;
+
+    _t_topic_init(ipc, ipc + 1, sample_size);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(topic_handle)
+        *topic_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Store a sample and wake every waiting subscriber (caller holds
+ *        the IRQ lock).
+ * @return 1 if a thread was woken.
+ */
+static t_uint8_t _t_topic_publish(t_ipc_t *ipc, const void *data)
+{
+    t_uint8_t woken = 0;
+
+    ipc->u.topic.copy(ipc->u.topic.sample, data, ipc->item_size);
+    /* 0 is reserved for "nothing published yet" */
+    if (0 == ++ipc->u.topic.generation)
+        ipc->u.topic.generation = 1;
+
+    /* Subscribers only wait for a newer generation: release them all */
+    while (!t_list_isempty(&ipc->wait_list))
+    {
+        _t_ipc_wake(T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist), T_BUSY);
+        woken = 1;
+    }
+    return woken;
+}
+
+/**
+ * @brief Publish a sample: copied once into the topic, then every blocked
+ *        subscriber is woken in one pass with a single reschedule.
+ * @return T_OK, T_DELETED, T_INVALID if not a topic.
+ */
+t_status_t t_topic_publish(t_ipc_t *topic, const void *data)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule;
+
+    if (!topic || !data) 
+        return T_NULL;
+    if(IPC_TOPIC != topic->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (0 == topic->status)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    need_schedule = _t_topic_publish(topic, data);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return T_OK;
+}
+
+/**
+ * @brief Interrupt variant of t_topic_publish(), never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_topic_publish_isr(t_ipc_t *topic, const void *data, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_status_t ret = T_OK;
+
+    if (!topic || !data) 
+        return T_NULL;
+    if(IPC_TOPIC != topic->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (0 == topic->status)
+        ret = T_DELETED;
+    else if (_t_topic_publish(topic, data) && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Attach a subscriber to a topic.
+ * @note The first t_topic_read() returns the current sample if one was
+ *       already published, later reads only newer ones.
+ */
+t_status_t t_topic_subscribe(t_ipc_t *topic, t_topic_sub_t *sub)
+{
+    if (!topic || !sub) 
+        return T_NULL;
+    if(IPC_TOPIC != topic->type)
+        return T_INVALID;
+    sub->topic = topic;
+    sub->seen = 0;
+    return T_OK;
+}
+
+/**
+ * @brief Read the latest sample if it is newer than the subscriber's last
+ *        read, blocking up to timeout for the next publish otherwise.
+ * @param timeout 0 polls.
+ * @return T_OK, T_ERR if nothing new arrived in time, T_DELETED.
+ * @note Samples published in between are skipped, only the latest counts.
+ *       The copy out runs with interrupts enabled and is retried if a
+ *       publish lands in the middle of it.
+ */
+t_status_t t_topic_read(t_topic_sub_t *sub, void *data, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint32_t gen;
+    t_status_t ret;
+    t_ipc_t *ipc;
+
+    if (!sub || !sub->topic || !data) 
+        return T_NULL;
+    ipc = sub->topic;
+    if(IPC_TOPIC != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+        if (ipc->u.topic.generation != sub->seen)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            break;
+        }
+
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+
+    do
+    {
+        gen = ipc->u.topic.generation;
+        T_BARRIER();
+        ipc->u.topic.copy(data, ipc->u.topic.sample, ipc->item_size);
+        T_BARRIER();
+    } while (gen != ipc->u.topic.generation);
+    sub->seen = gen;
+    return T_OK;
+}
+#endif /* TO_USING_TOPIC */
+
+#if TO_USING_QUEUE_SET
+/**
+ * @brief Post a member handle into its set (caller holds the IRQ lock).
+ * @return 1 if a thread was woken.
+ * @note Reached only through the member->set check, so objects outside a
+ *       set pay a single pointer test on their send paths.
+ */
+static t_uint8_t _t_queue_set_post(t_ipc_t *member)
+{
+    t_ipc_t *set = member->set;
+    t_thread_t *rth;
+
+    if (0 == set->status)
+        return 0;
+
+    /* Same rules as t_queue_send: hand off to a blocked selector first */
+    rth = _t_ipc_waiter(set, TO_IPC_WAIT_RECV);
+    if (rth && rth->ipc_data && 0 == set->msg_waiting)
+    {
+        set->u.queue.copy(rth->ipc_data, (const t_uint8_t *)&member, set->item_size);
+        _t_ipc_wake(rth, T_OK);
+        return 1;
+    }
+    if (set->msg_waiting < set->length && !set->u.queue.reserved)
+    {
+        set->u.queue.copy(set->u.queue.write_to, (const t_uint8_t *)&member, set->item_size);
+        return _t_queue_written(set);
+    }
+    /* Set shorter than the members' total capacity: event is lost */
+    return 0;
+}
+
+/**
+ * @brief Cut an object that is being deleted out of the set bookkeeping:
+ *        a set lets go of its members, a member takes its handles back out
+ *        of its set so no selector is handed a dead object.
+ * @note Caller holds the IRQ lock. A peeked head handle is left in place.
+ */
+static void _t_queue_set_detach(t_ipc_t *ipc)
+{
+    t_ipc_t *set = ipc->set;
+    t_ipc_t *handle;
+    t_uint8_t *src, *dst;
+    t_uint16_t n, kept = 0;
+
+    if (!set)
+    {
+        while (!t_list_isempty(&ipc->set_node))
+        {
+            handle = T_LIST_ENTRY(ipc->set_node.next, t_ipc_t, set_node);
+            t_list_delete(&handle->set_node);
+            handle->set = NULL;
+        }
+        return;
+    }
+    t_list_delete(&ipc->set_node);
+    ipc->set = NULL;
+
+    /* Compact the ring in place, keeping the other members' order */
+    src = dst = set->u.queue.read_from;
+    for (n = set->msg_waiting; n; n--)
+    {
+        set->u.queue.copy((t_uint8_t *)&handle, src, set->item_size);
+        if (handle != ipc || (0 == kept && set->u.queue.peeked == src))
+        {
+            if (dst != src)
+                set->u.queue.copy(dst, src, set->item_size);
+            if ((dst += set->item_size) >= set->u.queue.tail)
+                dst = set->u.queue.head;
+            kept++;
+        }
+        if ((src += set->item_size) >= set->u.queue.tail)
+            src = set->u.queue.head;
+    }
+    set->u.queue.write_to = dst;
+    set->msg_waiting = kept;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+/**
+ * @brief Initialize a queue set: a queue of member handles.
+ * @param set_pool Storage for length handles (sizeof(t_ipc_t *) each).
+ * @param length Sum of the capacities of all members to be added.
+ */
+t_status_t t_queue_set_create_static(void *set_pool, t_uint16_t length, t_uint8_t mode, t_ipc_t *set)
+{
+    return t_queue_create_static(set_pool, length, sizeof(t_ipc_t *), mode, set);
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_queue_set_create(t_uint16_t length, t_uint8_t mode, t_ipc_t **set_handle)
+{
+    return t_queue_create(length, sizeof(t_ipc_t *), mode, set_handle);
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Register a semaphore or queue in a set.
+ * @return T_OK, T_BUSY if the member already belongs to a set or is not empty,
+ *         T_INVALID if either side would nest sets (a set with members as
+ *         the member, or a member as the set).
+ */
+t_status_t t_queue_set_add(t_ipc_t *set, t_ipc_t *member)
+{
+    register t_uint32_t level;
+
+    if (!set || !member)
+        return T_NULL;
+    if (0 == set->status || 0 == member->status)
+        return T_DELETED;
+    if (IPC_QUEUE != set->type || sizeof(t_ipc_t *) != set->item_size || set == member)
+        return T_INVALID;
+#if TO_USING_SEMAPHORE
+    if (IPC_SEMA != member->type && IPC_QUEUE != member->type)
+#else
+    if (IPC_QUEUE != member->type)
+#endif
+        return T_INVALID;
+
+    level = t_irq_disable();
+    /* Sets do not nest: a member cannot collect, a set with members cannot join */
+    if (set->set || (!member->set && !t_list_isempty(&member->set_node)))
+    {
+        t_irq_enable(level);
+        return T_INVALID;
+    }
+    /* Items already present would never be announced through the set */
+    if (member->set || member->msg_waiting)
+    {
+        t_irq_enable(level);
+        return T_BUSY;
+    }
+    member->set = set;
+    t_list_insert_before(&set->set_node, &member->set_node);
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Unregister an empty member from its set.
+ * @return T_OK, T_BUSY if the member still holds items (handles remain in the set).
+ */
+t_status_t t_queue_set_remove(t_ipc_t *set, t_ipc_t *member)
+{
+    register t_uint32_t level;
+
+    if (!set || !member)
+        return T_NULL;
+
+    level = t_irq_disable();
+    if (member->set != set)
+    {
+        t_irq_enable(level);
+        return T_INVALID;
+    }
+    if (member->msg_waiting)
+    {
+        t_irq_enable(level);
+        return T_BUSY;
+    }
+    member->set = NULL;
+    t_list_delete(&member->set_node);
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Block until any member of the set has data.
+ * @param set Queue set.
+ * @param member Receives the ready member; read it with timeout 0.
+ * @param timeout Same semantics as t_queue_recv().
+ */
+t_status_t t_queue_set_select(t_ipc_t *set, t_ipc_t **member, t_int32_t timeout)
+{
+    if (!member)
+        return T_NULL;
+    return t_queue_recv(set, member, timeout);
+}
+#endif /* TO_USING_QUEUE_SET */
+
+#endif
+
+#if TO_USING_EVENT
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_event_create_static(t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!ipc) 
+        return T_NULL;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_EVENT;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = 0;
+    ipc->item_size = 0;
+
+    ipc->u.event = 0;
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif      
+    
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_event_create(t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc = t_malloc(sizeof(t_ipc_t));
+    if(!ipc)
+        return T_ERR;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_EVENT;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = 0;
+    ipc->item_size = 0;
+
+    ipc->u.event = 0;
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif  
+
+    if(ipc_handle)
+        *ipc_handle = ipc;   
+    return T_OK;
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Test flags against a wait condition.
+ * @return Matched bits (0: not satisfied).
+ */
+t_inline t_uint32_t _t_event_match(t_uint32_t flags, t_uint32_t set, t_uint8_t option)
+{
+    if (option & TO_EVENT_AND)
+        return ((flags & set) == set) ? set : 0;
+    return flags & set;
+}
+
+/**
+ * @brief Set flags and wake every waiter they satisfy, in one pass.
+ * @param ipc Event group.
+ * @param set Bits to set.
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @note Caller holds the IRQ lock; never switches.
+ */
+static t_status_t _t_event_set(t_ipc_t *ipc, t_uint32_t set, t_uint8_t *need_schedule)
+{
+    t_uint32_t clear = 0;
+    t_uint32_t matched;
+    t_list_t *node;
+    t_thread_t *th;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    ipc->u.event |= set;
+
+    node = ipc->wait_list.next;
+    while (node != &ipc->wait_list)
+    {
+        th = T_LIST_ENTRY(node, t_thread_t, tlist);
+        node = node->next;      /* th may leave the list below */
+
+        /* Every waiter sees the flags as set; clears apply after the pass */
+        matched = _t_event_match(ipc->u.event, th->event_set, th->event_info);
+        if (matched)
+        {
+            if (th->event_info & TO_EVENT_CLEAR)
+                clear |= matched;
+            th->event_set = matched;
+            _t_ipc_wake(th, T_OK);
+            *need_schedule = 1;
+        }
+    }
+    ipc->u.event &= ~clear;
+    return T_OK;
+}
+
+/**
+ * @brief Set flags and wake the waiters they satisfy.
+ * @note Never blocks; from interrupts prefer t_event_send_isr().
+ */
+t_status_t t_event_send(t_ipc_t *ipc, t_uint32_t set)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_EVENT != ipc->type)
+        return T_INVALID;   
+
+    level = t_irq_disable();
+    ret = _t_event_set(ipc, set, &need_schedule);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_event_send(): defers the switch.
+ * @param woken See t_sema_send_isr().
+ */
+t_status_t t_event_send_isr(t_ipc_t *ipc, t_uint32_t set, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if(IPC_EVENT != ipc->type)
+        return T_INVALID;   
+
+    level = t_irq_disable();
+    ret = _t_event_set(ipc, set, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Clear flags.
+ * @note Never blocks; may be called from interrupts.
+ */
+t_status_t t_event_clear(t_ipc_t *ipc, t_uint32_t clear)
+{
+    register t_uint32_t level;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_EVENT != ipc->type)
+        return T_INVALID;   
+
+    level = t_irq_disable();
+    ipc->u.event &= ~clear;
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Wait for all (TO_EVENT_AND) or any (TO_EVENT_OR) bits of a mask.
+ * @param ipc Event group.
+ * @param set Awaited bits.
+ * @param option TO_EVENT_AND or TO_EVENT_OR, optionally | TO_EVENT_CLEAR.
+ * @param timeout Ticks to wait (0: poll).
+ * @param recved Optional; receives the matched bits.
+ * @return T_OK, T_ERR on timeout, T_DELETED if the group was deleted.
+ */
+t_status_t t_event_recv(t_ipc_t *ipc, t_uint32_t set, t_uint8_t option, t_int32_t timeout, t_uint32_t *recved)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint32_t matched;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;   
+    if(IPC_EVENT != ipc->type)
+        return T_INVALID;   
+    if (0 == set || (option & (TO_EVENT_AND | TO_EVENT_OR)) == 0 ||
+        (option & (TO_EVENT_AND | TO_EVENT_OR)) == (TO_EVENT_AND | TO_EVENT_OR))
+        return T_INVALID;
+
+    level = t_irq_disable();
+
+    if (0 == ipc->status)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    matched = _t_event_match(ipc->u.event, set, option);
+    if (matched)
+    {
+        if (option & TO_EVENT_CLEAR)
+            ipc->u.event &= ~matched;
+        t_irq_enable(level);
+        if (recved)
+            *recved = matched;
+        return T_OK;
+    }
+
+    if (0 == timeout)
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+    if (!t_current_thread)
+    {
+        t_irq_enable(level);
+        return T_UNSUPPORTED;
+    }
+
+    /* The setter evaluates the condition and completes the wait for us */
+    t_current_thread->event_set = set;
+    t_current_thread->event_info = option;
+
+    ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+    if (T_OK == ret && recved)
+        *recved = t_current_thread->event_set;
+    return ret;
+}
+
+#endif /* TO_USING_EVENT */
+
+#if TO_USING_RWLOCK
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_rwlock_create_static(t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!ipc) 
+        return T_NULL;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_RWLOCK;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = 0;
+    ipc->item_size = 0;
+
+    ipc->u.rwlock.writer = NULL;
+    ipc->u.rwlock.readers = 0;
+    ipc->u.rwlock.writers_waiting = 0;
+    ipc->u.rwlock.original_prio = DUMMY_PRIORITY;
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    t_list_init(&ipc->held);
+#endif
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif      
+    
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_rwlock_create(t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc = t_malloc(sizeof(t_ipc_t));
+    if(!ipc)
+        return T_ERR;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_RWLOCK;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = 0;
+    ipc->item_size = 0;
+
+    ipc->u.rwlock.writer = NULL;
+    ipc->u.rwlock.readers = 0;
+    ipc->u.rwlock.writers_waiting = 0;
+    ipc->u.rwlock.original_prio = DUMMY_PRIORITY;
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    t_list_init(&ipc->held);
+#endif
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif  
+    if(ipc_handle)
+        *ipc_handle = ipc;
+    
+    return T_OK;
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Lend the caller's priority to the writer it is about to wait for.
+ * @note Caller holds the IRQ lock. Readers are not boosted: there is no
+ *       single owner to restore afterwards. With mutex support the lock is
+ *       tracked in the writer's held_list, so the boost survives the writer
+ *       releasing a mutex and follows the writer's own blocking chain.
+ */
+static void _t_rwlock_inherit(t_ipc_t *ipc)
+{
+    t_thread_t *writer = ipc->u.rwlock.writer;
+
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    if (writer && t_current_thread)
+    {
+        _t_mutex_track(ipc, writer);
+        _t_mutex_pi_update(writer, t_current_thread->current_priority);
+    }
+#else
+#if TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY
+    if (writer && t_current_thread &&
+        t_current_thread->current_priority < writer->current_priority)
+#else
+    if (writer && t_current_thread &&
+        t_current_thread->current_priority > writer->current_priority)
+#endif
+    {
+        if (DUMMY_PRIORITY == ipc->u.rwlock.original_prio)
+            ipc->u.rwlock.original_prio = writer->current_priority;
+        t_thread_requeue(writer, t_current_thread->current_priority);
+    }
+#endif
+}
+
+/**
+ * @brief Hand a free lock to the waiters that may now own it.
+ * @note Caller holds the IRQ lock. A queued writer goes first and inherits
+ *       from the waiters left behind it; readers are admitted together only
+ *       when no writer is queued.
+ * @return 1 if a thread was woken.
+ */
+static t_uint8_t _t_rwlock_grant(t_ipc_t *ipc)
+{
+    t_thread_t *th;
+    t_list_t *node;
+    t_uint8_t woken = 0;
+
+    if (ipc->u.rwlock.writer)
+        return 0;
+
+    if (ipc->u.rwlock.writers_waiting)
+    {
+        th = _t_ipc_waiter(ipc, TO_IPC_WAIT_SEND);
+        if (ipc->u.rwlock.readers || !th)
+            return 0;
+        ipc->u.rwlock.writers_waiting--;
+        ipc->u.rwlock.writer = th;
+        ipc->u.rwlock.original_prio = th->current_priority;
+        _t_ipc_wake(th, T_OK);
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+        /* Those still queued lent to the previous writer: lend to this one */
+        if (!t_list_isempty(&ipc->wait_list))
+        {
+            _t_mutex_track(ipc, th);
+            _t_mutex_pi_update(th, DUMMY_PRIORITY);
+        }
+#endif
+        return 1;
+    }
+
+    node = ipc->wait_list.next;
+    while (node != &ipc->wait_list)
+    {
+        th = T_LIST_ENTRY(node, t_thread_t, tlist);
+        node = node->next;      /* th may leave the list below */
+        if (TO_IPC_WAIT_RECV == th->ipc_flag)
+        {
+            ipc->u.rwlock.readers++;
+            _t_ipc_wake(th, T_OK);
+            woken = 1;
+        }
+    }
+    return woken;
+}
+
+/**
+ * @brief Acquire shared (read) access.
+ * @note Blocks while a writer holds the lock or is queued for it, so a
+ *       steady stream of readers cannot starve writers. Not recursive
+ *       across a queued writer.
+ */
+t_status_t t_rwlock_read_lock(t_ipc_t *ipc, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_RWLOCK != ipc->type)
+        return T_INVALID;
+
+    while (1)
+    {
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+        if (!ipc->u.rwlock.writer && 0 == ipc->u.rwlock.writers_waiting)
+        {
+            ipc->u.rwlock.readers++;
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_OK;
+        }
+        if (0 == timeout)
+        {
+            t_irq_enable(level);
+            return T_ERR;
+        }
+
+        _t_rwlock_inherit(ipc);
+        /* T_OK: a releasing thread already counted us in */
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_RECV,
+                          &timeout, &armed, level);
+        if (T_OK == ret || T_DELETED == ret)
+            return ret;
+
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+        /* Not admitted: take back what we lent the writer */
+        level = t_irq_disable();
+        if (ipc->status)
+            _t_mutex_pi_update(ipc->u.rwlock.writer, DUMMY_PRIORITY);
+        t_irq_enable(level);
+#endif
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Drop shared access; the last reader out hands over to a writer.
+ */
+t_status_t t_rwlock_read_unlock(t_ipc_t *ipc)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_RWLOCK != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (0 == ipc->u.rwlock.readers)
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+    if (0 == --ipc->u.rwlock.readers)
+        need_schedule = _t_rwlock_grant(ipc);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return T_OK;
+}
+
+/**
+ * @brief Acquire exclusive (write) access.
+ * @note Not recursive: a writer locking again gets T_ERR.
+ */
+t_status_t t_rwlock_write_lock(t_ipc_t *ipc, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_RWLOCK != ipc->type)
+        return T_INVALID;
+    /* The writer is a thread: no owner to record before the scheduler runs */
+    if (!t_current_thread)
+        return T_UNSUPPORTED;
+
+    while (1)
+    {
+        level = t_irq_disable();
+
+        if (0 == ipc->status)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_DELETED;
+        }
+        if (!ipc->u.rwlock.writer && 0 == ipc->u.rwlock.readers)
+        {
+            ipc->u.rwlock.writer = t_current_thread;
+            ipc->u.rwlock.original_prio = t_current_thread->current_priority;
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_OK;
+        }
+        if (0 == timeout || ipc->u.rwlock.writer == t_current_thread)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_ERR;
+        }
+
+        _t_rwlock_inherit(ipc);
+        /* Counted before sleeping: new readers queue behind us from now on */
+        ipc->u.rwlock.writers_waiting++;
+        ret = _t_ipc_wait(ipc, NULL, TO_IPC_WAIT_SEND,
+                          &timeout, &armed, level);
+        if (T_OK == ret || T_DELETED == ret)
+            return ret;
+
+        /* Not granted: withdraw, and let readers held off by us proceed */
+        level = t_irq_disable();
+        ipc->u.rwlock.writers_waiting--;
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+        if (ipc->status)
+            _t_mutex_pi_update(ipc->u.rwlock.writer, DUMMY_PRIORITY);
+#endif
+        need_schedule = _t_rwlock_grant(ipc);
+        t_irq_enable(level);
+        if (need_schedule)
+            t_sched_switch();
+
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Drop exclusive access and undo any inherited priority.
+ */
+t_status_t t_rwlock_write_unlock(t_ipc_t *ipc)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule;
+
+    if (!ipc) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_RWLOCK != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (t_current_thread != ipc->u.rwlock.writer)
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+    ipc->u.rwlock.writer = NULL;
+
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    /* Keep what the other held locks still lend */
+    t_list_delete(&ipc->held);
+    if (t_current_thread->current_priority != _t_mutex_entitled(t_current_thread))
+        t_thread_requeue(t_current_thread, _t_mutex_entitled(t_current_thread));
+#else
+    if (ipc->u.rwlock.original_prio != DUMMY_PRIORITY &&
+        t_current_thread->current_priority != ipc->u.rwlock.original_prio)
+        t_thread_requeue(t_current_thread, ipc->u.rwlock.original_prio);
+#endif
+    ipc->u.rwlock.original_prio = DUMMY_PRIORITY;
+
+    need_schedule = _t_rwlock_grant(ipc);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return T_OK;
+}
+#endif /* TO_USING_RWLOCK */
+
+#if TO_USING_MAILBOX
+static void _t_mailbox_init(t_ipc_t *ipc, t_uint32_t *pool, t_uint16_t size, t_uint8_t mode)
+{
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_MAILBOX;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = size;
+    ipc->item_size = sizeof(t_uint32_t);
+
+    ipc->u.mailbox.pool = pool;
+    ipc->u.mailbox.in = 0;
+    ipc->u.mailbox.out = 0;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_mailbox_create_static(t_uint32_t *mailbox_pool, t_uint16_t size, t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!mailbox_pool || !size || !ipc) 
+        return T_NULL;
+
+    _t_mailbox_init(ipc, mailbox_pool, size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_mailbox_create(t_uint16_t size, t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!size) 
+        return T_NULL;
+    /* One block for object and ring, so t_ipc_delete frees both */
+    ipc = t_malloc(sizeof(t_ipc_t) + (size_t)size * sizeof(t_uint32_t));
+    if(!ipc)
+        return T_ERR;
+
+    _t_mailbox_init(ipc, (t_uint32_t *)(ipc + 1), size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(ipc_handle)
+        *ipc_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Post one message without blocking (caller holds the IRQ lock).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if the mailbox is full, T_DELETED.
+ * @note Fetchers only wait on an empty mailbox and posters only on a full
+ *       one, so the wait list never mixes the two and its head is always
+ *       the thread to serve.
+ */
+static t_status_t _t_mailbox_post(t_ipc_t *ipc, t_uint32_t msg, t_uint8_t *need_schedule)
+{
+    t_thread_t *th;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    if (ipc->msg_waiting >= ipc->length)
+        return T_ERR;
+
+    if (!t_list_isempty(&ipc->wait_list))
+    {
+        /* Empty with a fetcher waiting: hand the message over */
+        th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+        *(t_uint32_t *)th->ipc_data = msg;
+        _t_ipc_wake(th, T_OK);
+        *need_schedule = 1;
+        return T_OK;
+    }
+    ipc->u.mailbox.pool[ipc->u.mailbox.in] = msg;
+    if (++ipc->u.mailbox.in == ipc->length)
+        ipc->u.mailbox.in = 0;
+    ipc->msg_waiting++;
+    return T_OK;
+}
+
+/**
+ * @brief Fetch one message without blocking (caller holds the IRQ lock).
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_ERR if the mailbox is empty, T_DELETED.
+ */
+static t_status_t _t_mailbox_fetch(t_ipc_t *ipc, t_uint32_t *msg, t_uint8_t *need_schedule)
+{
+    t_thread_t *th;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    if (0 == ipc->msg_waiting)
+        return T_ERR;
+
+    *msg = ipc->u.mailbox.pool[ipc->u.mailbox.out];
+    if (++ipc->u.mailbox.out == ipc->length)
+        ipc->u.mailbox.out = 0;
+
+    if (!t_list_isempty(&ipc->wait_list))
+    {
+        /* Full with a poster waiting: its message refills the freed slot */
+        th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+        ipc->u.mailbox.pool[ipc->u.mailbox.in] = *(t_uint32_t *)th->ipc_data;
+        if (++ipc->u.mailbox.in == ipc->length)
+            ipc->u.mailbox.in = 0;
+        _t_ipc_wake(th, T_OK);
+        *need_schedule = 1;
+        return T_OK;
+    }
+    ipc->msg_waiting--;
+    return T_OK;
+}
+
+/**
+ * @brief Post a word-sized message (typically a buffer pointer).
+ * @param ipc Mailbox.
+ * @param msg Message.
+ * @param timeout Ticks to wait while full (0: fail at once).
+ * @return T_OK, T_ERR on timeout, T_DELETED if the mailbox was deleted.
+ */
+t_status_t t_mailbox_post(t_ipc_t *ipc, t_uint32_t msg, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if(IPC_MAILBOX != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_mailbox_post(ipc, msg, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        /* Full: park the message, a fetcher moves it into the ring */
+        ret = _t_ipc_wait(ipc, &msg, TO_IPC_WAIT_SEND, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Fetch the oldest message.
+ * @param ipc Mailbox.
+ * @param msg Receives the message.
+ * @param timeout Ticks to wait while empty (0: fail at once).
+ * @return T_OK, T_ERR on timeout, T_DELETED if the mailbox was deleted.
+ */
+t_status_t t_mailbox_fetch(t_ipc_t *ipc, t_uint32_t *msg, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    if (!ipc || !msg) 
+        return T_NULL;
+    if(IPC_MAILBOX != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        ret = _t_mailbox_fetch(ipc, msg, &need_schedule);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
+        }
+
+        /* Empty: a poster writes straight into *msg */
+        ret = _t_ipc_wait(ipc, msg, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Interrupt variant of t_mailbox_post(): T_ERR instead of blocking
+ *        when full, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_mailbox_post_isr(t_ipc_t *ipc, t_uint32_t msg, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc) 
+        return T_NULL;
+    if(IPC_MAILBOX != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_mailbox_post(ipc, msg, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_mailbox_fetch(): T_ERR instead of blocking
+ *        when empty, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_mailbox_fetch_isr(t_ipc_t *ipc, t_uint32_t *msg, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !msg) 
+        return T_NULL;
+    if(IPC_MAILBOX != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_mailbox_fetch(ipc, msg, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+#endif /* TO_USING_MAILBOX */
+
+#if TO_USING_BUFPOOL
+static void _t_bufpool_init(t_ipc_t *ipc, void *pool, t_uint16_t count, t_uint16_t buf_size, t_uint8_t mode)
+{
+    t_uint8_t *base = (t_uint8_t *)pool;
+    t_uint32_t stride = T_BUF_STRIDE(buf_size);
+    t_buf_t *b;
+    t_uint16_t i;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_BUFPOOL;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = count;   /* Free buffers */
+    ipc->length = count;
+    ipc->item_size = buf_size;
+
+    /* Build the free list so buffers are handed out in address order */
+    ipc->u.bufpool.free = NULL;
+    for (i = count; i > 0; i--)
+    {
+        b = (t_buf_t *)(base + (t_uint32_t)(i - 1) * stride);
+        b->pool = ipc;
+        b->refcnt = 0;
+        b->len = 0;
+        b->chained = 0;
+        b->next = ipc->u.bufpool.free;
+        ipc->u.bufpool.free = b;
+    }
+    ipc->u.bufpool.allocs = 0;
+    ipc->u.bufpool.min_free = count;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+/**
+ * @brief Create a pool of count reference-counted buffers.
+ * @param pool T_BUFPOOL_POOL_SIZE(count, buf_size) bytes, 4-byte aligned.
+ * @param buf_size Payload bytes per buffer.
+ */
+t_status_t t_bufpool_create_static(void *pool, t_uint16_t count, t_uint16_t buf_size, t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!pool || !count || !buf_size || !ipc) 
+        return T_NULL;
+
+    _t_bufpool_init(ipc, pool, count, buf_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_bufpool_create(t_uint16_t count, t_uint16_t buf_size, t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!count || !buf_size) 
+        return T_NULL;
+    /* One block for object and buffers, so t_ipc_delete frees both */
+    ipc = t_malloc(sizeof(t_ipc_t) + T_BUFPOOL_POOL_SIZE(count, buf_size));
+    if(!ipc)
+        return T_ERR;
+
+    _t_bufpool_init(ipc, ipc + 1, count, buf_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(ipc_handle)
+        *ipc_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Pool usage counters: buffers free now, the lowest free count seen
+ *        and the number of buffers handed out so far (each optional).
+ */
+t_status_t t_bufpool_stats(t_ipc_t *ipc, t_uint16_t *free_now, t_uint16_t *min_free, t_uint32_t *allocs)
+{
+    register t_uint32_t level;
+
+    if (!ipc) 
+        return T_NULL;
+    if(IPC_BUFPOOL != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (free_now)
+        *free_now = ipc->msg_waiting;
+    if (min_free)
+        *min_free = ipc->u.bufpool.min_free;
+    if (allocs)
+        *allocs = ipc->u.bufpool.allocs;
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Hand a buffer out with one reference.
+ */
+t_inline void _t_buf_claim(t_ipc_t *ipc, t_buf_t *b)
+{
+    b->next = NULL;
+    b->refcnt = 1;
+    b->len = 0;
+    b->chained = 0;
+    ipc->u.bufpool.allocs++;
+}
+
+/**
+ * @brief Take a buffer without blocking (caller holds the IRQ lock).
+ * @return T_OK, T_ERR if the pool is empty, T_DELETED.
+ */
+static t_status_t _t_buf_get(t_ipc_t *ipc, t_buf_t **buf)
+{
+    t_buf_t *b;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    b = ipc->u.bufpool.free;
+    if (!b)
+        return T_ERR;
+
+    ipc->u.bufpool.free = b->next;
+    if (--ipc->msg_waiting < ipc->u.bufpool.min_free)
+        ipc->u.bufpool.min_free = ipc->msg_waiting;
+    _t_buf_claim(ipc, b);
+    *buf = b;
+    return T_OK;
+}
+
+/**
+ * @brief Drop one reference from each buffer of a chain until one is still
+ *        in use (caller holds the IRQ lock).
+ * @param need_schedule Set to 1 if a blocked allocator was woken.
+ * @return T_OK, T_INVALID if a buffer it would drop is already free; the
+ *         chain is then left untouched.
+ * @note A chained buffer is referenced by its predecessor, so freeing the
+ *       head of a frame releases the rest unless someone else holds it.
+ *       Allocators only wait on an empty pool, so a returned buffer goes
+ *       straight to the first of them.
+ */
+static t_status_t _t_buf_release(t_buf_t *b, t_uint8_t *need_schedule)
+{
+    t_ipc_t *ipc;
+    t_buf_t *next;
+    t_thread_t *th;
+
+    for (next = b; next; next = next->next)
+    {
+        if (0 == next->refcnt)
+            return T_INVALID;
+        if (next->refcnt > 1)
+            break;      /* still in use: the walk below stops here */
+    }
+    while (b && 0 == --b->refcnt)
+    {
+        next = b->next;
+        if (next)
+            next->chained = 0;
+        ipc = b->pool;
+        if (!t_list_isempty(&ipc->wait_list))
+        {
+            th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+            _t_buf_claim(ipc, b);
+            *(t_buf_t **)th->ipc_data = b;
+            _t_ipc_wake(th, T_OK);
+            *need_schedule = 1;
+        }
+        else
+        {
+            b->next = ipc->u.bufpool.free;
+            ipc->u.bufpool.free = b;
+            ipc->msg_waiting++;
+        }
+        b = next;
+    }
+    return T_OK;
+}
+
+/**
+ * @brief Allocate a buffer holding one reference, next = NULL, len = 0.
+ * @param timeout Ticks to wait while the pool is empty (0: fail at once).
+ * @return T_OK, T_ERR on timeout, T_DELETED if the pool was deleted.
+ */
+t_status_t t_buf_alloc(t_ipc_t *ipc, t_buf_t **buf, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_status_t ret;
+
+    if (!ipc || !buf) 
+        return T_NULL;
+    if(IPC_BUFPOOL != ipc->type)
+        return T_INVALID;
+    while (1)
+    {
+        level = t_irq_disable();
+
+        ret = _t_buf_get(ipc, buf);
+        if (T_ERR != ret)
+        {
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return ret;
+        }
+
+        /* Empty: the next freed buffer is stored straight into *buf */
+        ret = _t_ipc_wait(ipc, buf, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
+
+/**
+ * @brief Interrupt variant of t_buf_alloc(): T_ERR instead of blocking.
+ */
+t_status_t t_buf_alloc_isr(t_ipc_t *ipc, t_buf_t **buf)
+{
+    register t_uint32_t level;
+    t_status_t ret;
+
+    if (!ipc || !buf) 
+        return T_NULL;
+    if(IPC_BUFPOOL != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_buf_get(ipc, buf);
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Take an extra reference, e.g. before handing a frame to a
+ *        second consumer. Usable from interrupts.
+ * @return T_OK, T_INVALID if the buffer is free or the count saturated.
+ */
+t_status_t t_buf_ref(t_buf_t *buf)
+{
+    register t_uint32_t level;
+    t_status_t ret = T_OK;
+
+    if (!buf) 
+        return T_NULL;
+
+    level = t_irq_disable();
+    if (0 == buf->refcnt || 0xFFFF == buf->refcnt)
+        ret = T_INVALID;
+    else
+        buf->refcnt++;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Drop a reference; buffers reaching zero return to their pool
+ *        together with the rest of their chain.
+ * @return T_OK, T_INVALID on a double free.
+ */
+t_status_t t_buf_free(t_buf_t *buf)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!buf) 
+        return T_NULL;
+
+    level = t_irq_disable();
+    ret = _t_buf_release(buf, &need_schedule);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_buf_free(), never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_buf_free_isr(t_buf_t *buf, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!buf) 
+        return T_NULL;
+
+    level = t_irq_disable();
+    ret = _t_buf_release(buf, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Append the chain tail to the end of the chain head.
+ * @return T_OK, T_INVALID if either buffer is free, tail already follows
+ *         another buffer, or the link would close a loop.
+ * @note The caller's reference to tail moves into the chain; head must not
+ *       be shared while it is being extended.
+ */
+t_status_t t_buf_chain(t_buf_t *head, t_buf_t *tail)
+{
+    t_buf_t *b;
+
+    if (!head || !tail) 
+        return T_NULL;
+    if (0 == head->refcnt || 0 == tail->refcnt || tail->chained)
+        return T_INVALID;
+    /* Every buffer has one predecessor at most, so a loop must pass head */
+    for (b = tail; b; b = b->next)
+        if (b == head)
+            return T_INVALID;
+    while (head->next)
+        head = head->next;
+    head->next = tail;
+    tail->chained = 1;
+    return T_OK;
+}
+
+#if (TO_USING_QUEUE || TO_USING_MAILBOX)
+/**
+ * @brief Pass a buffer handle through a queue (item_size must be
+ *        sizeof(t_buf_t *)) or a mailbox.
+ * @return As t_queue_send() / t_mailbox_post(). On T_OK the caller's
+ *         reference travels with the handle, otherwise it stays with the caller.
+ */
+t_status_t t_buf_send(t_ipc_t *ipc, t_buf_t *buf, t_int32_t timeout)
+{
+    if (!ipc || !buf) 
+        return T_NULL;
+#if TO_USING_QUEUE
+    if (IPC_QUEUE == ipc->type)
+    {
+        if (sizeof(t_buf_t *) != ipc->item_size)
+            return T_INVALID;
+        return t_queue_send(ipc, &buf, timeout);
+    }
+#endif
+#if TO_USING_MAILBOX
+    if (IPC_MAILBOX == ipc->type)
+    {
+        if (sizeof(t_buf_t *) != sizeof(t_uint32_t))
+            return T_UNSUPPORTED;
+        return t_mailbox_post(ipc, (t_uint32_t)(size_t)buf, timeout);
+    }
+#endif
+    return T_INVALID;
+}
+
+/**
+ * @brief Send a new reference to buf, keeping the caller's own: the way
+ *        one frame fans out to several consumers without a copy.
+ */
+t_status_t t_buf_share(t_ipc_t *ipc, t_buf_t *buf, t_int32_t timeout)
+{
+    t_status_t ret;
+
+    ret = t_buf_ref(buf);
+    if (T_OK != ret)
+        return ret;
+    ret = t_buf_send(ipc, buf, timeout);
+    if (T_OK != ret)
+        t_buf_free(buf);
+    return ret;
+}
+
+/**
+ * @brief Receive a buffer handle sent with t_buf_send() / t_buf_share();
+ *        the receiver owns the reference and frees it when done.
+ */
+t_status_t t_buf_recv(t_ipc_t *ipc, t_buf_t **buf, t_int32_t timeout)
+{
+    if (!ipc || !buf) 
+        return T_NULL;
+#if TO_USING_QUEUE
+    if (IPC_QUEUE == ipc->type)
+    {
+        if (sizeof(t_buf_t *) != ipc->item_size)
+            return T_INVALID;
+        return t_queue_recv(ipc, buf, timeout);
+    }
+#endif
+#if TO_USING_MAILBOX
+    if (IPC_MAILBOX == ipc->type)
+    {
+        t_uint32_t msg;
+        t_status_t ret;
+
+        if (sizeof(t_buf_t *) != sizeof(t_uint32_t))
+            return T_UNSUPPORTED;
+        ret = t_mailbox_fetch(ipc, &msg, timeout);
+        if (T_OK == ret)
+            *buf = (t_buf_t *)(size_t)msg;
+        return ret;
+    }
+#endif
+    return T_INVALID;
+}
+#endif /* (TO_USING_QUEUE || TO_USING_MAILBOX) */
+#endif /* TO_USING_BUFPOOL */
+
+#if TO_USING_BARRIER
+static void _t_barrier_init(t_ipc_t *ipc, t_uint16_t parties)
+{
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_BARRIER;
+    ipc->status = 1;
+    ipc->mode = TO_IPC_FLAG_FIFO;   /* Every waiter is released at once */
+    ipc->msg_waiting = 0;           /* Parties arrived in this round */
+    ipc->length = parties;
+    ipc->item_size = 0;
+
+    ipc->u.barrier = 0;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_barrier_create_static(t_uint16_t parties, t_ipc_t *barrier)
+{
+    if (!parties || !barrier) 
+        return T_NULL;
+
+    _t_barrier_init(barrier, parties);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    barrier->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_barrier_create(t_uint16_t parties, t_ipc_t **barrier_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!parties) 
+        return T_NULL;
+    ipc = t_malloc(sizeof(t_ipc_t));
+    if(!ipc)
+        return T_ERR;
+
+    _t_barrier_init(ipc, parties);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(barrier_handle)
+        *barrier_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Wait until all parties of the barrier have arrived.
+ * @param barrier Barrier.
+ * @param timeout Ticks to wait for the other parties (0: fail at once
+ *        unless this call completes the round).
+ * @return T_OK once the round completes, T_ERR on timeout (the arrival is
+ *         withdrawn), T_DELETED if the barrier was deleted.
+ * @note The last arrival wakes every waiter in one pass and switches once.
+ *       The barrier rearms itself for the next round.
+ */
+t_status_t t_barrier_wait(t_ipc_t *barrier, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule = 0;
+    t_uint32_t round;
+    t_status_t ret;
+
+    if (!barrier) 
+        return T_NULL;
+    if(IPC_BARRIER != barrier->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    if (0 == barrier->status)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    if (barrier->msg_waiting + 1 >= barrier->length)
+    {
+        /* Last arrival: release the round */
+        while (!t_list_isempty(&barrier->wait_list))
+        {
+            _t_ipc_wake(T_LIST_ENTRY(barrier->wait_list.next, t_thread_t, tlist), T_OK);
+            need_schedule = 1;
+        }
+        barrier->msg_waiting = 0;
+        barrier->u.barrier++;
+        t_irq_enable(level);
+
+        if (need_schedule)
+            t_sched_switch();
+        return T_OK;
+    }
+    barrier->msg_waiting++;
+    round = barrier->u.barrier;
+
+    while (1)
+    {
+        ret = _t_ipc_wait(barrier, NULL, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+        if (T_OK == ret || T_DELETED == ret)
+            return ret;
+
+        level = t_irq_disable();
+        if (round != barrier->u.barrier)
+        {
+            /* Released between the timeout and this check: still a pass */
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            return T_OK;
+        }
+        if (T_BUSY != ret)
+        {
+            barrier->msg_waiting--;
+            t_irq_enable(level);
+            return ret;
+        }
+    }
+}
+#endif /* TO_USING_BARRIER */
+
+#if TO_USING_RENDEZVOUS
+static void _t_rendezvous_init(t_ipc_t *ipc, t_uint16_t item_size, t_uint8_t mode)
+{
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
 
-        t_irq_enable(level);
-        t_sched_switch();
+    ipc->type = IPC_RENDEZVOUS;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = 0;
+    ipc->length = 0;
+    ipc->item_size = item_size;
 
-        /* After wake up, check status and timeout */
-        if (0 == ipc->status)
-            return T_DELETED;
+    /* Both ends are caller buffers; the kernels check their alignment */
+    ipc->u.rendezvous = _t_queue_copy_select(NULL, item_size);
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+t_status_t t_rendezvous_create_static(t_uint16_t item_size, t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!item_size || !ipc) 
+        return T_NULL;
+
+    _t_rendezvous_init(ipc, item_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_rendezvous_create(t_uint16_t item_size, t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!item_size) 
+        return T_NULL;
+    ipc = t_malloc(sizeof(t_ipc_t));
+    if(!ipc)
+        return T_ERR;
+
+    _t_rendezvous_init(ipc, item_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(ipc_handle)
+        *ipc_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Complete a transfer with a parked partner (caller holds the IRQ lock).
+ * @param dir Direction the partner must be waiting in.
+ * @param src Source buffer, NULL to take the partner's parked buffer.
+ * @param dst Destination buffer, NULL to fill the partner's parked buffer.
+ * @param need_schedule Set to 1 if the partner was woken.
+ * @return T_OK, T_ERR if no partner waits, T_DELETED.
+ * @note Senders only wait while no receiver does and vice versa, so the
+ *       wait list never mixes the two and its head is the partner to serve.
+ */
+static t_status_t _t_rendezvous_meet(t_ipc_t *ipc, t_uint8_t dir, const void *src,
+                                     void *dst, t_uint8_t *need_schedule)
+{
+    t_thread_t *th;
+
+    if (0 == ipc->status)
+        return T_DELETED;
+    if (t_list_isempty(&ipc->wait_list))
+        return T_ERR;
+    th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+    if (dir != th->ipc_flag)
+        return T_ERR;
 
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
+    ipc->u.rendezvous(dst ? (t_uint8_t *)dst : (t_uint8_t *)th->ipc_data,
+                      src ? (const t_uint8_t *)src : (const t_uint8_t *)th->ipc_data,
+                      ipc->item_size);
+    _t_ipc_wake(th, T_OK);
+    *need_schedule = 1;
+    return T_OK;
+}
+
+/**
+ * @brief Blocking side of a transfer: meet a waiting partner or park the
+ *        caller's buffer until one arrives.
+ */
+static t_status_t _t_rendezvous_xfer(t_ipc_t *ipc, t_uint8_t dir, const void *src,
+                                     void *dst, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_uint8_t need_schedule;
+    t_status_t ret;
+
+    while (1)
+    {
+        need_schedule = 0;
+        level = t_irq_disable();
+
+        /* A sender meets a waiting receiver and vice versa */
+        ret = _t_rendezvous_meet(ipc, TO_IPC_WAIT_SEND == dir ? TO_IPC_WAIT_RECV : TO_IPC_WAIT_SEND,
+                                 src, dst, &need_schedule);
+        if (T_ERR != ret)
         {
-            t_uint32_t now = t_tick_get();
-            t_uint32_t elapsed = get_tick_diff(start_tick, now);
-            if (elapsed >= timeout)
-                return T_ERR;
-            timeout -= (t_int32_t)elapsed;
-            start_tick = now;
+            _t_ipc_wait_done(armed);
+            t_irq_enable(level);
+            if (need_schedule)
+                t_sched_switch();
+            return ret;
         }
 
-        /* Retry after wait */
-        continue;
+        /* No partner: the one that arrives copies through the parked buffer */
+        ret = _t_ipc_wait(ipc, src ? (void *)src : dst, dir, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
     }
-    
 }
 
-t_status_t t_queue_recv(t_ipc_t *ipc, void *data, t_int32_t timeout)
+/**
+ * @brief Hand one item to a receiver, waiting until one takes it.
+ * @param ipc Rendezvous channel.
+ * @param data Item of item_size bytes.
+ * @param timeout Ticks to wait for a receiver (0: fail unless one waits).
+ * @return T_OK once the receiver holds the item, T_ERR on timeout,
+ *         T_DELETED if the channel was deleted.
+ */
+t_status_t t_rendezvous_send(t_ipc_t *ipc, const void *data, t_int32_t timeout)
+{
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_RENDEZVOUS != ipc->type)
+        return T_INVALID;
+    return _t_rendezvous_xfer(ipc, TO_IPC_WAIT_SEND, data, NULL, timeout);
+}
+
+/**
+ * @brief Take one item from a sender, waiting until one offers it.
+ * @param ipc Rendezvous channel.
+ * @param data Receives item_size bytes.
+ * @param timeout Ticks to wait for a sender (0: fail unless one waits).
+ * @return T_OK, T_ERR on timeout, T_DELETED if the channel was deleted.
+ */
+t_status_t t_rendezvous_recv(t_ipc_t *ipc, void *data, t_int32_t timeout)
+{
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_RENDEZVOUS != ipc->type)
+        return T_INVALID;
+    return _t_rendezvous_xfer(ipc, TO_IPC_WAIT_RECV, NULL, data, timeout);
+}
+
+/**
+ * @brief Interrupt variant of t_rendezvous_send(): T_ERR unless a receiver
+ *        is already waiting, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_rendezvous_send_isr(t_ipc_t *ipc, const void *data, t_uint8_t *woken)
 {
     register t_uint32_t level;
-    t_uint32_t start_tick = 0;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
 
-    if (!ipc) 
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_RENDEZVOUS != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_rendezvous_meet(ipc, TO_IPC_WAIT_RECV, data, NULL, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_rendezvous_recv(): T_ERR unless a sender
+ *        is already waiting, never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_rendezvous_recv_isr(t_ipc_t *ipc, void *data, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !data) 
+        return T_NULL;
+    if(IPC_RENDEZVOUS != ipc->type)
+        return T_INVALID;
+
+    level = t_irq_disable();
+    ret = _t_rendezvous_meet(ipc, TO_IPC_WAIT_SEND, NULL, data, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+#endif /* TO_USING_RENDEZVOUS */
+
+#if TO_USING_MPOOL
+static void _t_mpool_init(t_ipc_t *ipc, void *pool, t_uint16_t count, t_uint16_t block_size, t_uint8_t mode)
+{
+    t_uint16_t stride = (t_uint16_t)T_MPOOL_STRIDE(block_size);
+    t_uint16_t i;
+
+    t_list_init(&ipc->wait_list);
+    ipc->wait_count[TO_IPC_WAIT_RECV] = ipc->wait_count[TO_IPC_WAIT_SEND] = 0;
+#if TO_USING_IPC_PRIO_BITMAP
+    ipc->prio_group = 0;
+#endif
+#if TO_USING_QUEUE_SET
+    ipc->set = NULL;
+    t_list_init(&ipc->set_node);
+#endif
+
+    ipc->type = IPC_MPOOL;
+    ipc->status = 1;
+    ipc->mode = mode;
+    ipc->msg_waiting = count;     /* Free blocks */
+    ipc->length = count;
+    ipc->item_size = block_size;
+
+    ipc->u.mpool.blocks = (t_uint8_t *)pool;
+    ipc->u.mpool.stride = stride;
+    for (i = 0; i < count; i++)
+        *(t_uint16_t *)(ipc->u.mpool.blocks + (t_uint32_t)i * stride) = (i + 1 < count) ? i + 1 : TO_MPOOL_NIL;
+    ipc->u.mpool.head = 0;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+/**
+ * @brief Initialize a pool of count blocks over caller memory.
+ * @param pool T_MPOOL_POOL_SIZE(count, block_size) bytes, TO_ALIGN_SIZE aligned.
+ */
+t_status_t t_mpool_create_static(void *pool, t_uint16_t count, t_uint16_t block_size, t_uint8_t mode, t_ipc_t *ipc)
+{
+    if (!pool || !count || !block_size || !ipc) 
+        return T_NULL;
+    /* The stride is kept in 16 bits: a block_size that rounds up to 64K would wrap to 0 */
+    if (count >= TO_MPOOL_NIL || T_MPOOL_STRIDE(block_size) > 0xFFFF ||
+        ((size_t)pool & (TO_ALIGN_SIZE - 1)))
+        return T_INVALID;
+
+    _t_mpool_init(ipc, pool, count, block_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 1;
+#endif        
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_mpool_create(t_uint16_t count, t_uint16_t block_size, t_uint8_t mode, t_ipc_t **ipc_handle)
+{
+    t_ipc_t *ipc;
+
+    if (!count || !block_size) 
+        return T_NULL;
+    if (count >= TO_MPOOL_NIL || T_MPOOL_STRIDE(block_size) > 0xFFFF)
+        return T_INVALID;
+    /* One block for object and blocks, so t_ipc_delete frees both */
+    ipc = t_malloc(T_ALIGN_UP(sizeof(t_ipc_t), TO_ALIGN_SIZE) + T_MPOOL_POOL_SIZE(count, block_size));
+    if(!ipc)
+        return T_ERR;
+
+    _t_mpool_init(ipc, (t_uint8_t *)ipc + T_ALIGN_UP(sizeof(t_ipc_t), TO_ALIGN_SIZE), count, block_size, mode);
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    ipc->is_static_allocated = 0;
+#endif    
+    if(ipc_handle)
+        *ipc_handle = ipc;
+    return T_OK;    
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Adjust the free count without masking interrupts.
+ */
+t_inline void _t_mpool_count(t_ipc_t *ipc, t_int16_t delta)
+{
+    t_uint16_t count;
+
+    do
+    {
+        count = *(volatile t_uint16_t *)&ipc->msg_waiting;
+    } while (!t_atomic_cas16(&ipc->msg_waiting, count, (t_uint16_t)(count + delta)));
+}
+
+/**
+ * @brief Pop the first free block without masking interrupts.
+ * @return The block, NULL if the pool is empty.
+ * @note The tag in the high half of head changes on every pop, so a
+ *       swap prepared before another context popped and re-freed the
+ *       same block fails instead of installing a stale successor.
+ */
+static void *_t_mpool_pop(t_ipc_t *ipc)
+{
+    t_uint32_t head;
+    t_uint16_t index, next;
+    t_uint8_t *block;
+
+    do
+    {
+        head = ipc->u.mpool.head;
+        index = (t_uint16_t)head;
+        if (TO_MPOOL_NIL == index)
+            return NULL;
+        block = ipc->u.mpool.blocks + (t_uint32_t)index * ipc->u.mpool.stride;
+        next = *(volatile t_uint16_t *)block;
+    } while (!t_atomic_cas32(&ipc->u.mpool.head, head, ((head + 0x10000UL) & 0xFFFF0000UL) | next));
+
+    _t_mpool_count(ipc, -1);
+    return block;
+}
+
+/**
+ * @brief Push a block onto the free list without masking interrupts.
+ */
+static void _t_mpool_push(t_ipc_t *ipc, t_uint8_t *block)
+{
+    t_uint32_t head;
+    t_uint16_t index = (t_uint16_t)((t_uint32_t)(block - ipc->u.mpool.blocks) / ipc->u.mpool.stride);
+
+    /* Count first and uncount after a pop, so the count never underflows */
+    _t_mpool_count(ipc, 1);
+    do
+    {
+        head = ipc->u.mpool.head;
+        *(volatile t_uint16_t *)block = (t_uint16_t)head;
+    } while (!t_atomic_cas32(&ipc->u.mpool.head, head, (head & 0xFFFF0000UL) | index));
+}
+
+/**
+ * @brief Return a block and pass a free block to the first waiting allocator.
+ * @param need_schedule Set to 1 if a thread was woken.
+ * @return T_OK, T_INVALID if block does not belong to the pool.
+ * @note Allocators only queue after failing a pop under the IRQ lock, so
+ *       a waiter seen after the push has missed it and is served here.
+ */
+static t_status_t _t_mpool_release(t_ipc_t *ipc, void *block, t_uint8_t *need_schedule)
+{
+    register t_uint32_t level;
+    t_uint32_t offset = (t_uint32_t)((t_uint8_t *)block - ipc->u.mpool.blocks);
+    t_thread_t *th;
+    void *handoff;
+
+    if ((t_uint8_t *)block < ipc->u.mpool.blocks ||
+        offset >= (t_uint32_t)ipc->length * ipc->u.mpool.stride ||
+        offset % ipc->u.mpool.stride)
+        return T_INVALID;
+
+    _t_mpool_push(ipc, (t_uint8_t *)block);
+    if (t_list_isempty(&ipc->wait_list))
+        return T_OK;
+
+    level = t_irq_disable();
+    if (!t_list_isempty(&ipc->wait_list))
+    {
+        handoff = _t_mpool_pop(ipc);
+        if (handoff)
+        {
+            th = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
+            *(void **)th->ipc_data = handoff;
+            _t_ipc_wake(th, T_OK);
+            *need_schedule = 1;
+        }
+    }
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Allocate one block.
+ * @param block Receives the block.
+ * @param timeout Ticks to wait while the pool is empty (0: fail at once).
+ * @return T_OK, T_ERR on timeout, T_DELETED if the pool was deleted.
+ * @note Succeeds without masking interrupts whenever a block is free.
+ */
+t_status_t t_mpool_alloc(t_ipc_t *ipc, void **block, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_status_t ret;
+
+    if (!ipc || !block) 
         return T_NULL;
     if (0 == ipc->status) 
-        return T_DELETED;  
-    if(IPC_QUEUE != ipc->type)
+        return T_DELETED;
+    if(IPC_MPOOL != ipc->type)
         return T_INVALID;
+
+    *block = _t_mpool_pop(ipc);
+    if (*block)
+        return T_OK;
     while (1)
     {
         level = t_irq_disable();
-
         if (0 == ipc->status)
         {
             t_irq_enable(level);
             return T_DELETED;
         }
-        if (ipc->msg_waiting > 0)
+        *block = _t_mpool_pop(ipc);
+        if (*block)
         {
-            /* read one item */
-            __t_memcpy(data, ipc->u.queue.read_from, ipc->item_size);
-            ipc->u.queue.read_from += ipc->item_size;
-            if (ipc->u.queue.read_from >= ipc->u.queue.tail)
-                ipc->u.queue.read_from = ipc->u.queue.head;                
-            ipc->msg_waiting--;
-
-            /* wake one sender */
-            if (!t_list_isempty(&ipc->wait_list))
-            {
-                t_thread_t *sth = T_LIST_ENTRY(ipc->wait_list.next, t_thread_t, tlist);
-                t_list_delete(&sth->tlist);
-                sth->status = TO_THREAD_READY;
-                t_sched_insert_thread(sth);
-            }
+            _t_ipc_wait_done(armed);
             t_irq_enable(level);
-            t_sched_switch();
             return T_OK;
         }
 
-        if (0 == timeout)
-        {
-            t_irq_enable(level);
-            return T_ERR;
-        }
+        /* Empty: a freeing thread or ISR writes the block into *block */
+        ret = _t_ipc_wait(ipc, block, TO_IPC_WAIT_RECV, &timeout, &armed, level);
+        if (T_BUSY != ret)
+            return ret;
+    }
+}
 
-        /* queue empty: suspend */
-        t_ipc_suspend(&ipc->wait_list, t_current_thread, ipc->mode);
+/**
+ * @brief Interrupt variant of t_mpool_alloc(): T_ERR instead of blocking
+ *        when empty. Never masks interrupts.
+ */
+t_status_t t_mpool_alloc_isr(t_ipc_t *ipc, void **block)
+{
+    if (!ipc || !block) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_MPOOL != ipc->type)
+        return T_INVALID;
 
-        /* start timer if needed */
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            if (start_tick == 0)
-                start_tick = t_tick_get();
-            t_timer_ctrl(&t_current_thread->timer, TO_TIMER_SET_TIME, &timeout);
-            t_timer_start(&t_current_thread->timer);
-        }
+    *block = _t_mpool_pop(ipc);
+    return *block ? T_OK : T_ERR;
+}
 
-        t_irq_enable(level);
+/**
+ * @brief Return a block to its pool.
+ * @return T_OK, T_INVALID if block does not belong to the pool.
+ * @note Masks interrupts only to hand the block to a waiting allocator.
+ */
+t_status_t t_mpool_free(t_ipc_t *ipc, void *block)
+{
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!ipc || !block) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_MPOOL != ipc->type)
+        return T_INVALID;
+
+    ret = _t_mpool_release(ipc, block, &need_schedule);
+    if (need_schedule)
         t_sched_switch();
+    return ret;
+}
 
-        /* after wake: check again */
-        if (0 == ipc->status)
-            return T_DELETED;
+/**
+ * @brief Interrupt variant of t_mpool_free(), never switches.
+ * @param woken See t_queue_send_isr().
+ */
+t_status_t t_mpool_free_isr(t_ipc_t *ipc, void *block, t_uint8_t *woken)
+{
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
 
-        if (timeout > 0 && TO_WAITING_FOREVER != timeout)
-        {
-            t_uint32_t now = t_tick_get();
-            t_uint32_t elapsed = get_tick_diff(start_tick, now);
-            if (elapsed >= timeout)
-                return T_ERR;
-            timeout -= elapsed;
-            start_tick = now;
-        }
-        continue;
-    }
-      
+    if (!ipc || !block) 
+        return T_NULL;
+    if (0 == ipc->status) 
+        return T_DELETED;
+    if(IPC_MPOOL != ipc->type)
+        return T_INVALID;
+
+    ret = _t_mpool_release(ipc, block, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    return ret;
 }
 
-#endif
+/**
+ * @brief Number of free blocks (a snapshot; 0 for an invalid pool).
+ */
+t_uint16_t t_mpool_available(t_ipc_t *ipc)
+{
+    if (!ipc || 0 == ipc->status || IPC_MPOOL != ipc->type)
+        return 0;
+    return *(volatile t_uint16_t *)&ipc->msg_waiting;
+}
+#endif /* TO_USING_MPOOL */
+
 
 #endif /* TO_USING_IPC */
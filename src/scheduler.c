@@ -132,6 +132,34 @@ void t_sched_switch(void)
                          (t_uint32_t)&next_thread->psp);
 }
 
+/**
+ * @brief Check whether t_sched_switch() would switch away from the current thread.
+ * @return 1 if a ready thread should run instead of t_current_thread.
+ */
+t_uint8_t t_sched_need_switch(void)
+{
+    register t_uint32_t highest_ready_priority;
+
+    highest_ready_priority = get_highest_ready_priority(t_thread_ready_priority_group);
+    if (highest_ready_priority >= TO_THREAD_PRIORITY_MAX)
+        return 0;
+    return (t_current_thread != T_LIST_ENTRY(t_thread_ready_lists[highest_ready_priority].next,
+                                             t_thread_t,
+                                             tlist));
+}
+
+/**
+ * @brief ISR epilogue: request one context switch for all *_isr calls
+ *        made by the handler.
+ * @param woken OR of the woken flags reported by the *_isr calls.
+ * @note The switch itself runs in PendSV after the handler returns.
+ */
+void t_isr_yield(t_uint8_t woken)
+{
+    if (woken)
+        t_sched_switch();
+}
+
 /**
  * @brief Remove a thread from ready queue (and clear ready bit if empty).
  * @param thread Thread to be removed.
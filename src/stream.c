@@ -0,0 +1,498 @@
+/**
+ * @file stream.c
+ * @brief Stream buffer and message buffer for ISR-to-thread byte streams.
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author
+ *   Donzel
+ * @note
+ *   One reader and one writer per buffer. The writer only moves head and
+ *   the reader only moves tail, so data is exchanged without disabling
+ *   interrupts; the IRQ lock is taken only to block or to wake a peer.
+ */
+
+#include "ToRTOS.h"
+
+#if TO_USING_STREAM
+
+/**
+ * @brief Bytes currently buffered.
+ */
+t_inline t_uint32_t _t_stream_used(t_stream_t *sb)
+{
+    t_uint32_t head = sb->head;
+    t_uint32_t tail = sb->tail;
+
+    return (head >= tail) ? (head - tail) : (sb->size - tail + head);
+}
+
+/**
+ * @brief Bytes that can still be written (one byte always kept free).
+ */
+t_inline t_uint32_t _t_stream_free(t_stream_t *sb)
+{
+    return sb->size - 1 - _t_stream_used(sb);
+}
+
+/**
+ * @brief Copy into the ring at pos, wrapping at most once.
+ * @return Ring index following the copied bytes.
+ */
+static t_uint32_t _t_stream_copy_in(t_stream_t *sb, t_uint32_t pos, const t_uint8_t *src, t_uint32_t len)
+{
+    t_uint8_t *dst = sb->buffer + pos;
+
+    while (len--)
+    {
+        *dst++ = *src++;
+        if (++pos >= sb->size)
+        {
+            pos = 0;
+            dst = sb->buffer;
+        }
+    }
+    return pos;
+}
+
+/**
+ * @brief Copy out of the ring at pos, wrapping at most once.
+ * @return Ring index following the copied bytes.
+ */
+static t_uint32_t _t_stream_copy_out(t_stream_t *sb, t_uint32_t pos, t_uint8_t *dst, t_uint32_t len)
+{
+    const t_uint8_t *src = sb->buffer + pos;
+
+    while (len--)
+    {
+        *dst++ = *src++;
+        if (++pos >= sb->size)
+        {
+            pos = 0;
+            src = sb->buffer;
+        }
+    }
+    return pos;
+}
+
+/**
+ * @brief Ready the peer parked in slot, if any.
+ * @param slot &sb->reader or &sb->writer.
+ * @param woken NULL: switch now; else report a due switch here (ISR path).
+ * @param gone 1 if the buffer is being deleted: the peer learns it from its
+ *        TCB and must not touch the buffer again.
+ * @note Callers test *slot without the lock first, so the common
+ *       no-waiter case never touches the IRQ mask.
+ */
+static void _t_stream_wake(t_thread_t *volatile *slot, t_uint8_t *woken, t_uint8_t gone)
+{
+    register t_uint32_t level;
+    t_thread_t *th;
+    t_uint8_t need_schedule = 0;
+
+    level = t_irq_disable();
+    th = *slot;
+    if (th)
+    {
+        *slot = NULL;
+        if (gone)
+            th->stream_gone = 1;
+        /* A peer that already timed out is running its retry path; the
+           timer keeps running so a peer that must wait again keeps its deadline */
+        if (TO_THREAD_SUSPEND == th->status)
+        {
+            th->status = TO_THREAD_READY;
+            t_sched_insert_thread(th);
+            need_schedule = 1;
+        }
+    }
+    if (need_schedule && woken)
+    {
+        if (t_sched_need_switch())
+            *woken = 1;
+        need_schedule = 0;
+    }
+    t_irq_enable(level);
+    if (need_schedule)
+        t_sched_switch();
+}
+
+/**
+ * @brief Park the current thread in slot until need bytes of data
+ *        (reader) or space (writer) are available.
+ * @param sb Stream buffer.
+ * @param slot &sb->reader or &sb->writer.
+ * @param need Bytes required to proceed.
+ * @param timeout Timeout of the whole call.
+ * @param armed Caller's flag, 0 on the first attempt; see t_timeout_arm().
+ * @return T_OK to retry, else T_ERR (timeout) / T_DELETED / T_BUSY / T_UNSUPPORTED.
+ * @note The deadline runs on across retries; the caller ends it with
+ *       t_timeout_done() whatever it returns.
+ */
+static t_status_t _t_stream_wait(t_stream_t *sb, t_thread_t *volatile *slot, t_uint32_t need,
+                                 t_int32_t timeout, t_uint8_t *armed)
+{
+    register t_uint32_t level;
+    t_uint32_t have;
+
+    if (0 == timeout)
+        return T_ERR;
+    if (!t_current_thread)
+        return T_UNSUPPORTED;
+
+    level = t_irq_disable();
+
+    if (0 == sb->status)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    if (*slot && *slot != t_current_thread)
+    {
+        t_irq_enable(level);
+        return T_BUSY;
+    }
+    /* The deadline passed while we were retrying */
+    if (t_timeout_passed(*armed))
+    {
+        t_irq_enable(level);
+        return T_ERR;
+    }
+
+    /* Publish ourselves, then re-check: the peer may have moved meanwhile */
+    *slot = t_current_thread;
+    have = (slot == &sb->reader) ? _t_stream_used(sb) : _t_stream_free(sb);
+    if (have >= need)
+    {
+        *slot = NULL;
+        t_irq_enable(level);
+        return T_OK;
+    }
+
+    t_sched_remove_thread(t_current_thread);
+    t_current_thread->status = TO_THREAD_SUSPEND;
+    t_current_thread->stream_gone = 0;
+    t_timeout_arm(timeout, armed);
+
+    t_irq_enable(level);
+    t_sched_switch();
+
+    /* ---- after wake up: the retry finds out whether it was the timer ---- */
+    level = t_irq_disable();
+    /* Deleted while we slept: a dynamic buffer may be freed already */
+    if (t_current_thread->stream_gone)
+    {
+        t_irq_enable(level);
+        return T_DELETED;
+    }
+    if (*slot == t_current_thread)
+        *slot = NULL;
+    t_irq_enable(level);
+
+    if (0 == sb->status)
+        return T_DELETED;
+    return T_OK;
+}
+
+/**
+ * @brief Common field initialization.
+ */
+static void _t_stream_init(t_stream_t *sb, void *buffer, t_uint32_t size, t_uint32_t trigger, t_uint8_t mode)
+{
+    sb->buffer = (t_uint8_t *)buffer;
+    sb->size = size;
+    sb->head = 0;
+    sb->tail = 0;
+    sb->mode = mode;
+    sb->reader = NULL;
+    sb->writer = NULL;
+
+    /* Trigger level is meaningful for byte streams only */
+    if (TO_STREAM_MESSAGE == mode || 0 == trigger)
+        trigger = 1;
+    if (trigger > size - 1)
+        trigger = size - 1;
+    sb->trigger = trigger;
+
+    sb->status = 1;
+}
+
+#if (TO_USING_STATIC_ALLOCATION)
+/**
+ * @brief Initialize a stream / message buffer on caller-provided storage.
+ * @param buffer Ring storage.
+ * @param size Storage size in bytes (capacity is size - 1).
+ * @param trigger Buffered bytes that wake a blocked reader (byte mode only).
+ * @param mode TO_STREAM_BYTES or TO_STREAM_MESSAGE.
+ * @param sb Control block.
+ */
+t_status_t t_stream_create_static(void *buffer, t_uint32_t size, t_uint32_t trigger, t_uint8_t mode, t_stream_t *sb)
+{
+    if (!buffer || !sb)
+        return T_NULL;
+    if (size < 2 || (TO_STREAM_MESSAGE == mode && size <= TO_STREAM_MSG_HDR + 1))
+        return T_INVALID;
+
+    _t_stream_init(sb, buffer, size, trigger, mode);
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    sb->is_static_allocated = 1;
+#endif
+    return T_OK;
+}
+#endif /* TO_USING_STATIC_ALLOCATION */
+
+#if (TO_USING_DYNAMIC_ALLOCATION)
+t_status_t t_stream_create(t_uint32_t size, t_uint32_t trigger, t_uint8_t mode, t_stream_t **sb_handle)
+{
+    if (size < 2 || (TO_STREAM_MESSAGE == mode && size <= TO_STREAM_MSG_HDR + 1))
+        return T_INVALID;
+    t_stream_t *sb = t_malloc(sizeof(t_stream_t));
+    if (!sb)
+        return T_ERR;
+    void *buffer = t_malloc(size);
+    if (!buffer)
+    {
+        t_free(sb);
+        return T_ERR;
+    }
+
+    _t_stream_init(sb, buffer, size, trigger, mode);
+
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    sb->is_static_allocated = 0;
+#endif
+    if (sb_handle)
+        *sb_handle = sb;
+    return T_OK;
+}
+#endif /* TO_USING_DYNAMIC_ALLOCATION */
+
+/**
+ * @brief Invalidate a stream buffer and wake its reader and writer.
+ */
+t_status_t t_stream_delete(t_stream_t *sb)
+{
+    if (!sb)
+        return T_NULL;
+    if (0 == sb->status)
+        return T_OK;
+
+    sb->status = 0;
+    _t_stream_wake(&sb->reader, NULL, 1);
+    _t_stream_wake(&sb->writer, NULL, 1);
+
+#if ((1 == TO_USING_DYNAMIC_ALLOCATION) && (0 == TO_USING_STATIC_ALLOCATION))
+    t_free(sb->buffer);
+    t_free(sb);
+#endif
+#if (TO_USING_STATIC_ALLOCATION && TO_USING_DYNAMIC_ALLOCATION)
+    if (!sb->is_static_allocated)
+    {
+        t_free(sb->buffer);
+        t_free(sb);
+    }
+#endif
+    return T_OK;
+}
+
+/**
+ * @brief Common send path.
+ * @param woken NULL for thread callers, else the ISR woken flag (timeout must be 0).
+ */
+static t_status_t _t_stream_send(t_stream_t *sb, const void *data, t_uint32_t len, t_uint32_t *sent,
+                                 t_int32_t timeout, t_uint8_t *woken)
+{
+    const t_uint8_t *src = (const t_uint8_t *)data;
+    t_uint8_t armed = 0;
+    t_uint32_t done = 0;
+    t_uint32_t n;
+    t_uint32_t need;
+    t_status_t ret;
+
+    if (sent)
+        *sent = 0;
+    if (!sb || !data)
+        return T_NULL;
+    if (0 == sb->status)
+        return T_DELETED;
+    if (TO_STREAM_MESSAGE == sb->mode &&
+        (len > 0xFFFF || len + TO_STREAM_MSG_HDR > sb->size - 1))
+        return T_INVALID;
+
+    need = (TO_STREAM_MESSAGE == sb->mode) ? (len + TO_STREAM_MSG_HDR) : 1;
+    while (1)
+    {
+        if (0 == sb->status)
+        {
+            ret = T_DELETED;
+            break;
+        }
+
+        n = _t_stream_free(sb);
+        if (TO_STREAM_MESSAGE == sb->mode)
+        {
+            if (n >= need)
+            {
+                t_uint8_t hdr[TO_STREAM_MSG_HDR];
+                t_uint32_t head;
+
+                hdr[0] = (t_uint8_t)(len & 0xFF);
+                hdr[1] = (t_uint8_t)(len >> 8);
+                head = _t_stream_copy_in(sb, sb->head, hdr, TO_STREAM_MSG_HDR);
+                head = _t_stream_copy_in(sb, head, src, len);
+                T_BARRIER();
+                sb->head = head;
+                done = len;
+            }
+        }
+        else if (n)
+        {
+            if (n > len - done)
+                n = len - done;
+            t_uint32_t head = _t_stream_copy_in(sb, sb->head, src + done, n);
+            T_BARRIER();
+            sb->head = head;
+            done += n;
+        }
+
+        /* Lock-free fast path: no reader parked, nothing to do */
+        if (sb->reader && _t_stream_used(sb) >= sb->trigger)
+            _t_stream_wake(&sb->reader, woken, 0);
+
+        if (sent)
+            *sent = done;
+        if (done == len)
+        {
+            ret = T_OK;
+            break;
+        }
+
+        ret = _t_stream_wait(sb, &sb->writer, need, timeout, &armed);
+        if (T_OK != ret)
+            break;
+    }
+    t_timeout_done(armed);
+    return ret;
+}
+
+/**
+ * @brief Write bytes (byte mode) or one whole message (message mode).
+ * @param sb Stream buffer.
+ * @param data Source bytes.
+ * @param len Byte count / message length (message mode: at most 0xFFFF).
+ * @param sent Optional; receives the number of bytes written.
+ * @param timeout Ticks to wait for space.
+ * @return T_OK when everything was written, T_ERR on timeout (partial count in sent).
+ */
+t_status_t t_stream_send(t_stream_t *sb, const void *data, t_uint32_t len, t_uint32_t *sent, t_int32_t timeout)
+{
+    return _t_stream_send(sb, data, len, sent, timeout, NULL);
+}
+
+/**
+ * @brief Interrupt variant of t_stream_send(): writes what fits and
+ *        returns (T_ERR if not everything fit), never switches.
+ * @param woken Optional; set to 1 if the reader should preempt the
+ *        interrupted thread (never cleared). Pass it to t_isr_yield().
+ */
+t_status_t t_stream_send_isr(t_stream_t *sb, const void *data, t_uint32_t len, t_uint32_t *sent, t_uint8_t *woken)
+{
+    t_uint8_t dummy = 0;
+
+    return _t_stream_send(sb, data, len, sent, 0, woken ? woken : &dummy);
+}
+
+/**
+ * @brief Read buffered bytes (byte mode) or one whole message (message mode).
+ * @param sb Stream buffer.
+ * @param data Destination buffer.
+ * @param len Destination size in bytes.
+ * @param received Optional; receives the number of bytes read. In message
+ *        mode a too-small buffer leaves the message queued, returns
+ *        T_INVALID and reports the required size here.
+ * @param timeout Ticks to wait while the buffer is empty. A byte-mode
+ *        reader is woken once the trigger level is reached; on timeout
+ *        it returns whatever is buffered.
+ * @return T_OK if data was read, T_ERR on timeout with nothing read.
+ */
+t_status_t t_stream_recv(t_stream_t *sb, void *data, t_uint32_t len, t_uint32_t *received, t_int32_t timeout)
+{
+    t_uint8_t *dst = (t_uint8_t *)data;
+    t_uint8_t armed = 0;
+    t_uint32_t n;
+    t_uint32_t tail;
+    t_status_t ret;
+
+    if (received)
+        *received = 0;
+    if (!sb || !data)
+        return T_NULL;
+    if (0 == sb->status)
+        return T_DELETED;
+
+    while (1)
+    {
+        if (0 == sb->status)
+        {
+            ret = T_DELETED;
+            break;
+        }
+
+        n = _t_stream_used(sb);
+        if (n)
+        {
+            if (TO_STREAM_MESSAGE == sb->mode)
+            {
+                t_uint8_t hdr[TO_STREAM_MSG_HDR];
+
+                tail = _t_stream_copy_out(sb, sb->tail, hdr, TO_STREAM_MSG_HDR);
+                n = (t_uint32_t)hdr[0] | ((t_uint32_t)hdr[1] << 8);
+                if (n > len)
+                {
+                    if (received)
+                        *received = n;
+                    ret = T_INVALID;
+                    break;
+                }
+                tail = _t_stream_copy_out(sb, tail, dst, n);
+            }
+            else
+            {
+                if (n > len)
+                    n = len;
+                tail = _t_stream_copy_out(sb, sb->tail, dst, n);
+            }
+            T_BARRIER();
+            sb->tail = tail;
+
+            /* Lock-free fast path: no writer parked, nothing to do */
+            if (sb->writer)
+                _t_stream_wake(&sb->writer, NULL, 0);
+
+            if (received)
+                *received = n;
+            ret = T_OK;
+            break;
+        }
+
+        ret = _t_stream_wait(sb, &sb->reader, sb->trigger, timeout, &armed);
+        if (T_ERR == ret && _t_stream_used(sb))
+            continue;   /* timed out below trigger: hand out what is there */
+        if (T_OK != ret)
+            break;
+    }
+    t_timeout_done(armed);
+    return ret;
+}
+
+/**
+ * @brief Bytes currently buffered (including message length prefixes).
+ */
+t_uint32_t t_stream_available(t_stream_t *sb)
+{
+    if (!sb || 0 == sb->status)
+        return 0;
+    return _t_stream_used(sb);
+}
+
+#endif /* TO_USING_STREAM */
@@ -1,6 +1,6 @@
 /**
  * @file thread.c
- * @brief Thread management: creation, lifecycle, sleep, delete, restart.
+ * @brief Thread management: creation, lifecycle, sleep, delete, restart, notify.
  * @version 1.0.0
  * @date 2026-01-19
  * @author
@@ -45,6 +45,18 @@ static void _t_thread_create(t_thread_entry_t entry,
 
     thread->init_tick = time_slice;
     thread->remaining_tick = time_slice;
+
+#if TO_USING_NOTIFY
+    thread->notify_value = 0;
+    thread->notify_state = TO_NOTIFY_STATE_NONE;
+#endif
+#if TO_USING_IPC
+    thread->pend_on = NULL;
+#endif
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+    thread->base_priority = priority;
+    t_list_init(&thread->held_list);
+#endif
 }
 #if (TO_USING_STATIC_ALLOCATION)
 /**
@@ -226,8 +238,20 @@ t_status_t t_thread_ctrl(t_thread_t *thread, t_uint32_t cmd, void *arg)
     case TO_THREAD_SET_PRIORITY:
         if (arg)
         {
-            thread->current_priority = *(t_uint8_t *)arg;
-            thread->number_mask = 1UL << thread->current_priority;
+            register t_uint32_t level;
+            t_uint8_t priority = *(t_uint8_t *)arg;
+
+            if (priority >= TO_THREAD_PRIORITY_MAX)
+                return T_INVALID;
+            level = t_irq_disable();
+#if (TO_USING_MUTEX || TO_USING_RECURSIVE_MUTEX)
+            /* Held locks keep lending; a waiter passes the change to its owner */
+            thread->base_priority = priority;
+            t_mutex_requeue(thread);
+#else
+            t_thread_requeue(thread, priority);
+#endif
+            t_irq_enable(level);
             return T_OK;
         }
         return T_ERR;
@@ -236,6 +260,36 @@ t_status_t t_thread_ctrl(t_thread_t *thread, t_uint32_t cmd, void *arg)
     }
 }
 
+/**
+ * @brief Change a thread's effective priority and move it within the queue
+ *        it is linked in: its ready list, or a PRIO-ordered IPC wait list.
+ * @note Caller holds the IRQ lock.
+ */
+void t_thread_requeue(t_thread_t *thread, t_uint8_t priority)
+{
+    if (thread->current_priority == priority)
+        return;
+
+    if (TO_THREAD_READY == thread->status || TO_THREAD_RUNNING == thread->status)
+    {
+        t_sched_remove_thread(thread);
+        thread->current_priority = priority;
+        thread->number_mask = 1UL << priority;
+        t_sched_insert_thread(thread);
+        return;
+    }
+
+#if TO_USING_IPC
+    if (TO_THREAD_SUSPEND == thread->status && thread->pend_on)
+    {
+        t_ipc_requeue(thread, priority);
+        return;
+    }
+#endif
+    thread->current_priority = priority;
+    thread->number_mask = 1UL << priority;
+}
+
 /**
  * @brief Reclaim all TERMINATED threads (move to DELETED).
  */
@@ -328,3 +382,208 @@ void t_thread_exit(void)
         /** Infinite loop safeguard: execution should not reach here if switch succeeds. */
     }
 }
+
+#if TO_USING_NOTIFY
+/**
+ * @brief Apply a notification action (caller holds the IRQ lock, never switches).
+ * @param need_schedule Set to 1 if the thread was woken.
+ */
+static t_status_t _t_thread_notify(t_thread_t *thread, t_uint32_t value, t_uint8_t action, t_uint8_t *need_schedule)
+{
+    switch (action)
+    {
+    case TO_NOTIFY_SET_BITS:
+        thread->notify_value |= value;
+        break;
+    case TO_NOTIFY_INCREMENT:
+        thread->notify_value++;
+        break;
+    case TO_NOTIFY_OVERWRITE:
+        thread->notify_value = value;
+        break;
+    case TO_NOTIFY_NO_OVERWRITE:
+        if (TO_NOTIFY_STATE_PENDING == thread->notify_state)
+            return T_BUSY;
+        thread->notify_value = value;
+        break;
+    default:
+        return T_INVALID;
+    }
+
+    /* A waiter whose timeout already fired is ready: it sees PENDING when it runs.
+       Its timer is left running: a take that finds 0 keeps the deadline */
+    if (TO_NOTIFY_STATE_WAITING == thread->notify_state && TO_THREAD_SUSPEND == thread->status)
+    {
+        thread->status = TO_THREAD_READY;
+        t_sched_insert_thread(thread);
+        *need_schedule = 1;
+    }
+    thread->notify_state = TO_NOTIFY_STATE_PENDING;
+    return T_OK;
+}
+
+/**
+ * @brief Update a thread's notification value and wake it if it waits.
+ * @param thread Target thread.
+ * @param value Argument of the action.
+ * @param action TO_NOTIFY_SET_BITS / INCREMENT / OVERWRITE / NO_OVERWRITE.
+ * @return T_OK, T_BUSY if NO_OVERWRITE found a pending value.
+ * @note Never blocks; from interrupts prefer t_thread_notify_isr().
+ */
+t_status_t t_thread_notify(t_thread_t *thread, t_uint32_t value, t_uint8_t action)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!thread)
+        return T_NULL;
+
+    level = t_irq_disable();
+    ret = _t_thread_notify(thread, value, action, &need_schedule);
+    t_irq_enable(level);
+
+    if (need_schedule)
+        t_sched_switch();
+    return ret;
+}
+
+/**
+ * @brief Interrupt variant of t_thread_notify(): defers the switch.
+ * @param woken Optional; set to 1 if the notified thread should preempt
+ *        the interrupted one (never cleared). Pass it to t_isr_yield().
+ */
+t_status_t t_thread_notify_isr(t_thread_t *thread, t_uint32_t value, t_uint8_t action, t_uint8_t *woken)
+{
+    register t_uint32_t level;
+    t_uint8_t need_schedule = 0;
+    t_status_t ret;
+
+    if (!thread)
+        return T_NULL;
+
+    level = t_irq_disable();
+    ret = _t_thread_notify(thread, value, action, &need_schedule);
+    if (need_schedule && woken && t_sched_need_switch())
+        *woken = 1;
+    t_irq_enable(level);
+    return ret;
+}
+
+/**
+ * @brief Block the current thread until notified (caller holds the IRQ lock).
+ * @param armed Caller's deadline flag, see t_timeout_arm(); the caller
+ *        ends it with t_timeout_done().
+ * @return T_OK if notified, T_ERR on timeout.
+ */
+static t_status_t _t_thread_notify_block(t_int32_t timeout, t_uint8_t *armed, t_uint32_t level)
+{
+    t_current_thread->notify_state = TO_NOTIFY_STATE_WAITING;
+    t_sched_remove_thread(t_current_thread);
+    t_current_thread->status = TO_THREAD_SUSPEND;
+    t_timeout_arm(timeout, armed);
+
+    t_irq_enable(level);
+    t_sched_switch();
+
+    /* ---- after wake up: the notifier marks PENDING, a timeout does not ---- */
+    if (TO_NOTIFY_STATE_PENDING == t_current_thread->notify_state)
+        return T_OK;
+    t_current_thread->notify_state = TO_NOTIFY_STATE_NONE;
+    return T_ERR;
+}
+
+/**
+ * @brief Wait for a notification on the current thread.
+ * @param clear_on_entry Bits cleared before waiting if nothing is pending.
+ * @param clear_on_exit Bits cleared after a notification is consumed.
+ * @param value Optional; receives the value before clear_on_exit.
+ * @param timeout Ticks to wait (0: poll).
+ * @return T_OK, T_ERR on timeout.
+ */
+t_status_t t_thread_notify_wait(t_uint32_t clear_on_entry, t_uint32_t clear_on_exit, t_uint32_t *value, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+
+    if (!t_current_thread)
+        return T_UNSUPPORTED;
+
+    level = t_irq_disable();
+
+    if (TO_NOTIFY_STATE_PENDING != t_current_thread->notify_state)
+    {
+        t_current_thread->notify_value &= ~clear_on_entry;
+        if (0 == timeout)
+        {
+            t_irq_enable(level);
+            return T_ERR;
+        }
+        if (T_OK != _t_thread_notify_block(timeout, &armed, level))
+            return T_ERR;
+        t_timeout_done(armed);
+        level = t_irq_disable();
+    }
+
+    if (value)
+        *value = t_current_thread->notify_value;
+    t_current_thread->notify_value &= ~clear_on_exit;
+    t_current_thread->notify_state = TO_NOTIFY_STATE_NONE;
+
+    t_irq_enable(level);
+    return T_OK;
+}
+
+/**
+ * @brief Use the notification value as a counting (clear=0) or binary
+ *        (clear=1) semaphore.
+ * @param clear 0: decrement on return, else reset to 0.
+ * @param value Optional; receives the value before it was taken.
+ * @param timeout Ticks to wait while the value is 0 (0: poll).
+ * @return T_OK, T_ERR on timeout.
+ */
+t_status_t t_thread_notify_take(t_uint8_t clear, t_uint32_t *value, t_int32_t timeout)
+{
+    register t_uint32_t level;
+    t_uint8_t armed = 0;
+    t_status_t ret;
+
+    if (!t_current_thread)
+        return T_UNSUPPORTED;
+
+    while (1)
+    {
+        level = t_irq_disable();
+
+        if (t_current_thread->notify_value)
+        {
+            if (value)
+                *value = t_current_thread->notify_value;
+            if (clear)
+                t_current_thread->notify_value = 0;
+            else
+                t_current_thread->notify_value--;
+            t_current_thread->notify_state = TO_NOTIFY_STATE_NONE;
+            t_irq_enable(level);
+            ret = T_OK;
+            break;
+        }
+
+        /* A notify that left the value at 0 does not count; once the
+           deadline has passed the look above was the last one */
+        t_current_thread->notify_state = TO_NOTIFY_STATE_NONE;
+        if (0 == timeout || t_timeout_passed(armed))
+        {
+            t_irq_enable(level);
+            ret = T_ERR;
+            break;
+        }
+
+        ret = _t_thread_notify_block(timeout, &armed, level);
+        if (T_OK != ret)
+            break;
+    }
+    t_timeout_done(armed);
+    return ret;
+}
+#endif /* TO_USING_NOTIFY */
@@ -298,8 +298,54 @@ void timeout_function(void *p)
     if (!thread)
         return;
 
-    t_list_delete(&thread->tlist);    
+    /* Already woken to retry an IPC call: keep its wake reason, the retry
+       sees the timer gone and gives up if it still cannot complete */
+    if (TO_THREAD_SUSPEND != thread->status)
+        return;
+#if TO_USING_IPC
+    thread->ipc_status = T_TIMEOUT;
+    t_ipc_unlink(thread);
+#else
+    t_list_delete(&thread->tlist);
+#endif
     thread->status = TO_THREAD_READY;
     t_sched_insert_thread(thread);    
     t_sched_switch();
 }
+
+/**
+ * @brief Start the current thread's timeout for a blocking call, once per
+ *        call: a call that blocks again after a retry keeps its deadline.
+ * @param timeout Timeout of the whole call (TO_WAITING_FOREVER: no timer).
+ * @param armed Caller's flag, 0 on the first attempt; set once the timer runs.
+ * @note Caller holds the IRQ lock and has just suspended the thread.
+ */
+void t_timeout_arm(t_int32_t timeout, t_uint8_t *armed)
+{
+    /* TO_WAITING_FOREVER is -1 as a t_int32_t */
+    if (*armed || timeout <= 0)
+        return;
+    t_timer_ctrl(&t_current_thread->timer, TO_TIMER_SET_TIME, &timeout);
+    t_timer_start(&t_current_thread->timer);
+    *armed = 1;
+}
+
+/**
+ * @brief Whether the deadline armed by t_timeout_arm() has passed.
+ * @note An expired timer has unlinked itself; wakers leave a running one
+ *       alone, so this holds however the thread was woken.
+ */
+t_uint8_t t_timeout_passed(t_uint8_t armed)
+{
+    return armed && t_list_isempty(&t_current_thread->timer.row[0]);
+}
+
+/**
+ * @brief Cancel the deadline of a call that returns: a timer left running
+ *        would fire on whatever the thread waits for next.
+ */
+void t_timeout_done(t_uint8_t armed)
+{
+    if (armed)
+        t_timer_stop(&t_current_thread->timer);
+}
@@ -0,0 +1,41 @@
+#ifndef __TORTOS_HOST_CONFIG_H_
+#define __TORTOS_HOST_CONFIG_H_
+
+/* Host test configuration: the board configuration plus the overrides the
+ * Makefile selects per build variant. */
+#include "../../bsp/stm32/stm32f411ce/Core/Inc/ToRTOS_Config.h"
+
+#ifdef HOST_IPC_PRIO_BITMAP
+#undef TO_USING_IPC_PRIO_BITMAP
+#define TO_USING_IPC_PRIO_BITMAP    1
+#endif
+
+#ifdef HOST_LOWER_PRIORITY_NUM_HIGHER
+#undef TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY
+#define TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY   1
+#endif
+
+#ifdef HOST_IPC_LOCKED
+#undef TO_USING_IPC_FAST_PATH
+#define TO_USING_IPC_FAST_PATH      0
+#endif
+
+#ifdef HOST_QUEUE_STAMP
+#undef TO_USING_QUEUE_STAMP
+#define TO_USING_QUEUE_STAMP        1
+#endif
+
+/* A successful compare-and-swap is where a lock-free path can be preempted
+ * between its steps; port_cas_hook lets a test run other threads there. */
+extern void (*port_cas_hook)(volatile void *addr);
+#define __atomic_compare_exchange_n(addr, expected, desired, weak, ok, fail)   \
+    __extension__({                                                            \
+        __typeof__(*(expected)) _port_want = (desired);                        \
+        _Bool _port_ok = __atomic_compare_exchange((addr), (expected),         \
+                                                   &_port_want, weak, ok, fail); \
+        if (_port_ok && port_cas_hook)                                         \
+            port_cas_hook(addr);                                               \
+        _port_ok;                                                              \
+    })
+
+#endif /* __TORTOS_HOST_CONFIG_H_ */
@@ -0,0 +1,130 @@
+/**
+ * @file bench_bufpool.c
+ * @brief Moving a frame from a producer to a consumer: a bufpool buffer
+ *        passed by pointer (t_buf_alloc, t_buf_send, t_buf_recv, t_buf_free)
+ *        against a t_malloc'd frame copied through a queue of FRAME-byte
+ *        items (t_malloc, t_queue_send, t_free, then t_queue_recv into a
+ *        second t_malloc'd buffer). Frames carry 16 to FRAME bytes of
+ *        payload. Reports the time per frame, the bytes the kernel copies
+ *        per frame, the heap calls per frame and how far
+ *        t_get_free_mem_size swings over the run.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures. Linked against
+ *       mem_mang/mem2.c so the heap figures are the target's TLSF pool.
+ */
+
+#include "port.h"
+#include <string.h>
+
+#define ROUNDS  20000
+#define DEPTH   8
+#define FRAME   256
+
+static t_thread_t A;
+static t_uint32_t seed = 12345;
+static size_t heap_min, heap_max;
+
+static t_uint32_t frame_len(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return 16 + (seed >> 16) % (FRAME - 15);
+}
+
+static void heap_sample(void)
+{
+    size_t f = t_get_free_mem_size();
+
+    if (f < heap_min)
+        heap_min = f;
+    if (f > heap_max)
+        heap_max = f;
+}
+
+static void report(const char *name, double ns, int copied, int heap_calls, size_t start)
+{
+    printf("%-18s %6.1f ns/frame  %3d bytes copied  %d heap calls  heap free %zu..%zu (drift %ld)\n",
+           name, ns, copied, heap_calls, heap_min, heap_max,
+           (long)t_get_free_mem_size() - (long)start);
+}
+
+static void bufpool(void)
+{
+    static t_uint32_t pool[T_BUFPOOL_POOL_SIZE(DEPTH, FRAME) / 4];
+    static t_uint32_t qpool[DEPTH * 2];
+    t_ipc_t bp, q;
+    t_buf_t *b;
+    t_uint16_t min_free;
+    t_uint32_t i;
+    size_t start;
+    double t0;
+    int r;
+
+    t_bufpool_create_static(pool, DEPTH, FRAME, TO_IPC_FLAG_FIFO, &bp);
+    t_queue_create_static(qpool, DEPTH, sizeof(t_buf_t *), TO_IPC_FLAG_FIFO, &q);
+    start = heap_min = heap_max = t_get_free_mem_size();
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+    {
+        for (i = 0; i < DEPTH; i++)
+        {
+            t_buf_alloc(&bp, &b, 0);
+            b->len = frame_len();
+            memset(T_BUF_DATA(b), (int)i, b->len);
+            heap_sample();
+            t_buf_send(&q, b, 0);
+        }
+        for (i = 0; i < DEPTH; i++)
+        {
+            t_buf_recv(&q, &b, 0);
+            t_buf_free(b);
+        }
+    }
+    report("bufpool, pointer", (port_ns() - t0) / ((double)ROUNDS * DEPTH), 0, 0, start);
+    t_bufpool_stats(&bp, NULL, &min_free, NULL);
+    printf("%-18s pool low-water %u of %u buffers free\n", "", min_free, DEPTH);
+}
+
+static void malloc_copy(void)
+{
+    static t_uint8_t qpool[DEPTH * FRAME];
+    t_ipc_t q;
+    t_uint8_t *f;
+    t_uint32_t i;
+    size_t start;
+    double t0;
+    int r;
+
+    t_queue_create_static(qpool, DEPTH, FRAME, TO_IPC_FLAG_FIFO, &q);
+    start = heap_min = heap_max = t_get_free_mem_size();
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+    {
+        for (i = 0; i < DEPTH; i++)
+        {
+            /* The queue copies a whole item, so the frame is FRAME bytes */
+            f = t_malloc(FRAME);
+            memset(f, (int)i, frame_len());
+            heap_sample();
+            t_queue_send(&q, f, 0);
+            t_free(f);
+        }
+        for (i = 0; i < DEPTH; i++)
+        {
+            f = t_malloc(FRAME);
+            t_queue_recv(&q, f, 0);
+            t_free(f);
+        }
+    }
+    report("malloc + copy", (port_ns() - t0) / ((double)ROUNDS * DEPTH), 2 * FRAME, 4, start);
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+
+    bufpool();
+    malloc_copy();
+    return 0;
+}
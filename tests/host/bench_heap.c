@@ -0,0 +1,77 @@
+/**
+ * @file bench_heap.c
+ * @brief Replays one pseudo-random alloc/free trace against the heap
+ *        backend linked in (mem_mang/mem0.c, mem1.c or mem2.c), reporting
+ *        the mean and the 99.9th percentile cost of t_malloc and t_free.
+ * @note The Makefile builds one binary per backend. The percentile stands
+ *       in for the worst case, which on a host is host scheduling noise;
+ *       on the target use the DWT cycle counter.
+ */
+
+#include "port.h"
+#include <stdlib.h>
+
+#define SLOTS   32
+#define OPS     200000
+
+static float alloc_ns[OPS], free_ns[OPS];
+
+static int cmp(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Mean and 99.9th percentile of n samples (sorts them) */
+static void summary(float *v, unsigned long n, double *mean, double *p999)
+{
+    double sum = 0;
+    unsigned long i;
+
+    for (i = 0; i < n; i++)
+        sum += v[i];
+    qsort(v, n, sizeof(v[0]), cmp);
+    *mean = sum / n;
+    *p999 = v[n - 1 - n / 1000];
+}
+
+int main(void)
+{
+    static void *live[SLOTS];
+    t_uint32_t seed = 12345;
+    unsigned long allocs = 0, frees = 0, fails = 0;
+    double t0, a_mean, a_p, f_mean, f_p;
+    int i, k;
+
+    port_init();
+    for (i = 0; i < OPS; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        k = (seed >> 16) % SLOTS;
+        if (live[k])
+        {
+            t0 = port_ns();
+            t_free(live[k]);
+            free_ns[frees++] = port_ns() - t0;
+            live[k] = NULL;
+        }
+        else
+        {
+            /* mostly small messages, now and then a frame-sized buffer */
+            size_t size = (seed & 0x7) ? 8 + ((seed >> 8) & 0x7F) : 256 + ((seed >> 8) & 0xFF);
+
+            t0 = port_ns();
+            live[k] = t_malloc(size);
+            alloc_ns[allocs++] = port_ns() - t0;
+            if (!live[k])
+                fails++;
+        }
+    }
+
+    summary(alloc_ns, allocs, &a_mean, &a_p);
+    summary(free_ns, frees, &f_mean, &f_p);
+    printf("%s: alloc %.1f ns mean, %.1f ns p99.9; free %.1f ns mean, %.1f ns p99.9; "
+           "%lu of %lu allocs failed\n", HEAP_NAME, a_mean, a_p, f_mean, f_p, fails, allocs);
+    return 0;
+}
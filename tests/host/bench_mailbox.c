@@ -0,0 +1,49 @@
+/**
+ * @file bench_mailbox.c
+ * @brief Messages per second through a mailbox against a queue of
+ *        4-byte items, each as a post/fetch (send/recv) pair.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures.
+ */
+
+#include "port.h"
+
+#define ROUNDS  1000000
+#define LENGTH  8
+
+static t_thread_t A;
+
+int main(void)
+{
+    static t_uint32_t mb_pool[LENGTH], q_pool[LENGTH];
+    t_ipc_t mb, q;
+    t_uint32_t v = 0;
+    double t0, m, s;
+    int r;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+    t_mailbox_create_static(mb_pool, LENGTH, TO_IPC_FLAG_FIFO, &mb);
+    t_queue_create_static(q_pool, LENGTH, sizeof(t_uint32_t), TO_IPC_FLAG_FIFO, &q);
+
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+    {
+        t_mailbox_post(&mb, (t_uint32_t)r, 0);
+        t_mailbox_fetch(&mb, &v, 0);
+    }
+    m = ROUNDS * 1e9 / (port_ns() - t0);
+
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+    {
+        v = (t_uint32_t)r;
+        t_queue_send(&q, &v, 0);
+        t_queue_recv(&q, &v, 0);
+    }
+    s = ROUNDS * 1e9 / (port_ns() - t0);
+
+    printf("mailbox %.1f Mmsg/s   4-byte queue %.1f Mmsg/s   %.2fx\n", m / 1e6, s / 1e6, m / s);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file bench_mpool.c
+ * @brief Fixed-block pool against the mem1.c byte pool (t_malloc is
+ *        t_byte_pool_alloc on the default pool): an alloc/free cycle on
+ *        an idle pool, and one alloc after the byte pool was cut into
+ *        free fragments it has to walk past (its worst-case path; the
+ *        mpool has no such path). Single-op times have the cost of
+ *        reading the clock taken out.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures.
+ */
+
+#include "port.h"
+
+#define ROUNDS  200000
+#define REPEAT  2000
+#define HELD    128
+
+static t_thread_t A;
+static t_ipc_t mp;
+static t_uint32_t mp_mem[T_MPOOL_POOL_SIZE(HELD + 1, 64) / 4];
+static double clock_ns;
+
+static void bench_cycle(void)
+{
+    double t0, m, b;
+    void *p;
+    int r;
+
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+    {
+        t_mpool_alloc(&mp, &p, 0);
+        t_mpool_free(&mp, p);
+    }
+    m = (port_ns() - t0) / ROUNDS;
+
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+        t_free(t_malloc(32));
+    b = (port_ns() - t0) / ROUNDS;
+
+    printf("alloc+free cycle     mpool %6.1f ns   byte pool %6.1f ns\n", m, b);
+}
+
+/* Hold HELD small blocks, release every other one from the first
+   2 * frags, then time the first request none of the holes can serve */
+static void bench_fragmented(int frags)
+{
+    static void *held[HELD];
+    double t0, m_sum = 0, b_sum = 0;
+    void *p;
+    int r, i;
+
+    for (r = 0; r < REPEAT; r++)
+    {
+        for (i = 0; i < HELD; i++)
+            held[i] = t_malloc(24);
+        for (i = 0; i < 2 * frags; i += 2)
+        {
+            t_free(held[i]);
+            held[i] = NULL;
+        }
+        t0 = port_ns();
+        p = t_malloc(64);
+        b_sum += port_ns() - t0;
+        t_free(p);
+        for (i = 0; i < HELD; i++)
+            if (held[i])
+                t_free(held[i]);
+
+        for (i = 0; i < HELD; i++)
+            t_mpool_alloc(&mp, &held[i], 0);
+        t0 = port_ns();
+        t_mpool_alloc(&mp, &p, 0);
+        m_sum += port_ns() - t0;
+        t_mpool_free(&mp, p);
+        for (i = 0; i < HELD; i++)
+            t_mpool_free(&mp, held[i]);
+    }
+    printf("alloc, %3d fragments  mpool %6.1f ns   byte pool %6.1f ns\n",
+           frags, m_sum / REPEAT - clock_ns, b_sum / REPEAT - clock_ns);
+}
+
+int main(void)
+{
+    double t0;
+    int r;
+
+    for (t0 = port_ns(), r = 0; r < ROUNDS; r++)
+        port_ns();
+    clock_ns = (port_ns() - t0) / ROUNDS;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+    t_mpool_create_static(mp_mem, HELD + 1, 64, TO_IPC_FLAG_FIFO, &mp);
+
+    bench_cycle();
+    bench_fragmented(0);
+    bench_fragmented(16);
+    bench_fragmented(64);
+        return 0;
+}
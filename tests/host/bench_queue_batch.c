@@ -0,0 +1,62 @@
+/**
+ * @file bench_queue_batch.c
+ * @brief Items per second moved through a queue one call per item
+ *        against t_queue_send_n/t_queue_recv_n for the same batch.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures.
+ */
+
+#include "port.h"
+
+#define ITEMS   640000  /* items moved per row, whatever the batch */
+#define LENGTH  32
+
+static t_thread_t A;
+
+static double items_per_sec(t_uint16_t batch, int use_n)
+{
+    static t_uint32_t pool[LENGTH];
+    static t_uint32_t in[LENGTH], out[LENGTH];
+    t_uint16_t n, i;
+    double t0;
+    t_ipc_t q;
+    int r;
+
+    t_queue_create_static(pool, LENGTH, sizeof(t_uint32_t), TO_IPC_FLAG_FIFO, &q);
+    t0 = port_ns();
+    for (r = 0; r < ITEMS / batch; r++)
+    {
+        if (use_n)
+        {
+            t_queue_send_n(&q, in, batch, &n, 0);
+            t_queue_recv_n(&q, out, batch, 0, &n, 0);
+        }
+        else
+        {
+            for (i = 0; i < batch; i++)
+                t_queue_send(&q, &in[i], 0);
+            for (i = 0; i < batch; i++)
+                t_queue_recv(&q, &out[i], 0);
+        }
+    }
+    return (double)ITEMS * 1e9 / (port_ns() - t0);
+}
+
+int main(void)
+{
+    static const t_uint16_t batches[] = {1, 4, 8, 16, 32};
+    unsigned i;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+
+    printf("batch  single(Mitem/s)  send_n/recv_n(Mitem/s)  speedup\n");
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++)
+    {
+        double s = items_per_sec(batches[i], 0);
+        double b = items_per_sec(batches[i], 1);
+        printf("%5u  %15.1f  %22.1f  %6.2fx\n", batches[i], s / 1e6, b / 1e6, b / s);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file bench_queue_copy.c
+ * @brief Send/receive cost per item with the word kernels against the
+ *        byte loop. An odd pool address forces the byte loop for the same
+ *        item size, so both columns run the same queue code.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures.
+ */
+
+#include "port.h"
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 200000
+#define LENGTH 8
+
+static t_thread_t A;
+
+static double ns_per_item(int pool_off, t_uint16_t size)
+{
+    static t_uint32_t pool_mem[(128 * LENGTH) / 4 + 2];
+    static t_uint32_t in[32], out[32];
+    struct timespec t0, t1;
+    t_ipc_t q;
+    int r;
+
+    t_queue_create_static((t_uint8_t *)pool_mem + pool_off, LENGTH, size, TO_IPC_FLAG_FIFO, &q);
+    memset(in, 0x5A, sizeof(in));
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (r = 0; r < ROUNDS; r++)
+    {
+        t_queue_send(&q, in, 0);
+        t_queue_recv(&q, out, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ROUNDS;
+}
+
+int main(void)
+{
+    static const t_uint16_t sizes[] = {4, 8, 12, 16, 32, 64, 128};
+    unsigned i;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+
+    printf("item  word(ns)  byte(ns)  speedup\n");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        double w = ns_per_item(0, sizes[i]);
+        double b = ns_per_item(1, sizes[i]);
+        printf("%4u  %8.1f  %8.1f  %6.2fx\n", sizes[i], w, b, b / w);
+    }
+    return 0;
+}
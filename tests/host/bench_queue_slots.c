@@ -0,0 +1,70 @@
+/**
+ * @file bench_queue_slots.c
+ * @brief Cost per item of filling and consuming an item in place through
+ *        t_queue_reserve/commit and t_queue_peek/release, against building
+ *        it in a local buffer and passing it through t_queue_send/recv.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures.
+ */
+
+#include "port.h"
+#include <string.h>
+
+#define ROUNDS  200000
+#define LENGTH  8
+
+static t_thread_t A;
+static volatile t_uint32_t sink;
+
+static double ns_per_item(t_uint16_t size, int in_place)
+{
+    static t_uint32_t pool_mem[(512 * LENGTH) / 4];
+    static t_uint32_t buf[512 / 4];
+    void *slot;
+    double t0;
+    t_ipc_t q;
+    int r;
+
+    t_queue_create_static(pool_mem, LENGTH, size, TO_IPC_FLAG_FIFO, &q);
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS; r++)
+    {
+        /* the producer builds the item, the consumer reads one word of it */
+        if (in_place)
+        {
+            t_queue_reserve(&q, &slot, 0);
+            memset(slot, r, size);
+            t_queue_commit(&q, slot);
+            t_queue_peek(&q, &slot, 0);
+            sink = *(t_uint32_t *)slot;
+            t_queue_release(&q, slot);
+        }
+        else
+        {
+            memset(buf, r, size);
+            t_queue_send(&q, buf, 0);
+            t_queue_recv(&q, buf, 0);
+            sink = buf[0];
+        }
+    }
+    return (port_ns() - t0) / ROUNDS;
+}
+
+int main(void)
+{
+    static const t_uint16_t sizes[] = {4, 16, 64, 256, 512};
+    unsigned i;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+
+    printf("item  send/recv(ns)  reserve/peek(ns)  speedup\n");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        double c = ns_per_item(sizes[i], 0);
+        double z = ns_per_item(sizes[i], 1);
+        printf("%4u  %13.1f  %16.1f  %6.2fx\n", sizes[i], c, z, c / z);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file bench_rwlock.c
+ * @brief Read-heavy rwlock: cost per read lock/unlock pair as more readers
+ *        hold the lock at once, against a mutex guarding the same reads,
+ *        plus a mix with one write per WRITE_EVERY reads.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures. "held" is how
+ *       many of the readers were inside together: the rwlock admits all
+ *       of them, the mutex turns every reader after the first away.
+ */
+
+#include "port.h"
+
+#define ROUNDS       1000000
+#define MAX_READERS  16
+#define WRITE_EVERY  100
+
+static t_thread_t T[MAX_READERS];
+
+/* Every reader takes the lock, then every reader drops it */
+static double overlap(t_ipc_t *rw, int k, int *held)
+{
+    double t0;
+    int r, i;
+
+    *held = 0;
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS / k; r++)
+    {
+        for (i = 0; i < k; i++)
+        {
+            port_run(&T[i]);
+            if (T_OK == t_rwlock_read_lock(rw, 0) && 0 == r)
+                (*held)++;
+        }
+        for (i = 0; i < k; i++)
+        {
+            port_run(&T[i]);
+            t_rwlock_read_unlock(rw);
+        }
+    }
+    return (port_ns() - t0) / (ROUNDS / k * k);
+}
+
+/* The same readers behind a mutex: only one gets in at a time */
+static double serial(t_ipc_t *m, int k, int *held)
+{
+    double t0;
+    int r, i;
+
+    /* How many of k readers a mutex lets in together */
+    for (*held = 0, i = 0; i < k; i++)
+    {
+        port_run(&T[i]);
+        if (T_OK == t_mutex_recv_base(m, 0))
+            (*held)++;
+    }
+    for (i = 0; i < k; i++)
+    {
+        port_run(&T[i]);
+        t_mutex_send_base(m);
+    }
+
+    t0 = port_ns();
+    for (r = 0; r < ROUNDS / k; r++)
+    {
+        for (i = 0; i < k; i++)
+        {
+            port_run(&T[i]);
+            if (T_OK == t_mutex_recv_base(m, 0))
+                t_mutex_send_base(m);
+        }
+    }
+    return (port_ns() - t0) / (ROUNDS / k * k);
+}
+
+int main(void)
+{
+    static const int readers[] = { 1, 2, 4, 8, 16 };
+    t_ipc_t rw, m;
+    double t0, rns, mns;
+    int i, k, rh, mh;
+
+    port_init();
+    for (i = 0; i < MAX_READERS; i++)
+        port_thread(&T[i], 5);
+    t_rwlock_create_static(TO_IPC_FLAG_PRIO, &rw);
+    T_MUTEX_CREATE_STATIC(TO_IPC_FLAG_PRIO, &m);
+
+    printf("readers   rwlock ns/read  held   Mreads/s   mutex ns/read  held\n");
+    for (k = 0; k < (int)(sizeof(readers) / sizeof(readers[0])); k++)
+    {
+        rns = overlap(&rw, readers[k], &rh);
+        mns = serial(&m, readers[k], &mh);
+        printf("%7d   %14.1f  %4d   %8.1f   %13.1f  %4d\n",
+               readers[k], rns, rh, 1e3 / rns, mns, mh);
+    }
+
+    /* Read-heavy mix: the write only gets in once every reader is out */
+    t0 = port_ns();
+    for (i = 0; i < ROUNDS; i++)
+    {
+        port_run(&T[i % MAX_READERS]);
+        if (0 == i % WRITE_EVERY)
+        {
+            t_rwlock_write_lock(&rw, 0);
+            t_rwlock_write_unlock(&rw);
+        }
+        t_rwlock_read_lock(&rw, 0);
+        t_rwlock_read_unlock(&rw);
+    }
+    rns = (port_ns() - t0) / ROUNDS;
+    printf("1 write per %d reads: %.1f ns/read\n", WRITE_EVERY, rns);
+    return 0;
+}
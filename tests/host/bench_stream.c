@@ -0,0 +1,95 @@
+/**
+ * @file bench_stream.c
+ * @brief Bytes per second from an "ISR" producer to a reader thread, and
+ *        the time spent in the ISR per byte: t_stream_send_isr in byte
+ *        mode (one byte per call as from a UART RX interrupt, and CHUNK
+ *        bytes per call as from a FIFO or DMA half-transfer) and in
+ *        message mode (one CHUNK-byte frame per call), against one
+ *        t_queue_send_isr per byte on a queue of 1-byte items.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures. Each round the
+ *       producer writes BURST bytes, then the reader drains them.
+ */
+
+#include "port.h"
+
+#define ROUNDS  20000
+#define BURST   256
+#define CHUNK   16
+
+static t_thread_t R;
+static t_uint8_t src[BURST], dst[BURST];
+
+static void report(const char *name, double isr, double total)
+{
+    double bytes = (double)ROUNDS * BURST;
+
+    printf("%-22s %7.1f MB/s   ISR %5.2f ns/byte\n", name,
+           bytes * 1e3 / total, isr / bytes);
+}
+
+/* step: bytes per ISR call */
+static void stream(const char *name, t_uint8_t mode, t_uint32_t step)
+{
+    static t_uint8_t pool[2 * BURST];
+    t_stream_t sb;
+    t_uint32_t i, n;
+    t_uint8_t woken = 0;
+    double t0, t1, isr = 0, total = 0;
+    int r;
+
+    t_stream_create_static(pool, sizeof(pool), 1, mode, &sb);
+    for (r = 0; r < ROUNDS; r++)
+    {
+        t0 = port_ns();
+        for (i = 0; i < BURST; i += step)
+            t_stream_send_isr(&sb, src + i, step, &n, &woken);
+        t1 = port_ns();
+        while (T_OK == t_stream_recv(&sb, dst, sizeof(dst), &n, 0))
+            ;
+        isr += t1 - t0;
+        total += port_ns() - t0;
+    }
+    report(name, isr, total);
+}
+
+static void queue(void)
+{
+    static t_uint8_t pool[BURST];
+    t_ipc_t q;
+    t_uint32_t i;
+    t_uint8_t woken = 0;
+    double t0, t1, isr = 0, total = 0;
+    int r;
+
+    t_queue_create_static(pool, BURST, 1, TO_IPC_FLAG_FIFO, &q);
+    for (r = 0; r < ROUNDS; r++)
+    {
+        t0 = port_ns();
+        for (i = 0; i < BURST; i++)
+            t_queue_send_isr(&q, &src[i], &woken);
+        t1 = port_ns();
+        for (i = 0; i < BURST; i++)
+            t_queue_recv(&q, &dst[i], 0);
+        isr += t1 - t0;
+        total += port_ns() - t0;
+    }
+    report("queue, 1 byte/call", isr, total);
+}
+
+int main(void)
+{
+    int i;
+
+    port_init();
+    port_thread(&R, 3);
+    port_run(&R);
+    for (i = 0; i < BURST; i++)
+        src[i] = (t_uint8_t)i;
+
+    stream("stream, 1 byte/call", TO_STREAM_BYTES, 1);
+    stream("stream, 16 bytes/call", TO_STREAM_BYTES, CHUNK);
+    stream("msgbuf, 16-byte frame", TO_STREAM_MESSAGE, CHUNK);
+    queue();
+    return 0;
+}
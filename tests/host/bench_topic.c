@@ -0,0 +1,65 @@
+/**
+ * @file bench_topic.c
+ * @brief Fan-out of one sample to N readers: a topic publish plus N
+ *        t_topic_read against N t_queue_send into per-reader queues plus
+ *        N t_queue_recv. Publisher cost is reported on its own as well.
+ * @note Host numbers only show the relative gap; measure on the target
+ *       with the DWT cycle counter for absolute figures.
+ */
+
+#include "port.h"
+
+#define ROUNDS  100000
+#define READERS 8
+#define SAMPLE  32
+
+static t_thread_t A;
+
+int main(void)
+{
+    static t_uint32_t sample_buf[SAMPLE / 4];
+    static t_uint32_t q_pool[READERS][SAMPLE / 4];
+    static t_uint8_t in[SAMPLE], out[SAMPLE];
+    static t_topic_sub_t sub[READERS];
+    static t_ipc_t q[READERS];
+    t_ipc_t topic;
+    double t0, tp, tr, qp, qr;
+    int r, i, n;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+    t_topic_create_static(sample_buf, SAMPLE, &topic);
+    for (i = 0; i < READERS; i++)
+    {
+        t_topic_subscribe(&topic, &sub[i]);
+        t_queue_create_static(q_pool[i], 1, SAMPLE, TO_IPC_FLAG_FIFO, &q[i]);
+    }
+
+    printf("readers  publish(ns)  N x send(ns)   publish+reads(ns)  sends+recvs(ns)\n");
+    for (n = 1; n <= READERS; n *= 2)
+    {
+        tp = tr = qp = qr = 0;
+        for (r = 0; r < ROUNDS; r++)
+        {
+            in[0] = (t_uint8_t)r;
+            t0 = port_ns();
+            t_topic_publish(&topic, in);
+            tp += port_ns() - t0;
+            for (i = 0; i < n; i++)
+                t_topic_read(&sub[i], out, 0);
+            tr += port_ns() - t0;
+
+            t0 = port_ns();
+            for (i = 0; i < n; i++)
+                t_queue_send(&q[i], in, 0);
+            qp += port_ns() - t0;
+            for (i = 0; i < n; i++)
+                t_queue_recv(&q[i], out, 0);
+            qr += port_ns() - t0;
+        }
+        printf("%7d  %11.1f  %12.1f   %17.1f  %15.1f\n", n,
+               tp / ROUNDS, qp / ROUNDS, tr / ROUNDS, qr / ROUNDS);
+    }
+    return 0;
+}
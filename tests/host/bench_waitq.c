@@ -0,0 +1,62 @@
+/**
+ * @file bench_waitq.c
+ * @brief Time spent with interrupts masked to queue one more waiter on a
+ *        PRIO wait list that already holds 32 parked threads. The Makefile
+ *        builds it with the sorted-list walk and with the priority bitmap.
+ * @note t_ipc_suspend() runs entirely under the caller's IRQ lock, so its
+ *       cost is the IRQ-off window of the insert. Host numbers only show
+ *       the relative gap; measure on the target with the DWT cycle counter.
+ */
+
+#include "port.h"
+
+#define WAITERS 32
+#define ROUNDS  200000
+
+static t_thread_t parked[WAITERS], extra;
+static t_ipc_t sem;
+
+/* Insert at the lowest (tail) or highest (head) priority and take it out again */
+static double ns_per_insert(t_uint8_t prio)
+{
+    double t0, sum = 0;
+    int r;
+
+    extra.current_priority = prio;
+    extra.number_mask = 1UL << prio;
+    for (r = 0; r < ROUNDS; r++)
+    {
+        extra.pend_on = &sem;   /* cleared by t_ipc_unlink */
+        t0 = port_ns();
+        t_ipc_suspend(&sem.wait_list, &extra, sem.mode);
+        sum += port_ns() - t0;
+        t_ipc_unlink(&extra);
+    }
+    return sum / ROUNDS;
+}
+
+int main(void)
+{
+    int i;
+
+    port_init();
+    t_sema_create_static(1, 0, TO_IPC_FLAG_PRIO, &sem);
+    /* priorities 1..TO_THREAD_PRIORITY_MAX - 2, several waiters per level */
+    for (i = 0; i < WAITERS; i++)
+    {
+        port_thread(&parked[i], 1 + i % (TO_THREAD_PRIORITY_MAX - 2));
+        port_park(&sem, &parked[i], TO_IPC_WAIT_RECV, NULL);
+    }
+    port_thread(&extra, 0);
+
+#if TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY
+    i = 0;
+#else
+    i = 1;
+#endif
+    printf("%-6s  insert behind %d waiters %6.1f ns   insert in front %6.1f ns\n",
+           TO_USING_IPC_PRIO_BITMAP ? "bitmap" : "walk", WAITERS,
+           ns_per_insert(i ? 0 : TO_THREAD_PRIORITY_MAX - 1),
+           ns_per_insert(i ? TO_THREAD_PRIORITY_MAX - 1 : 0));
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file port.c
+ * @brief Host stand-ins for libcpu/ and scheduler.c.
+ */
+
+#include "port.h"
+#include <stdlib.h>
+#include <time.h>
+
+extern volatile t_uint32_t s_tick;
+
+t_thread_t *t_current_thread = NULL;
+t_list_t t_thread_ready_lists[TO_THREAD_PRIORITY_MAX];
+t_uint32_t t_thread_ready_priority_group;
+t_list_t t_thread_waiting_termination_list;
+
+int port_failures;
+int port_switch_calls;
+int port_irq_disables;
+void (*port_block_hook)(t_thread_t *self);
+void (*port_cas_hook)(volatile void *addr);
+
+static t_uint32_t s_sched_suspend;
+static t_uint8_t s_stack[64];
+
+static void port_fatal(const char *what, t_thread_t *thread)
+{
+    printf("FATAL %s (thread %p)\n", what, (void *)thread);
+    exit(2);
+}
+
+/* ---------------- CPU layer ---------------- */
+
+t_uint32_t t_irq_disable(void)
+{
+    port_irq_disables++;
+    return 0;
+}
+
+void t_irq_enable(t_uint32_t level)
+{
+    (void)level;
+}
+
+t_uint8_t *t_stack_init(t_uint8_t *stackaddr, t_thread_entry_t entry, void *arg)
+{
+    (void)entry;
+    (void)arg;
+    return stackaddr;
+}
+
+int __t_ffs(int value)
+{
+    return __builtin_ffs(value);
+}
+
+int __t_fls(int value)
+{
+    return value ? 32 - __builtin_clz((unsigned)value) : 0;
+}
+
+/* ---------------- scheduler ---------------- */
+
+static t_uint32_t highest_ready_priority(void)
+{
+#if (TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY)
+    return __t_ffs(t_thread_ready_priority_group) - 1;
+#else
+    return __t_fls(t_thread_ready_priority_group) - 1;
+#endif
+}
+
+void t_sched_remove_thread(t_thread_t *thread)
+{
+    if (!thread)
+        return;
+    t_list_delete(&thread->tlist);
+    if (t_list_isempty(&t_thread_ready_lists[thread->current_priority]))
+        t_thread_ready_priority_group &= ~(thread->number_mask);
+}
+
+void t_sched_insert_thread(t_thread_t *thread)
+{
+    if (!thread)
+        return;
+    /* Linked anywhere (ready list or a wait list): a second insert would
+     * corrupt both lists on the target. */
+    if (!t_list_isempty(&thread->tlist))
+        port_fatal("t_sched_insert_thread on a linked thread", thread);
+    t_list_insert_before(&t_thread_ready_lists[thread->current_priority], &thread->tlist);
+    t_thread_ready_priority_group |= thread->number_mask;
+}
+
+t_uint8_t t_sched_need_switch(void)
+{
+    t_uint32_t prio = highest_ready_priority();
+
+    if (prio >= TO_THREAD_PRIORITY_MAX)
+        return 0;
+    return (t_current_thread != T_LIST_ENTRY(t_thread_ready_lists[prio].next, t_thread_t, tlist));
+}
+
+/**
+ * @brief Only a blocking switch is modelled: the hook runs the rest of the
+ *        system, then the blocked thread resumes.
+ */
+void t_sched_switch(void)
+{
+    t_thread_t *self = t_current_thread;
+
+    port_switch_calls++;
+    if (s_sched_suspend || !self || TO_THREAD_SUSPEND != self->status)
+        return;
+
+    if (port_block_hook)
+        port_block_hook(self);
+    t_current_thread = self;
+    if (TO_THREAD_SUSPEND == self->status)
+        port_fatal("blocked thread was never woken", self);
+    self->status = TO_THREAD_RUNNING;
+}
+
+void t_sched_suspend(void)
+{
+    s_sched_suspend++;
+}
+
+void t_sched_resume(void)
+{
+    if (0 == --s_sched_suspend)
+        t_sched_switch();
+}
+
+void t_isr_yield(t_uint8_t woken)
+{
+    if (woken)
+        t_sched_switch();
+}
+
+void t_thread_timeslice_expire(void)
+{
+}
+
+/* ---------------- test helpers ---------------- */
+
+void port_init(void)
+{
+    int i;
+
+    for (i = 0; i < TO_THREAD_PRIORITY_MAX; i++)
+        t_list_init(&t_thread_ready_lists[i]);
+    t_list_init(&t_thread_waiting_termination_list);
+    t_thread_ready_priority_group = 0;
+    t_timer_list_init();
+    s_tick = 0;
+    s_sched_suspend = 0;
+    t_current_thread = NULL;
+    port_block_hook = NULL;
+    port_cas_hook = NULL;
+}
+
+void port_thread(t_thread_t *thread, t_int8_t priority)
+{
+    if (T_OK != t_thread_create_static((t_thread_entry_t)port_thread, s_stack, sizeof(s_stack),
+                                       priority, NULL, 10, thread) ||
+        T_OK != t_thread_startup(thread))
+        port_fatal("port_thread", thread);
+}
+
+void port_run(t_thread_t *thread)
+{
+    if (t_current_thread && TO_THREAD_RUNNING == t_current_thread->status)
+        t_current_thread->status = TO_THREAD_READY;
+    t_current_thread = thread;
+    thread->status = TO_THREAD_RUNNING;
+}
+
+void port_tick(t_uint32_t n)
+{
+    while (n--)
+    {
+        s_tick++;
+        t_timer_check();
+    }
+}
+
+int port_timer_armed(t_thread_t *thread)
+{
+    return !t_list_isempty(&thread->timer.row[0]);
+}
+
+#if TO_USING_IPC
+void port_park(t_ipc_t *ipc, t_thread_t *thread, t_uint8_t dir, void *data)
+{
+    thread->pend_on = ipc;
+    thread->ipc_flag = dir;
+    thread->ipc_data = data;
+    thread->ipc_status = T_BUSY;
+    t_ipc_suspend(&ipc->wait_list, thread, ipc->mode);
+}
+#endif
+
+double port_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int port_report(const char *name)
+{
+    printf("%s: %d failures\n", name, port_failures);
+    return port_failures ? 1 : 0;
+}
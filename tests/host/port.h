@@ -0,0 +1,58 @@
+/**
+ * @file port.h
+ * @brief Host port used by the kernel tests.
+ * @note
+ *   The kernel sources are built unchanged. The port replaces the CPU layer
+ *   and the scheduler: there is one host stack, so a thread that blocks
+ *   calls port_block_hook, which plays the other threads and the tick until
+ *   the blocked thread has been made ready again.
+ */
+
+#ifndef __TORTOS_HOST_PORT_H_
+#define __TORTOS_HOST_PORT_H_
+
+#include "ToRTOS.h"
+#include <stdio.h>
+
+/** Record a failed check and keep going. */
+#define CK(c)                                                                  \
+    do                                                                         \
+    {                                                                          \
+        if (!(c))                                                              \
+        {                                                                      \
+            printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c);                 \
+            port_failures++;                                                   \
+        }                                                                      \
+    } while (0)
+
+extern int port_failures;
+/** Calls to t_sched_switch(), blocking or not. */
+extern int port_switch_calls;
+/** Calls to t_irq_disable(). */
+extern int port_irq_disables;
+/** Runs other threads while self is blocked; must leave self ready. */
+extern void (*port_block_hook)(t_thread_t *self);
+/* port_cas_hook (declared in ToRTOS_Config.h): runs after every successful
+ * kernel compare-and-swap on addr, as an interrupt taken right there would. */
+
+/* Kernel internal without a prototype in ToRTOS.h */
+t_status_t t_ipc_suspend(t_list_t *sentinel, t_thread_t *thread, t_uint8_t flag);
+
+/** Reset scheduler, timers and counters; call at the start of main(). */
+void port_init(void);
+/** Create and start a thread at the given priority (not running). */
+void port_thread(t_thread_t *thread, t_int8_t priority);
+/** Make thread the running thread. */
+void port_run(t_thread_t *thread);
+/** Advance the tick by n, expiring timers as the tick ISR would. */
+void port_tick(t_uint32_t n);
+/** 1 if the thread's timeout timer is armed. */
+int port_timer_armed(t_thread_t *thread);
+/** Park a thread on an IPC wait list as if it had blocked there. */
+void port_park(t_ipc_t *ipc, t_thread_t *thread, t_uint8_t dir, void *data);
+/** Monotonic host time in nanoseconds, for the benchmarks. */
+double port_ns(void);
+/** Print the summary line; returns the process exit status. */
+int port_report(const char *name);
+
+#endif /* __TORTOS_HOST_PORT_H_ */
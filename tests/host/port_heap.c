@@ -0,0 +1,17 @@
+/**
+ * @file port_heap.c
+ * @brief Host heap for the dynamic create paths (test_tlsf links mem2.c instead).
+ */
+
+#include "ToRTOS.h"
+#include <stdlib.h>
+
+void *t_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void t_free(void *ptr)
+{
+    free(ptr);
+}
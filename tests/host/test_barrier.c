@@ -0,0 +1,107 @@
+/**
+ * @file test_barrier.c
+ * @brief Barriers and rendezvous channels.
+ */
+
+#include "port.h"
+
+static t_thread_t A, B, C;
+static t_ipc_t br, rv;
+static int mode;
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint32_t v[3] = {4, 5, 6}, d[3];
+
+    port_run(&C);
+    switch (mode)
+    {
+    case 1: /* C completes the round: every waiter released in one switch */
+        port_switch_calls = 0;
+        CK(t_barrier_wait(&br, 0) == T_OK && port_switch_calls == 1);
+        CK(t_list_isempty(&br.wait_list) && B.status == TO_THREAD_READY && B.ipc_status == T_OK);
+        CK(br.msg_waiting == 0);
+        break;
+    case 2:
+        port_tick(10);
+        break;
+    case 3: /* the timer fires, then the round completes before self runs */
+        port_tick(10);
+        CK(t_barrier_wait(&br, 0) == T_OK);
+        break;
+    case 4:
+        CK(t_rendezvous_recv(&rv, d, 0) == T_OK && d[0] == 1 && d[2] == 3);
+        break;
+    case 5:
+        CK(t_rendezvous_send(&rv, v, 0) == T_OK);
+        break;
+    }
+    port_run(self);
+}
+
+static void test_barrier(void)
+{
+    CK(T_BARRIER_CREATE_STATIC(3, &br) == T_OK);
+    CK(t_barrier_wait(&br, 0) == T_ERR && br.msg_waiting == 0);
+
+    /* B waits, A arrives and blocks, C completes the round */
+    port_park(&br, &B, TO_IPC_WAIT_RECV, NULL);
+    br.msg_waiting = 1;
+    mode = 1;
+    CK(t_barrier_wait(&br, 10) == T_OK && br.u.barrier == 1);
+
+    /* a timeout withdraws the arrival */
+    mode = 2;
+    CK(t_barrier_wait(&br, 10) == T_ERR && br.msg_waiting == 0 && t_list_isempty(&br.wait_list));
+
+    /* a timeout racing the release counts as a pass */
+    port_park(&br, &B, TO_IPC_WAIT_RECV, NULL);
+    br.msg_waiting = 1;
+    mode = 3;
+    CK(t_barrier_wait(&br, 10) == T_OK && br.msg_waiting == 0 && br.u.barrier == 2);
+}
+
+static void test_rendezvous(void)
+{
+    static t_uint32_t parked[3];
+    t_uint32_t v[3] = {1, 2, 3}, d[3] = {0};
+    t_uint8_t w = 0;
+    t_ipc_t *dy;
+
+    CK(T_RENDEZVOUS_CREATE_STATIC(12, TO_IPC_FLAG_PRIO, &rv) == T_OK);
+    CK(t_rendezvous_send(&rv, v, 0) == T_ERR && t_rendezvous_recv(&rv, d, 0) == T_ERR);
+    CK(t_rendezvous_send_isr(&rv, v, &w) == T_ERR);
+    mode = 4;
+    CK(t_rendezvous_send(&rv, v, 10) == T_OK);
+    mode = 5;
+    CK(t_rendezvous_recv(&rv, d, 10) == T_OK && d[0] == 4 && d[2] == 6);
+    mode = 2;
+    CK(t_rendezvous_recv(&rv, d, 10) == T_ERR && t_list_isempty(&rv.wait_list));
+
+    /* an ISR meets parked threads */
+    port_park(&rv, &B, TO_IPC_WAIT_RECV, parked);
+    CK(t_rendezvous_recv_isr(&rv, d, &w) == T_ERR); /* a receiver, not a sender */
+    CK(t_rendezvous_send_isr(&rv, v, &w) == T_OK && parked[1] == 2 && B.status == TO_THREAD_READY);
+    port_park(&rv, &B, TO_IPC_WAIT_SEND, v);
+    d[0] = 0;
+    CK(t_rendezvous_recv(&rv, d, 0) == T_OK && d[0] == 1 && B.ipc_status == T_OK);
+
+    CK(T_RENDEZVOUS_CREATE(3, TO_IPC_FLAG_FIFO, &dy) == T_OK && t_ipc_delete(dy) == T_OK);
+    CK(T_BARRIER_CREATE(2, &dy) == T_OK && t_ipc_delete(dy) == T_OK);
+    CK(t_ipc_delete(&br) == T_OK && t_barrier_wait(&br, 0) == T_DELETED);
+    CK(t_ipc_delete(&rv) == T_OK && t_rendezvous_send(&rv, v, 0) == T_DELETED);
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_thread(&C, 3);
+    port_run(&A);
+    port_block_hook = block_hook;
+
+    test_barrier();
+    test_rendezvous();
+    return port_report("barrier/rendezvous");
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_bufpool.c
+ * @brief Reference-counted buffers: blocking alloc, chains, fan-out.
+ */
+
+#include "port.h"
+
+static t_thread_t A, B;
+static t_ipc_t bp;
+static t_buf_t *held;
+static int mode;
+
+static void block_hook(t_thread_t *self)
+{
+    port_run(&B);
+    switch (mode)
+    {
+    case 1:
+        CK(t_buf_free(held) == T_OK);
+        break;
+    case 2:
+        port_tick(10);
+        break;
+    }
+    port_run(self);
+}
+
+static void test_alloc_chain(void)
+{
+    static t_uint32_t pool[T_BUFPOOL_POOL_SIZE(3, 10) / 4];
+    t_buf_t *a, *b, *c, *d, *r;
+    t_uint16_t fr, mf;
+    t_uint32_t al;
+    t_uint8_t w = 0;
+
+    CK(T_BUFPOOL_CREATE_STATIC(pool, 3, 10, TO_IPC_FLAG_FIFO, &bp) == T_OK);
+    CK(T_BUF_STRIDE(10) == T_ALIGN_UP(sizeof(t_buf_t) + 10, TO_ALIGN_SIZE));
+    CK(t_buf_alloc(&bp, &a, 0) == T_OK && a->refcnt == 1 && (t_uint8_t *)a == (t_uint8_t *)pool);
+    CK(t_buf_alloc_isr(&bp, &b) == T_OK && t_buf_alloc(&bp, &c, 0) == T_OK);
+    CK(t_buf_alloc(&bp, &d, 0) == T_ERR);
+
+    /* a blocked allocator gets the freed buffer directly */
+    held = c;
+    mode = 1;
+    CK(t_buf_alloc(&bp, &d, 10) == T_OK && d == c && d->refcnt == 1);
+    mode = 2;
+    CK(t_buf_alloc(&bp, &r, 10) == T_ERR && t_list_isempty(&bp.wait_list));
+
+    /* a->b->d: freeing the head releases the whole frame */
+    CK(t_buf_chain(a, b) == T_OK && t_buf_chain(a, d) == T_OK && b->next == d);
+    CK(t_buf_ref(b) == T_OK); /* someone else still holds b */
+    CK(t_buf_free(a) == T_OK);
+    CK(t_bufpool_stats(&bp, &fr, &mf, &al) == T_OK && fr == 1 && mf == 0 && al == 4);
+    CK(b->refcnt == 1 && t_buf_free_isr(b, &w) == T_OK); /* releases b and d */
+    CK(t_bufpool_stats(&bp, &fr, NULL, NULL) == T_OK && fr == 3);
+    CK(t_buf_free(a) == T_INVALID); /* double free */
+
+    /* one predecessor per buffer, no loops */
+    CK(t_buf_alloc(&bp, &a, 0) == T_OK && t_buf_alloc(&bp, &b, 0) == T_OK && t_buf_alloc(&bp, &c, 0) == T_OK);
+    CK(t_buf_chain(a, a) == T_INVALID && t_buf_chain(a, b) == T_OK);
+    CK(t_buf_chain(c, b) == T_INVALID && t_buf_chain(b, a) == T_INVALID);
+    CK(t_buf_chain(b, c) == T_OK && t_buf_chain(c, a) == T_INVALID);
+
+    /* a segment freed behind the chain's back fails the whole release */
+    CK(t_buf_free(c) == T_OK);
+    CK(t_buf_free(a) == T_INVALID && a->refcnt == 1 && b->refcnt == 1 && c->refcnt == 0);
+    b->next = NULL;
+    CK(t_buf_free(a) == T_OK);
+    CK(t_bufpool_stats(&bp, &fr, NULL, NULL) == T_OK && fr == 3);
+}
+
+static void test_fan_out(void)
+{
+    static t_uint32_t qp1[4 * 2], qp2[4 * 2], mbp[4];
+    t_ipc_t q1, q2, mb;
+    t_ipc_t *dy;
+    t_buf_t *a, *r1, *r2;
+    t_uint16_t fr;
+
+    CK(t_queue_create_static(qp1, 4, sizeof(t_buf_t *), TO_IPC_FLAG_FIFO, &q1) == T_OK);
+    CK(t_queue_create_static(qp2, 4, sizeof(t_buf_t *), TO_IPC_FLAG_FIFO, &q2) == T_OK);
+    CK(t_buf_alloc(&bp, &a, 0) == T_OK);
+    ((char *)T_BUF_DATA(a))[0] = 'x';
+    a->len = 1;
+    CK(t_buf_share(&q1, a, 0) == T_OK && t_buf_send(&q2, a, 0) == T_OK && a->refcnt == 2);
+    CK(t_buf_recv(&q1, &r1, 0) == T_OK && r1 == a && t_buf_recv(&q2, &r2, 0) == T_OK && r2 == a);
+    CK(((char *)T_BUF_DATA(r1))[0] == 'x');
+    CK(t_buf_free(r1) == T_OK && t_buf_free(r2) == T_OK);
+    CK(t_bufpool_stats(&bp, &fr, NULL, NULL) == T_OK && fr == 3);
+
+    /* a mailbox carries 32-bit words: fine on the target, not on a 64-bit host */
+    CK(t_mailbox_create_static(mbp, 4, TO_IPC_FLAG_FIFO, &mb) == T_OK);
+    CK(t_buf_send(&mb, a, 0) == (sizeof(void *) == 4 ? T_OK : T_UNSUPPORTED));
+
+    CK(T_BUFPOOL_CREATE(2, 100, TO_IPC_FLAG_PRIO, &dy) == T_OK);
+    CK(t_buf_alloc(dy, &a, 0) == T_OK && t_buf_free(a) == T_OK);
+    CK(t_ipc_delete(dy) == T_OK);
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_run(&A);
+    port_block_hook = block_hook;
+
+    test_alloc_chain();
+    test_fan_out();
+    return port_report("buffer pool");
+}
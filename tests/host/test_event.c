@@ -0,0 +1,51 @@
+/**
+ * @file test_event.c
+ * @brief Event groups: AND/OR matching, clear on exit, wake order.
+ */
+
+#include "port.h"
+
+static t_thread_t me, a, b, c;
+
+static void park(t_ipc_t *e, t_thread_t *t, t_uint32_t set, t_uint8_t opt)
+{
+    t->event_set = set;
+    t->event_info = opt;
+    port_park(e, t, TO_IPC_WAIT_RECV, NULL);
+}
+
+int main(void)
+{
+    t_ipc_t e;
+    t_uint32_t r = 0;
+
+    port_init();
+    port_thread(&me, 3);
+    port_thread(&a, 3);
+    port_thread(&b, 3);
+    port_thread(&c, 3);
+    port_run(&me);
+
+    CK(t_event_create_static(TO_IPC_FLAG_FIFO, &e) == T_OK);
+    CK(t_event_recv(&e, 0x3, TO_EVENT_OR, 0, &r) == T_ERR);
+    CK(t_event_recv(&e, 0x3, TO_EVENT_OR | TO_EVENT_AND, 0, &r) == T_INVALID);
+    t_event_send(&e, 0x1);
+    CK(t_event_recv(&e, 0x3, TO_EVENT_AND, 0, &r) == T_ERR);
+    CK(t_event_recv(&e, 0x3, TO_EVENT_OR, 0, &r) == T_OK && r == 1);
+    CK(t_event_recv(&e, 0x3, TO_EVENT_OR | TO_EVENT_CLEAR, 0, &r) == T_OK && r == 1);
+    CK(t_event_recv(&e, 0x3, TO_EVENT_OR, 0, &r) == T_ERR);
+
+    park(&e, &a, 0x3, TO_EVENT_AND | TO_EVENT_CLEAR);
+    park(&e, &b, 0x2, TO_EVENT_OR);
+    park(&e, &c, 0x8, TO_EVENT_OR);
+    t_event_send(&e, 0x2);
+    CK(a.ipc_status == T_BUSY && b.ipc_status == T_OK && b.event_set == 2 && c.ipc_status == T_BUSY);
+    t_event_send(&e, 0x1);
+    CK(a.ipc_status == T_OK && a.event_set == 3 && e.u.event == 0);
+    CK(e.wait_list.next == &c.tlist && c.tlist.next == &e.wait_list);
+    t_event_send(&e, 0x18);
+    CK(c.ipc_status == T_OK && c.event_set == 8 && e.u.event == 0x18);
+    t_event_clear(&e, 0x10);
+    CK(e.u.event == 0x8);
+    return port_report("event");
+}
@@ -0,0 +1,100 @@
+/**
+ * @file test_isr.c
+ * @brief ISR variants never block and report whether a switch is due.
+ */
+
+#include "port.h"
+
+static t_thread_t lowest, low, high;
+
+/* Waking a thread below the interrupted one asks for no switch */
+static void test_lower(void)
+{
+    static int pool[2];
+    t_ipc_t idle, q;
+    int v = 5, r = 0;
+    t_uint8_t w = 0;
+
+    /* keep high off the ready list so only lowest competes with low */
+    t_sema_create_static(1, 0, TO_IPC_FLAG_FIFO, &idle);
+    port_park(&idle, &high, TO_IPC_WAIT_RECV, NULL);
+    t_queue_create_static(pool, 2, sizeof(int), TO_IPC_FLAG_FIFO, &q);
+    port_park(&q, &lowest, TO_IPC_WAIT_RECV, &r);
+    CK(t_queue_send_isr(&q, &v, &w) == T_OK && w == 0);
+    CK(r == 5 && lowest.status == TO_THREAD_READY);
+
+    /* t_isr_yield switches only when asked to */
+    port_switch_calls = 0;
+    t_isr_yield(w);
+    CK(0 == port_switch_calls);
+
+    t_ipc_unlink(&high);
+    high.status = TO_THREAD_READY;
+    t_sched_insert_thread(&high);
+    t_isr_yield(1);
+    CK(1 == port_switch_calls);
+}
+
+/* Every ISR variant that can wake a higher priority thread reports it */
+static void test_higher(void)
+{
+    static int pool[2];
+    t_ipc_t q, e;
+    int v, r = 0;
+    t_uint8_t w;
+
+    t_queue_create_static(pool, 2, sizeof(int), TO_IPC_FLAG_FIFO, &q);
+    w = 0;
+    v = 7;
+    port_park(&q, &high, TO_IPC_WAIT_RECV, &r);
+    CK(t_queue_send_front_isr(&q, &v, &w) == T_OK && w == 1 && r == 7);
+    w = 0;
+    v = 8;
+    port_park(&q, &high, TO_IPC_WAIT_RECV, &r);
+    CK(t_queue_overwrite_isr(&q, &v, &w) == T_OK && w == 1 && r == 8);
+    CK(0 == q.msg_waiting);
+
+    t_event_create_static(TO_IPC_FLAG_FIFO, &e);
+    high.event_set = 0x4;
+    high.event_info = TO_EVENT_OR;
+    port_park(&e, &high, TO_IPC_WAIT_RECV, NULL);
+    w = 0;
+    CK(t_event_send_isr(&e, 0x1, &w) == T_OK && w == 0);
+    CK(TO_THREAD_SUSPEND == high.status);
+    CK(t_event_send_isr(&e, 0x4, &w) == T_OK && w == 1);
+    CK(high.ipc_status == T_OK && high.status == TO_THREAD_READY);
+}
+
+int main(void)
+{
+    static int pool[2];
+    t_ipc_t s, q;
+    int v = 1, r = 0;
+    t_uint8_t w = 0;
+
+    port_init();
+    port_thread(&lowest, 1);
+    port_thread(&low, 2);
+    port_thread(&high, 8);
+    port_run(&low);
+
+    test_lower();
+    test_higher();
+
+    t_sema_create_static(1, 0, TO_IPC_FLAG_FIFO, &s);
+    CK(t_sema_send_isr(&s, &w) == T_OK && w == 0);
+    CK(t_sema_send_isr(&s, &w) == T_ERR);
+    CK(t_sema_send(&s) == T_ERR);
+
+    /* waking a higher priority receiver asks for a switch */
+    t_queue_create_static(pool, 2, sizeof(int), TO_IPC_FLAG_FIFO, &q);
+    port_park(&q, &high, TO_IPC_WAIT_RECV, &r);
+    v = 42;
+    CK(t_queue_send_isr(&q, &v, &w) == T_OK && w == 1);
+    CK(r == 42 && high.ipc_status == T_OK && high.status == TO_THREAD_READY);
+    CK(t_queue_send_isr(&q, &v, NULL) == T_OK && t_queue_send_isr(&q, &v, NULL) == T_OK);
+    CK(t_queue_send_isr(&q, &v, NULL) == T_ERR);
+    CK(t_queue_recv_isr(&q, &r, NULL) == T_OK && t_queue_recv_isr(&q, &r, NULL) == T_OK);
+    CK(t_queue_recv_isr(&q, &r, NULL) == T_ERR);
+    return port_report("isr");
+}
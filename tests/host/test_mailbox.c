@@ -0,0 +1,67 @@
+/**
+ * @file test_mailbox.c
+ * @brief Mailbox: handoff to blocked fetchers and posters, wrap, timeout.
+ */
+
+#include "port.h"
+
+static t_thread_t A, B;
+static t_ipc_t mb;
+static int mode;
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint32_t v;
+
+    port_run(&B);
+    switch (mode)
+    {
+    case 1: /* A fetching on empty */
+        CK(t_mailbox_post(&mb, 0xABCD, 0) == T_OK);
+        break;
+    case 2: /* A posting on full */
+        CK(t_mailbox_fetch(&mb, &v, 0) == T_OK && v == 1);
+        break;
+    case 3:
+        port_tick(10);
+        break;
+    }
+    port_run(self);
+}
+
+int main(void)
+{
+    static t_uint32_t pool[3];
+    t_uint32_t v = 0, i;
+    t_uint8_t w = 0;
+    t_ipc_t *d;
+
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_run(&A);
+    port_block_hook = block_hook;
+
+    CK(T_MAILBOX_CREATE_STATIC(pool, 3, TO_IPC_FLAG_FIFO, &mb) == T_OK);
+    CK(t_mailbox_fetch(&mb, &v, 0) == T_ERR);
+    mode = 1;
+    CK(t_mailbox_fetch(&mb, &v, 10) == T_OK && v == 0xABCD && mb.msg_waiting == 0);
+    for (i = 1; i <= 3; i++)
+        CK(t_mailbox_post(&mb, i, 0) == T_OK);
+    CK(t_mailbox_post_isr(&mb, 9, &w) == T_ERR);
+    mode = 2;
+    CK(t_mailbox_post(&mb, 4, 10) == T_OK && mb.msg_waiting == 3);
+    for (i = 2; i <= 4; i++)
+        CK(t_mailbox_fetch_isr(&mb, &v, &w) == T_OK && v == i);
+    mode = 3;
+    CK(t_mailbox_fetch(&mb, &v, 10) == T_ERR && t_list_isempty(&mb.wait_list));
+
+    for (i = 0; i < 10; i++)
+    {
+        CK(t_mailbox_post(&mb, i, 0) == T_OK);
+        CK(t_mailbox_fetch(&mb, &v, 0) == T_OK && v == i);
+    }
+    CK(T_MAILBOX_CREATE(2, TO_IPC_FLAG_PRIO, &d) == T_OK);
+    CK(t_mailbox_post(d, 5, 0) == T_OK && t_ipc_delete(d) == T_OK);
+    return port_report("mailbox");
+}
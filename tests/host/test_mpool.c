@@ -0,0 +1,87 @@
+/**
+ * @file test_mpool.c
+ * @brief Fixed-block pools: LIFO reuse, ABA tag, handoff, bad frees.
+ */
+
+#include "port.h"
+#include <string.h>
+
+static t_thread_t A, B;
+static t_ipc_t mp;
+static void *held;
+static int mode;
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint8_t w = 0;
+
+    port_run(&B);
+    switch (mode)
+    {
+    case 1: /* an ISR frees a block straight to the waiter */
+        CK(t_mpool_free_isr(&mp, held, &w) == T_OK && self->status == TO_THREAD_READY);
+        break;
+    case 2:
+        port_tick(10);
+        break;
+    }
+    port_run(self);
+}
+
+int main(void)
+{
+    static t_uint32_t pool[T_MPOOL_POOL_SIZE(4, 6) / 4];
+    void *b[5];
+    t_uint32_t tag;
+    t_ipc_t *dy;
+    int i;
+
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_run(&A);
+    port_block_hook = block_hook;
+
+    CK(T_MPOOL_STRIDE(6) == 8 && T_MPOOL_STRIDE(1) == 4);
+    CK(t_mpool_create_static((char *)pool + 2, 4, 6, TO_IPC_FLAG_FIFO, &mp) == T_INVALID);
+    CK(t_mpool_create_static(pool, 1, 0xFFFD, TO_IPC_FLAG_FIFO, &mp) == T_INVALID); /* stride 64K */
+    CK(t_mpool_create(1, 0xFFFD, TO_IPC_FLAG_FIFO, &dy) == T_INVALID);
+    CK(t_mpool_create_static(pool, 1, 0xFFFC, TO_IPC_FLAG_FIFO, &mp) == T_OK && mp.u.mpool.stride == 0xFFFC);
+    CK(T_MPOOL_CREATE_STATIC(pool, 4, 6, TO_IPC_FLAG_PRIO, &mp) == T_OK && t_mpool_available(&mp) == 4);
+    for (i = 0; i < 4; i++)
+        CK(t_mpool_alloc(&mp, &b[i], 0) == T_OK && b[i] == (char *)pool + 8 * i);
+    CK(t_mpool_alloc(&mp, &b[4], 0) == T_ERR && t_mpool_alloc_isr(&mp, &b[4]) == T_ERR);
+    CK(t_mpool_available(&mp) == 0 && (mp.u.mpool.head >> 16) == 4);
+    CK(t_mpool_free(&mp, (char *)b[1] + 1) == T_INVALID && t_mpool_free(&mp, (char *)pool + 64) == T_INVALID);
+    CK(t_mpool_free(&mp, b[2]) == T_OK && t_mpool_free(&mp, b[0]) == T_OK && t_mpool_available(&mp) == 2);
+    CK(t_mpool_alloc_isr(&mp, &b[4]) == T_OK && b[4] == b[0]); /* LIFO */
+    tag = mp.u.mpool.head >> 16;
+    CK(t_mpool_alloc(&mp, &b[4], 0) == T_OK && b[4] == b[2] && (mp.u.mpool.head >> 16) == tag + 1);
+
+    held = b[3];
+    mode = 1;
+    CK(t_mpool_alloc(&mp, &b[4], 10) == T_OK && b[4] == b[3] && t_mpool_available(&mp) == 0);
+    mode = 2;
+    CK(t_mpool_alloc(&mp, &b[4], 10) == T_ERR && t_list_isempty(&mp.wait_list));
+    for (i = 0; i < 4; i++)
+        CK(t_mpool_free(&mp, b[i]) == T_OK);
+    CK(t_mpool_available(&mp) == 4);
+
+    /* the tag wraps without touching the index */
+    mp.u.mpool.head |= 0xFFFF0000UL;
+    CK(t_mpool_alloc(&mp, &b[0], 0) == T_OK && (mp.u.mpool.head >> 16) == 0);
+    CK(t_mpool_free(&mp, b[0]) == T_OK);
+
+    CK(T_MPOOL_CREATE(3, 100, TO_IPC_FLAG_FIFO, &dy) == T_OK);
+    for (i = 0; i < 3; i++)
+    {
+        CK(t_mpool_alloc(dy, &b[i], 0) == T_OK);
+        memset(b[i], 0x5A, 100);
+    }
+    CK(t_mpool_alloc(dy, &b[3], 0) == T_ERR);
+    for (i = 0; i < 3; i++)
+        CK(t_mpool_free(dy, b[i]) == T_OK);
+    CK(t_ipc_delete(dy) == T_OK);
+    CK(t_ipc_delete(&mp) == T_OK && t_mpool_alloc(&mp, &b[0], 0) == T_DELETED);
+    return port_report("mpool");
+}
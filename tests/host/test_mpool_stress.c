@@ -0,0 +1,53 @@
+/**
+ * @file test_mpool_stress.c
+ * @brief The lock-free alloc/free path under real concurrency: host
+ *        threads stand in for interrupts that preempt each other.
+ */
+
+#include "port.h"
+#include <pthread.h>
+
+#define WORKERS 4
+#define ROUNDS  200000
+
+static t_ipc_t mp;
+static t_uint32_t pool[T_MPOOL_POOL_SIZE(8, 8) / 4];
+static volatile int corrupt;
+
+static void *worker(void *arg)
+{
+    long id = (long)arg;
+    void *b[3];
+    int i, k, n;
+
+    for (i = 0; i < ROUNDS; i++)
+    {
+        n = 0;
+        for (k = 0; k < 3; k++)
+            if (t_mpool_alloc_isr(&mp, &b[n]) == T_OK)
+                *(volatile long *)b[n++] = id;
+        /* a block handed out twice would be overwritten by its other owner */
+        for (k = 0; k < n; k++)
+        {
+            if (*(volatile long *)b[k] != id)
+                corrupt++;
+            t_mpool_free_isr(&mp, b[k], NULL);
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t t[WORKERS];
+    long i;
+
+    port_init();
+    CK(T_MPOOL_CREATE_STATIC(pool, 8, 8, TO_IPC_FLAG_FIFO, &mp) == T_OK);
+    for (i = 0; i < WORKERS; i++)
+        pthread_create(&t[i], NULL, worker, (void *)(i + 1));
+    for (i = 0; i < WORKERS; i++)
+        pthread_join(t[i], NULL);
+    CK(0 == corrupt && t_mpool_available(&mp) == 8);
+    return port_report("mpool stress");
+}
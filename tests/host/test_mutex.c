@@ -0,0 +1,291 @@
+/**
+ * @file test_mutex.c
+ * @brief Mutexes: lock-free fast path, handoff, transitive priority
+ *        inheritance and its retraction, priority ceiling, priority
+ *        changes of waiters and owners.
+ */
+
+#include "port.h"
+#include <pthread.h>
+
+static t_thread_t L, M, H;
+static t_ipc_t m1, m2;
+static int stage;
+
+static void pi_hook(t_thread_t *self)
+{
+    if (1 == stage && self == &M)
+    {
+        stage = 2;
+        CK(L.current_priority == 5);
+        port_run(&H);
+        CK(T_MUTEX_ACQUIRE(&m2, 5) == T_ERR); /* H behind M behind L */
+        CK(NULL == H.pend_on);
+        CK(L.current_priority == 5 && M.current_priority == 5); /* retracted */
+        port_tick(5);                                          /* M gives up */
+    }
+    else if (2 == stage && self == &H)
+    {
+        stage = 3;
+        CK(M.current_priority == 8 && L.current_priority == 8); /* transitive */
+        port_tick(5);
+    }
+    port_run(self);
+}
+
+static void test_inherit(void)
+{
+    CK(T_MUTEX_CREATE_STATIC(TO_IPC_FLAG_PRIO, &m1) == T_OK);
+    CK(T_MUTEX_CREATE_STATIC(TO_IPC_FLAG_PRIO, &m2) == T_OK);
+    port_run(&L);
+    CK(T_MUTEX_ACQUIRE(&m1, 0) == T_OK);
+    port_run(&M);
+    CK(T_MUTEX_ACQUIRE(&m2, 0) == T_OK);
+
+    port_block_hook = pi_hook;
+    stage = 1;
+    CK(T_MUTEX_ACQUIRE(&m1, 10) == T_ERR);
+    CK(3 == stage && t_tick_get() == 10);
+    CK(L.current_priority == 2 && M.current_priority == 5);
+    port_block_hook = NULL;
+
+    CK(T_MUTEX_RELEASE(&m2) == T_OK && t_list_isempty(&M.held_list));
+    port_run(&L);
+    CK(T_MUTEX_RELEASE(&m1) == T_OK && L.current_priority == 2 && t_list_isempty(&L.held_list));
+}
+
+static void ceiling_hook(t_thread_t *self)
+{
+    CK(L.current_priority == 9); /* no inheritance on top of the ceiling */
+    port_tick(10);
+    port_run(self);
+}
+
+static void test_ceiling(void)
+{
+    t_ipc_t c, m;
+
+    CK(T_MUTEX_CEILING_CREATE_STATIC(TO_IPC_FLAG_PRIO, TO_THREAD_PRIORITY_MAX, &c) == T_INVALID);
+    CK(T_MUTEX_CEILING_CREATE_STATIC(TO_IPC_FLAG_PRIO, 9, &c) == T_OK);
+    CK(T_MUTEX_RECURSIVE_CEILING_CREATE_STATIC(TO_IPC_FLAG_PRIO, 4, &m) == T_OK);
+    port_run(&L);
+    CK(T_MUTEX_ACQUIRE(&c, 0) == T_OK && L.current_priority == 9);
+    CK(T_MUTEX_RECURSIVE_ACQUIRE(&m, 0) == T_OK && L.current_priority == 9);
+    CK(T_MUTEX_RECURSIVE_ACQUIRE(&m, 0) == T_OK);
+
+    port_run(&H);
+    port_block_hook = ceiling_hook;
+    CK(T_MUTEX_ACQUIRE(&c, 10) == T_ERR);
+    port_block_hook = NULL;
+    CK(T_MUTEX_ACQUIRE(&m, 0) == T_INVALID); /* H is above the ceiling */
+
+    port_run(&L);
+    CK(T_MUTEX_RELEASE(&c) == T_OK && L.current_priority == 4);
+    CK(T_MUTEX_RECURSIVE_RELEASE(&m) == T_OK && L.current_priority == 4);
+    CK(T_MUTEX_RECURSIVE_RELEASE(&m) == T_OK && L.current_priority == 2);
+    CK(c.msg_waiting == 1 && m.msg_waiting == 1 && t_list_isempty(&L.held_list));
+    CK(T_MUTEX_ACQUIRE(&c, 0) == T_OK && L.current_priority == 9);
+    CK(t_ipc_delete(&c) == T_OK && L.current_priority == 2);
+}
+
+static void set_prio(t_thread_t *th, t_uint8_t prio)
+{
+    CK(t_thread_ctrl(th, TO_THREAD_SET_PRIORITY, &prio) == T_OK);
+}
+
+static void prio_hook(t_thread_t *self)
+{
+    /* the owner follows its waiter up and down */
+    set_prio(&M, 9);
+    CK(M.current_priority == 9 && L.current_priority == 9);
+    set_prio(&M, 3);
+    CK(M.current_priority == 3 && L.current_priority == 3);
+    /* lowering the owner keeps what the waiter lends */
+    set_prio(&L, 1);
+    CK(L.base_priority == 1 && L.current_priority == 3);
+    set_prio(&M, 5);
+    CK(L.current_priority == 5);
+    port_tick(10);
+    port_run(self);
+}
+
+static void test_set_priority(void)
+{
+    t_ipc_t m;
+
+    CK(T_MUTEX_CREATE_STATIC(TO_IPC_FLAG_PRIO, &m) == T_OK);
+    port_run(&L);
+    CK(T_MUTEX_ACQUIRE(&m, 0) == T_OK);
+    port_run(&M);
+    port_block_hook = prio_hook;
+    CK(T_MUTEX_ACQUIRE(&m, 10) == T_ERR);
+    port_block_hook = NULL;
+    CK(L.current_priority == 1 && M.current_priority == 5);
+
+    port_run(&L);
+    CK(T_MUTEX_RELEASE(&m) == T_OK && t_list_isempty(&L.held_list));
+    set_prio(&L, 2);
+    CK(L.current_priority == 2);
+}
+
+static void test_fast_path(void)
+{
+    t_ipc_t m, r, s;
+    int before;
+
+    port_run(&M);
+    t_mutex_create_static_base(IPC_MUTEX, TO_IPC_FLAG_FIFO, &m);
+    t_mutex_create_static_base(IPC_RECURSIVE_MUTEX, TO_IPC_FLAG_FIFO, &r);
+    t_sema_create_static(2, 0, TO_IPC_FLAG_FIFO, &s);
+
+    /* uncontended: no interrupt lock at all */
+    port_irq_disables = 0;
+    CK(t_mutex_recv_base(&m, 0) == T_OK && m.msg_waiting == 0 && m.u.sema.holder == &M);
+    CK(t_mutex_send_base(&m) == T_OK && m.msg_waiting == 1 && !m.u.sema.holder);
+    CK(0 == port_irq_disables);
+    CK(t_mutex_recv_base(&r, 0) == T_OK);
+    CK(t_mutex_recv_base(&r, 0) == T_OK && r.u.sema.recursive == 2); /* recursion: slow */
+    before = port_irq_disables;
+    CK(t_mutex_send_base(&r) == T_OK && r.u.sema.recursive == 1);
+    CK(t_mutex_send_base(&r) == T_OK && r.msg_waiting == 1);
+    CK(port_irq_disables == before);
+
+    port_irq_disables = 0;
+    CK(t_sema_send(&s) == T_OK && t_sema_send(&s) == T_OK && t_sema_send(&s) == T_ERR);
+    CK(t_sema_recv(&s, 0) == T_OK && t_sema_recv(&s, 0) == T_OK && s.msg_waiting == 0);
+    CK(0 == port_irq_disables);
+
+    /* contended: the waiter marks the word, release hands over under the lock */
+    CK(t_mutex_recv_base(&m, 0) == T_OK);
+    port_run(&H);
+    CK(t_mutex_recv_base(&m, 0) == T_ERR);
+    m.msg_waiting = MUTEX_CONTENDED;
+    port_park(&m, &H, TO_IPC_WAIT_RECV, NULL);
+    port_run(&M);
+    port_irq_disables = 0;
+    CK(t_mutex_send_base(&m) == T_OK && port_irq_disables > 0);
+    CK(m.msg_waiting == 0 && t_list_isempty(&m.wait_list) && m.u.sema.holder == &H);
+    CK(H.status == TO_THREAD_READY && H.ipc_status == T_OK);
+
+    /* a mark left by a waiter that gave up: the release still takes the lock */
+    port_run(&H);
+    CK(t_mutex_send_base(&m) == T_OK && m.msg_waiting == 1);
+    CK(t_mutex_recv_base(&m, 0) == T_OK && m.u.sema.holder == &H);
+    m.msg_waiting = MUTEX_CONTENDED;
+    port_irq_disables = 0;
+    CK(t_mutex_send_base(&m) == T_OK && port_irq_disables > 0);
+    CK(m.msg_waiting == 1 && !m.u.sema.holder);
+
+    /* semaphore handoff: the count goes to the waiter, not the counter */
+    port_park(&s, &H, TO_IPC_WAIT_RECV, NULL);
+    CK(t_sema_send(&s) == T_OK && s.msg_waiting == 0 && H.ipc_status == T_OK);
+    CK(t_sema_send(&s) == T_OK && s.msg_waiting == 1);
+}
+
+/* ---- a waiter blocks between a lock-free acquire and its holder write ----
+ * H runs on its own host thread so it can stay blocked while the acquire
+ * it interrupted finishes; the two host threads take turns. */
+static t_ipc_t sm;
+static int cas_stage, co_turn; /* co_turn 1: H's host thread runs */
+static t_status_t h_ret;
+static pthread_mutex_t co_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t co_cond = PTHREAD_COND_INITIALIZER;
+
+static void co_switch(int to)
+{
+    pthread_mutex_lock(&co_lock);
+    co_turn = to;
+    pthread_cond_broadcast(&co_cond);
+    while (co_turn == to)
+        pthread_cond_wait(&co_cond, &co_lock);
+    pthread_mutex_unlock(&co_lock);
+}
+
+static void co_block_hook(t_thread_t *self)
+{
+    co_switch(0);    /* back to the interrupted acquire until H is handed the mutex */
+}
+
+static void *h_body(void *arg)
+{
+    port_run(&H);
+    h_ret = t_mutex_recv_base(&sm, 50);
+    pthread_mutex_lock(&co_lock);
+    co_turn = 0;
+    pthread_cond_broadcast(&co_cond);
+    pthread_mutex_unlock(&co_lock);
+    return arg;
+}
+
+static void window_cas_hook(volatile void *addr)
+{
+    pthread_t h;
+
+    if (addr != &sm.msg_waiting)
+        return;
+    if (1 == cas_stage)
+    {
+        /* L has freed the word, holder still names it: M takes the mutex */
+        cas_stage = 2;
+        port_run(&M);
+        CK(t_mutex_recv_base(&sm, 0) == T_OK && sm.u.sema.holder == &M);
+        CK(M.current_priority == 8 && L.current_priority == 2); /* lent to the real owner */
+        CK(!t_list_isempty(&M.held_list) && t_list_isempty(&L.held_list));
+        port_run(&L);
+    }
+    else if (2 == cas_stage)
+    {
+        /* M owns the word, holder not written yet: H blocks on the stale L */
+        cas_stage = 3;
+        co_turn = 1;
+        pthread_create(&h, NULL, h_body, NULL);
+        pthread_mutex_lock(&co_lock);
+        while (1 == co_turn)
+            pthread_cond_wait(&co_cond, &co_lock);
+        pthread_mutex_unlock(&co_lock);
+        pthread_detach(h);
+        CK(TO_THREAD_SUSPEND == H.status && sm.msg_waiting == MUTEX_CONTENDED);
+        CK(sm.u.sema.holder == &L && L.current_priority == 8);
+        port_run(&M);
+    }
+}
+
+static void test_stale_holder(void)
+{
+    t_mutex_create_static_base(IPC_MUTEX, TO_IPC_FLAG_PRIO, &sm);
+    port_run(&L);
+    CK(t_mutex_recv_base(&sm, 0) == T_OK);
+
+    port_block_hook = co_block_hook;
+    port_cas_hook = window_cas_hook;
+    cas_stage = 1;
+    CK(t_mutex_send_base(&sm) == T_OK && 3 == cas_stage);
+    port_cas_hook = NULL;
+    CK(sm.u.sema.holder == &M && L.current_priority == 2 && t_list_isempty(&L.held_list));
+
+    /* M's release hands the mutex to H and gives back what H lent */
+    port_run(&M);
+    CK(t_mutex_send_base(&sm) == T_OK && sm.u.sema.holder == &H);
+    CK(M.current_priority == 5 && t_list_isempty(&M.held_list));
+    co_switch(1);
+    CK(T_OK == h_ret && t_current_thread == &H);
+    port_block_hook = NULL;
+    CK(t_mutex_send_base(&sm) == T_OK && sm.msg_waiting == 1 && !sm.u.sema.holder);
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&L, 2);
+    port_thread(&M, 5);
+    port_thread(&H, 8);
+
+    test_inherit();
+    test_ceiling();
+    test_set_priority();
+#if TO_USING_IPC_FAST_PATH
+    test_fast_path();
+    test_stale_holder();
+#endif
+    return port_report("mutex");
+}
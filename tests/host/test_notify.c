@@ -0,0 +1,84 @@
+/**
+ * @file test_notify.c
+ * @brief Direct notifications: actions, counting take, blocking waits.
+ */
+
+#include "port.h"
+
+static t_thread_t th, other;
+static int mode, hits;
+
+static void block_hook(t_thread_t *self)
+{
+    port_run(&other);
+    switch (mode)
+    {
+    case 1:
+        CK(T_NOTIFY_GIVE(self) == T_OK);
+        CK(TO_THREAD_READY == self->status);
+        break;
+    case 2:
+        port_tick(30);
+        break;
+    case 3: /* the timeout fires, then a notify arrives before self runs */
+        port_tick(30);
+        CK(TO_THREAD_READY == self->status);
+        CK(T_NOTIFY_GIVE(self) == T_OK);
+        break;
+    case 4: /* woken with the value still 0: the take waits on to its deadline */
+        if (1 == ++hits)
+        {
+            port_tick(10);
+            CK(t_thread_notify(self, 0, TO_NOTIFY_OVERWRITE) == T_OK);
+            CK(TO_THREAD_READY == self->status);
+        }
+        else
+            port_tick(20);
+        break;
+    }
+    port_run(self);
+}
+
+int main(void)
+{
+    t_uint32_t v;
+
+    port_init();
+    port_thread(&th, 5);
+    port_thread(&other, 5);
+    port_run(&th);
+
+    CK(t_thread_notify_take(0, &v, 0) == T_ERR);
+    CK(T_NOTIFY_GIVE(&th) == T_OK && T_NOTIFY_GIVE(&th) == T_OK);
+    CK(t_thread_notify_take(0, &v, 0) == T_OK && v == 2);
+    CK(t_thread_notify_take(0, &v, 0) == T_OK && v == 1);
+    CK(t_thread_notify_take(0, &v, 0) == T_ERR);
+    CK(t_thread_notify_wait(0, 0, &v, 0) == T_ERR);
+    CK(T_NOTIFY_SET_BITS(&th, 0x5) == T_OK);
+    CK(t_thread_notify(&th, 9, TO_NOTIFY_NO_OVERWRITE) == T_BUSY);
+    CK(T_NOTIFY_WAIT_BITS(&v, 0) == T_OK && v == 5 && th.notify_value == 0);
+    CK(t_thread_notify(&th, 9, TO_NOTIFY_NO_OVERWRITE) == T_OK);
+    CK(t_thread_notify(&th, 7, TO_NOTIFY_OVERWRITE) == T_OK);
+    CK(t_thread_notify_wait(0, 0, &v, 0) == T_OK && v == 7);
+    CK(t_thread_notify_take(1, &v, 0) == T_OK && v == 7 && th.notify_value == 0);
+    CK(t_thread_notify(&th, 7, 9) == T_INVALID);
+
+    port_block_hook = block_hook;
+    mode = 1;
+    CK(t_thread_notify_take(0, &v, 40) == T_OK && v == 1 && th.notify_value == 0);
+    CK(!port_timer_armed(&th));
+    mode = 1;
+    CK(t_thread_notify_wait(0, 0xFFFFFFFFUL, &v, TO_WAITING_FOREVER) == T_OK && v == 1);
+    mode = 2;
+    CK(t_thread_notify_take(0, &v, 30) == T_ERR && t_tick_get() == 30);
+    mode = 2;
+    CK(t_thread_notify_wait(0, 0, &v, 30) == T_ERR && t_tick_get() == 60);
+    CK(TO_NOTIFY_STATE_NONE == th.notify_state);
+    mode = 3;
+    CK(t_thread_notify_wait(0, 0xFFFFFFFFUL, &v, 30) == T_OK && v == 1);
+    CK(TO_NOTIFY_STATE_NONE == th.notify_state && th.notify_value == 0);
+    mode = 4;
+    CK(t_thread_notify_take(0, &v, 30) == T_ERR && 2 == hits && t_tick_get() == 120);
+    CK(!port_timer_armed(&th) && TO_NOTIFY_STATE_NONE == th.notify_state);
+    return port_report("notify");
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_pqueue.c
+ * @brief Priority message queue and send-to-front.
+ */
+
+#include "port.h"
+
+#if TO_LOWER_PRIORITY_NUM_HIGHER_PRIORITY
+#define HI 0
+#define LO 31
+#else
+#define HI 31
+#define LO 0
+#endif
+
+static t_thread_t A, B;
+static t_ipc_t pq, q;
+static int mode;
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint32_t v;
+    t_uint8_t p;
+
+    port_run(&B);
+    switch (mode)
+    {
+    case 1:
+        v = 77;
+        CK(t_pqueue_send(&pq, &v, 5, 0) == T_OK);
+        break;
+    case 2:
+        CK(t_pqueue_recv(&pq, &v, &p, 0) == T_OK && v == 30 && p == HI);
+        break;
+    case 3:
+        CK(t_queue_recv(&q, &v, 0) == T_OK);
+        break;
+    }
+    port_run(self);
+}
+
+static void test_pqueue(void)
+{
+    static t_uint32_t pool[T_PQUEUE_POOL_SIZE(4, 4) / 4 + 1];
+    t_uint32_t v = 0, i;
+    t_uint8_t p = 0, w = 0;
+    t_ipc_t *d;
+
+    CK(T_PQUEUE_CREATE_STATIC(pool, 4, 4, TO_IPC_FLAG_FIFO, &pq) == T_OK);
+    CK(t_pqueue_recv(&pq, &v, &p, 0) == T_ERR);
+    CK(t_pqueue_send(&pq, &v, 32, 0) == T_INVALID);
+    v = 10;
+    CK(t_pqueue_send(&pq, &v, LO, 0) == T_OK);
+    v = 20;
+    CK(t_pqueue_send(&pq, &v, 7, 0) == T_OK);
+    v = 30;
+    CK(t_pqueue_send(&pq, &v, HI, 0) == T_OK);
+    v = 21;
+    CK(t_pqueue_send_isr(&pq, &v, 7, &w) == T_OK);
+    v = 99;
+    CK(t_pqueue_send(&pq, &v, HI, 0) == T_ERR);
+
+    /* full: the blocked sender is let in by B's receive */
+    mode = 2;
+    v = 40;
+    CK(t_pqueue_send(&pq, &v, HI, 10) == T_OK && pq.msg_waiting == 4);
+    CK(t_pqueue_recv(&pq, &v, &p, 0) == T_OK && v == 40 && p == HI);
+    CK(t_pqueue_recv(&pq, &v, &p, 0) == T_OK && v == 20 && p == 7);
+    CK(t_pqueue_recv_isr(&pq, &v, &p, &w) == T_OK && v == 21 && p == 7);
+    CK(t_pqueue_recv(&pq, &v, NULL, 0) == T_OK && v == 10);
+    CK(pq.msg_waiting == 0 && pq.u.pqueue.group == 0);
+
+    /* empty: the blocked receiver gets a direct handoff */
+    mode = 1;
+    CK(t_pqueue_recv(&pq, &v, &p, 10) == T_OK && v == 77 && p == 5);
+    mode = 0;
+    for (i = 0; i < 50; i++)
+    {
+        v = i;
+        CK(t_pqueue_send(&pq, &v, i % 3, 0) == T_OK);
+        CK(t_pqueue_recv(&pq, &v, &p, 0) == T_OK && v == i);
+    }
+    CK(T_PQUEUE_CREATE(3, 8, TO_IPC_FLAG_PRIO, &d) == T_OK);
+    CK(t_pqueue_send(d, pool, 1, 0) == T_OK && t_ipc_delete(d) == T_OK);
+}
+
+static void test_send_front(void)
+{
+    static t_uint32_t qpool[3];
+    t_uint32_t v;
+    t_uint8_t w = 0;
+
+    CK(t_queue_create_static(qpool, 3, 4, TO_IPC_FLAG_FIFO, &q) == T_OK);
+    v = 1;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    v = 2;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    v = 9;
+    CK(t_queue_send_front(&q, &v, 0) == T_OK);
+    v = 8;
+    CK(t_queue_send_front_isr(&q, &v, &w) == T_ERR);
+    mode = 3;
+    CK(t_queue_send_front(&q, &v, 10) == T_OK);
+    CK(t_queue_recv(&q, &v, 0) == T_OK && v == 8);
+    CK(t_queue_recv(&q, &v, 0) == T_OK && v == 1);
+    CK(t_queue_recv(&q, &v, 0) == T_OK && v == 2);
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_run(&A);
+    port_block_hook = block_hook;
+
+    test_pqueue();
+    test_send_front();
+    return port_report("priority queue");
+}
@@ -0,0 +1,90 @@
+/**
+ * @file test_qset.c
+ * @brief Queue sets: membership rules and select order.
+ */
+
+#include "port.h"
+
+static t_thread_t A;
+
+int main(void)
+{
+    static void *sp[8], *sp2[4], *sp3[4];
+    static int qp1[2], qp2[4];
+    t_ipc_t set, set2, set3, s1, q1, q2;
+    t_ipc_t *m;
+    int arr[3] = {7, 8, 9};
+    t_uint16_t n;
+    void *slot;
+    int v, i;
+
+    port_init();
+    port_thread(&A, 3);
+    port_run(&A);
+
+    CK(t_queue_set_create_static(sp, 7, TO_IPC_FLAG_FIFO, &set) == T_OK);
+    CK(t_sema_create_static(1, 0, TO_IPC_FLAG_FIFO, &s1) == T_OK);
+    CK(t_queue_create_static(qp1, 2, sizeof(int), TO_IPC_FLAG_FIFO, &q1) == T_OK);
+    CK(t_queue_create_static(qp2, 4, sizeof(int), TO_IPC_FLAG_FIFO, &q2) == T_OK);
+    CK(t_queue_set_add(&set, &s1) == T_OK);
+    CK(t_queue_set_add(&set, &q1) == T_OK);
+    CK(t_queue_set_add(&set, &q1) == T_BUSY);
+    CK(t_queue_set_add(&set, &set) == T_INVALID);
+    /* only an empty object can join */
+    v = 5;
+    CK(t_queue_send(&q2, &v, 0) == T_OK);
+    CK(t_queue_set_add(&set, &q2) == T_BUSY);
+    CK(t_queue_recv(&q2, &v, 0) == T_OK);
+    CK(t_queue_set_add(&set, &q2) == T_OK);
+    CK(t_queue_set_select(&set, &m, 0) == T_ERR);
+
+    v = 1;
+    CK(t_queue_send(&q1, &v, 0) == T_OK);
+    CK(t_sema_send(&s1) == T_OK);
+    CK(t_queue_send_n(&q2, arr, 3, &n, 0) == T_OK);
+    CK(set.msg_waiting == 5);
+    CK(t_queue_set_select(&set, &m, 0) == T_OK && m == &q1);
+    CK(t_queue_recv(m, &v, 0) == T_OK && v == 1);
+    CK(t_queue_set_select(&set, &m, 0) == T_OK && m == &s1);
+    CK(t_sema_recv(m, 0) == T_OK);
+    for (i = 0; i < 3; i++)
+    {
+        CK(t_queue_set_select(&set, &m, 0) == T_OK && m == &q2);
+        CK(t_queue_recv(m, &v, 0) == T_OK && v == 7 + i);
+    }
+    CK(t_queue_set_select(&set, &m, 0) == T_ERR);
+
+    /* commit posts like a send */
+    CK(t_queue_reserve(&q1, &slot, 0) == T_OK);
+    *(int *)slot = 3;
+    CK(t_queue_commit(&q1, slot) == T_OK);
+    CK(t_queue_set_select(&set, &m, 0) == T_OK && m == &q1);
+    CK(t_queue_set_remove(&set, &q1) == T_BUSY);
+    CK(t_queue_recv(m, &v, 0) == T_OK && v == 3);
+    CK(t_queue_set_remove(&set, &q1) == T_OK);
+    v = 1;
+    CK(t_queue_send(&q1, &v, 0) == T_OK && set.msg_waiting == 0);
+
+    /* sets do not nest, in either order */
+    CK(t_queue_set_create_static(sp2, 4, TO_IPC_FLAG_FIFO, &set2) == T_OK);
+    CK(t_queue_set_create_static(sp3, 4, TO_IPC_FLAG_FIFO, &set3) == T_OK);
+    CK(t_queue_set_add(&set2, &set) == T_INVALID);
+    CK(t_queue_set_add(&set2, &set3) == T_OK);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK);
+    CK(t_queue_set_add(&set3, &q1) == T_INVALID);
+
+    /* a deleted member takes its handles out of the set */
+    CK(t_queue_send(&q2, &v, 0) == T_OK && t_sema_send(&s1) == T_OK);
+    CK(t_queue_send(&q2, &v, 0) == T_OK && set.msg_waiting == 3);
+    CK(t_ipc_delete(&s1) == T_OK && set.msg_waiting == 2 && NULL == s1.set);
+    for (i = 0; i < 2; i++)
+        CK(t_queue_set_select(&set, &m, 0) == T_OK && m == &q2 && t_queue_recv(m, &v, 0) == T_OK);
+    CK(t_queue_set_select(&set, &m, 0) == T_ERR);
+
+    /* a deleted set lets go of its members */
+    CK(t_ipc_delete(&set) == T_OK);
+    CK(NULL == q2.set && t_list_isempty(&q2.set_node) && t_list_isempty(&set.set_node));
+    CK(t_queue_set_add(&set2, &q2) == T_OK);
+    CK(t_queue_send(&q2, &v, 0) == T_OK && set2.msg_waiting == 1);
+    return port_report("queue set");
+}
@@ -0,0 +1,254 @@
+/**
+ * @file test_queue.c
+ * @brief Queue: batches, zero-copy slots, overwrite, blocking waits,
+ *        direct handoff to parked receivers and senders.
+ */
+
+#include "port.h"
+#include <string.h>
+
+static t_thread_t R, S, W;
+static t_ipc_t q;
+static int mode;
+
+/* What a waker does when it only asks the waiter to try again */
+static void wake_retry(t_thread_t *th)
+{
+    t_ipc_unlink(th);
+    th->ipc_status = T_BUSY;
+    th->status = TO_THREAD_READY;
+    t_sched_insert_thread(th);
+}
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint32_t v = 7;
+
+    port_run(&S);
+    switch (mode)
+    {
+    case 1: /* sender arrives before the deadline */
+        wake_retry(self);
+        CK(t_queue_send(&q, &v, 0) == T_OK);
+        break;
+    case 2: /* nobody comes */
+        port_tick(50);
+        break;
+    case 3: /* object deleted under the waiter */
+        CK(t_ipc_delete(&q) == T_OK);
+        break;
+    case 4: /* forever: no timer may be armed */
+        CK(!port_timer_armed(self));
+        CK(t_queue_send(&q, &v, 0) == T_OK);
+        break;
+    case 5: /* woken to retry, deadline passes before the waiter runs */
+        port_tick(10);
+        CK(t_queue_send(&q, &v, 0) == T_OK && self->status == TO_THREAD_READY);
+        port_tick(40);
+        break;
+    case 6: /* woken to retry, but the item is gone again: sleep out the rest */
+        port_tick(10);
+        CK(t_queue_send(&q, &v, 0) == T_OK && t_queue_recv(&q, &v, 0) == T_OK);
+        CK(port_timer_armed(self));
+        mode = 7;
+        break;
+    case 7:
+        port_tick(40);
+        break;
+    case 8: /* as 6, and the deadline passes before the retry */
+        port_tick(10);
+        CK(t_queue_send(&q, &v, 0) == T_OK && t_queue_recv(&q, &v, 0) == T_OK);
+        port_tick(40);
+        mode = 0;
+        break;
+    }
+    port_run(self);
+}
+
+static void test_batch(void)
+{
+    static t_uint32_t pool[64];
+    static t_uint8_t p2[3 * 5];
+    t_ipc_t q1, q2;
+    t_uint32_t in[40], out[40];
+    t_uint8_t b[15], o[15];
+    t_uint16_t n;
+    void *slot;
+    int i;
+
+    for (i = 0; i < 40; i++)
+        in[i] = i + 100;
+    CK(t_queue_create_static(pool, 10, 4, TO_IPC_FLAG_FIFO, &q1) == T_OK);
+    /* rotate so the batches wrap */
+    for (i = 0; i < 7; i++)
+    {
+        CK(t_queue_send(&q1, &in[i], 0) == T_OK);
+        CK(t_queue_recv(&q1, out, 0) == T_OK && out[0] == in[i]);
+    }
+    CK(t_queue_send_n(&q1, in, 12, &n, 0) == T_ERR && n == 10);
+    CK(t_queue_send(&q1, in, 0) == T_ERR);
+    memset(out, 0, sizeof(out));
+    CK(t_queue_recv_n(&q1, out, 4, 1, &n, 0) == T_OK && n == 4);
+    CK(!memcmp(out, in, 4 * sizeof(t_uint32_t)));
+    CK(t_queue_recv_n(&q1, out, 20, 0, &n, 0) == T_OK && n == 6);
+    CK(!memcmp(out, &in[4], 6 * sizeof(t_uint32_t)));
+    CK(t_queue_recv_n(&q1, out, 20, 1, &n, 0) == T_ERR && n == 0);
+
+    CK(t_queue_reserve(&q1, &slot, 0) == T_OK);
+    *(t_uint32_t *)slot = 77;
+    CK(t_queue_commit(&q1, slot) == T_OK);
+    CK(t_queue_peek(&q1, &slot, 0) == T_OK && *(t_uint32_t *)slot == 77);
+    CK(t_queue_recv(&q1, out, 0) == T_ERR);
+    CK(t_queue_release(&q1, slot) == T_OK && q1.msg_waiting == 0);
+
+    /* odd item size takes the byte kernel */
+    for (i = 0; i < 15; i++)
+        b[i] = i;
+    CK(t_queue_create_static(p2, 5, 3, TO_IPC_FLAG_FIFO, &q2) == T_OK);
+    CK(t_queue_send(&q2, b, 0) == T_OK && t_queue_send(&q2, b, 0) == T_OK);
+    CK(t_queue_recv_n(&q2, o, 5, 0, &n, 0) == T_OK && n == 2);
+    CK(t_queue_send_n(&q2, b, 5, &n, 0) == T_OK && n == 5);
+    CK(t_queue_recv_n(&q2, o, 5, 5, &n, 0) == T_OK && !memcmp(o, b, 15));
+}
+
+static void test_overwrite(void)
+{
+    static t_uint32_t pool[3];
+    t_ipc_t q1;
+    t_uint32_t v, i;
+    t_uint8_t w = 0;
+    void *p;
+
+    CK(t_queue_create_static(pool, 3, 4, TO_IPC_FLAG_FIFO, &q1) == T_OK);
+    for (i = 1; i <= 7; i++)
+        CK(t_queue_overwrite(&q1, &i) == T_OK);
+    CK(q1.msg_waiting == 3 && t_queue_dropped(&q1) == 4);
+    for (i = 5; i <= 7; i++)
+        CK(t_queue_recv(&q1, &v, 0) == T_OK && v == i);
+    i = 8;
+    CK(t_queue_overwrite_isr(&q1, &i, &w) == T_OK);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 8);
+    for (i = 1; i <= 3; i++)
+        CK(t_queue_send(&q1, &i, 0) == T_OK);
+    /* the oldest slot is lent out: nothing to overwrite */
+    CK(t_queue_peek(&q1, &p, 0) == T_OK);
+    i = 9;
+    CK(t_queue_overwrite(&q1, &i) == T_BUSY);
+    CK(t_queue_release(&q1, p) == T_OK);
+    CK(t_queue_overwrite(&q1, &i) == T_OK);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 2);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 3);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 9);
+}
+
+static void test_handoff(void)
+{
+    static t_uint32_t pool[2];
+    t_ipc_t q1;
+    t_uint32_t v, got = 0, put = 33;
+
+    CK(t_queue_create_static(pool, 2, 4, TO_IPC_FLAG_FIFO, &q1) == T_OK);
+
+    /* Parked receiver: the item goes straight into its buffer */
+    port_park(&q1, &W, TO_IPC_WAIT_RECV, &got);
+    CK(q1.wait_count[TO_IPC_WAIT_RECV] == 1 && q1.wait_count[TO_IPC_WAIT_SEND] == 0);
+    v = 11;
+    CK(t_queue_send(&q1, &v, 0) == T_OK);
+    CK(got == 11 && W.ipc_status == T_OK && W.status == TO_THREAD_READY);
+    CK(q1.msg_waiting == 0 && q1.wait_count[TO_IPC_WAIT_RECV] == 0);
+
+    /* Parked sender: its item refills the slot a receive frees */
+    for (v = 1; v <= 2; v++)
+        CK(t_queue_send(&q1, &v, 0) == T_OK);
+    port_park(&q1, &W, TO_IPC_WAIT_SEND, &put);
+    CK(q1.wait_count[TO_IPC_WAIT_SEND] == 1 && q1.wait_count[TO_IPC_WAIT_RECV] == 0);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 1);
+    CK(W.ipc_status == T_OK && W.status == TO_THREAD_READY);
+    CK(q1.msg_waiting == 2 && q1.wait_count[TO_IPC_WAIT_SEND] == 0);
+    CK(t_list_isempty(&q1.wait_list));
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 2);
+    CK(t_queue_recv(&q1, &v, 0) == T_OK && v == 33);
+}
+
+static void test_batch_refill(void)
+{
+    static t_uint32_t pool[2];
+    t_ipc_t q1;
+    t_uint32_t v, out[2], put = 44;
+    t_uint16_t n;
+
+    /* A batch sender woken to claim space does not stop the handoff to
+       the plain sender parked behind it */
+    CK(t_queue_create_static(pool, 2, 4, TO_IPC_FLAG_FIFO, &q1) == T_OK);
+    for (v = 1; v <= 2; v++)
+        CK(t_queue_send(&q1, &v, 0) == T_OK);
+    port_park(&q1, &W, TO_IPC_WAIT_SEND, NULL);
+    port_park(&q1, &S, TO_IPC_WAIT_SEND, &put);
+    CK(t_queue_recv_n(&q1, out, 2, 0, &n, 0) == T_OK && n == 2);
+    CK(W.ipc_status == T_BUSY && S.ipc_status == T_OK);
+    CK(q1.msg_waiting == 1 && t_list_isempty(&q1.wait_list));
+
+    /* One item goes through the single-item path, same results */
+    CK(t_queue_recv_n(&q1, out, 1, 1, &n, 0) == T_OK && n == 1 && out[0] == 44);
+    CK(t_queue_recv_n(&q1, out, 1, 0, &n, 0) == T_OK && n == 0);
+    CK(t_queue_recv_n(&q1, out, 1, 1, &n, 0) == T_ERR && n == 0);
+    v = 5;
+    CK(t_queue_send_n(&q1, &v, 1, &n, 0) == T_OK && n == 1);
+    CK(t_queue_send_n(&q1, &v, 1, &n, 0) == T_OK && n == 1);
+    CK(t_queue_send_n(&q1, &v, 1, &n, 0) == T_ERR && n == 0);
+}
+
+static void test_blocking(void)
+{
+    static t_uint32_t pool[4];
+    t_uint32_t v = 0, start;
+    void *slot;
+
+    CK(t_queue_create_static(pool, 4, 4, TO_IPC_FLAG_FIFO, &q) == T_OK);
+    port_block_hook = block_hook;
+
+    mode = 1;
+    CK(t_queue_recv(&q, &v, 50) == T_OK && v == 7);
+    CK(!port_timer_armed(&R));
+
+    mode = 2;
+    CK(t_queue_recv(&q, &v, 50) == T_ERR);
+    CK(t_tick_get() == 50 && t_list_isempty(&q.wait_list));
+
+    mode = 4;
+    CK(t_queue_recv(&q, &v, TO_WAITING_FOREVER) == T_OK && v == 7);
+
+    /* A retry wakeup keeps both its own result and the call's deadline */
+    start = t_tick_get();
+    mode = 5;
+    CK(t_queue_peek(&q, &slot, 50) == T_OK && *(t_uint32_t *)slot == 7);
+    CK(t_queue_release(&q, slot) == T_OK && !port_timer_armed(&R));
+    start = t_tick_get();
+    mode = 6;
+    CK(t_queue_peek(&q, &slot, 50) == T_ERR && t_tick_get() == start + 50);
+    start = t_tick_get();
+    mode = 8;
+    CK(t_queue_peek(&q, &slot, 50) == T_ERR && t_tick_get() == start + 50);
+    CK(t_list_isempty(&q.wait_list));
+
+    mode = 3;
+    CK(t_queue_recv(&q, &v, 50) == T_DELETED);
+    CK(!port_timer_armed(&R) && 0 == q.status);
+    port_block_hook = NULL;
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&R, 3);
+    port_thread(&S, 3);
+    port_thread(&W, 3);
+    port_run(&R);
+
+    test_batch();
+    test_overwrite();
+    test_handoff();
+    test_batch_refill();
+    test_blocking();
+    return port_report("queue");
+}
@@ -0,0 +1,185 @@
+/**
+ * @file test_rwlock_cond.c
+ * @brief Reader-writer lock (writer preference) and condition variables.
+ */
+
+#include "port.h"
+
+static t_thread_t me, a, b, c, d, h;
+static t_ipc_t *signal_cv;
+static t_ipc_t rwb, mb;
+static int mode;
+
+static void boost_hook(t_thread_t *self)
+{
+    switch (mode)
+    {
+    case 1: /* h waits for me's write lock; a contends a mutex me holds */
+        port_run(&me);
+        CK(me.current_priority == 8);
+        CK(T_MUTEX_ACQUIRE(&mb, 0) == T_OK);
+        port_run(&a);
+        mode = 2;
+        CK(T_MUTEX_ACQUIRE(&mb, 10) == T_OK);
+        CK(T_MUTEX_RELEASE(&mb) == T_OK);
+        break;
+    case 2: /* releasing the mutex keeps what the rwlock lends */
+        port_run(&me);
+        CK(T_MUTEX_RELEASE(&mb) == T_OK && me.current_priority == 8);
+        CK(t_rwlock_write_unlock(&rwb) == T_OK && me.current_priority == 5);
+        break;
+    case 3: /* the reader gives up: its boost goes with it */
+        port_run(&me);
+        CK(me.current_priority == 8);
+        port_tick(10);
+        break;
+    case 4: /* deleting the lock drops its boost and its held_list entry */
+        port_run(&me);
+        CK(me.current_priority == 8 && !t_list_isempty(&me.held_list));
+        CK(t_ipc_delete(&rwb) == T_OK);
+        CK(me.current_priority == 5 && t_list_isempty(&me.held_list));
+        break;
+    }
+    port_run(self);
+}
+
+static void cond_hook(t_thread_t *self)
+{
+    port_run(&a);
+    t_cond_signal(signal_cv);
+    port_run(self);
+}
+
+static void test_rwlock(void)
+{
+    t_ipc_t rw;
+
+    CK(t_rwlock_create_static(TO_IPC_FLAG_FIFO, &rw) == T_OK);
+    CK(t_rwlock_write_lock(&rw, 0) == T_UNSUPPORTED && !rw.u.rwlock.writer);
+    port_run(&me);
+    CK(t_rwlock_read_lock(&rw, 0) == T_OK);
+    CK(t_rwlock_read_lock(&rw, 0) == T_OK && rw.u.rwlock.readers == 2);
+    CK(t_rwlock_write_lock(&rw, 0) == T_ERR);
+
+    /* a queued writer blocks new readers */
+    port_park(&rw, &a, TO_IPC_WAIT_SEND, NULL);
+    rw.u.rwlock.writers_waiting = 1;
+    CK(t_rwlock_read_lock(&rw, 0) == T_ERR);
+    port_park(&rw, &b, TO_IPC_WAIT_RECV, NULL);
+    port_park(&rw, &c, TO_IPC_WAIT_RECV, NULL);
+    CK(t_rwlock_read_unlock(&rw) == T_OK && a.ipc_status == T_BUSY);
+    CK(t_rwlock_read_unlock(&rw) == T_OK && a.ipc_status == T_OK);
+    CK(rw.u.rwlock.writer == &a && rw.u.rwlock.writers_waiting == 0);
+    CK(t_rwlock_read_unlock(&rw) == T_ERR);
+    CK(t_rwlock_write_unlock(&rw) == T_ERR); /* not the owner */
+
+    /* writer to writer, then all readers at once */
+    port_run(&a);
+    port_park(&rw, &d, TO_IPC_WAIT_SEND, NULL);
+    rw.u.rwlock.writers_waiting = 1;
+    CK(t_rwlock_write_unlock(&rw) == T_OK && d.ipc_status == T_OK);
+    CK(rw.u.rwlock.writer == &d && b.ipc_status == T_BUSY);
+    port_run(&d);
+    CK(t_rwlock_write_lock(&rw, 0) == T_ERR);
+    CK(t_rwlock_write_unlock(&rw) == T_OK && b.ipc_status == T_OK && c.ipc_status == T_OK);
+    CK(rw.u.rwlock.readers == 2 && t_list_isempty(&rw.wait_list));
+}
+
+static void test_rwlock_boost(void)
+{
+    port_run(&me);
+    CK(t_rwlock_create_static(TO_IPC_FLAG_PRIO, &rwb) == T_OK);
+    CK(T_MUTEX_CREATE_STATIC(TO_IPC_FLAG_PRIO, &mb) == T_OK);
+    port_block_hook = boost_hook;
+
+    CK(t_rwlock_write_lock(&rwb, 0) == T_OK);
+    port_run(&h);
+    mode = 1;
+    CK(t_rwlock_write_lock(&rwb, 10) == T_OK && rwb.u.rwlock.writer == &h);
+    CK(t_rwlock_write_unlock(&rwb) == T_OK && h.current_priority == 8);
+    CK(t_list_isempty(&me.held_list) && t_list_isempty(&h.held_list));
+
+    port_run(&me);
+    CK(t_rwlock_write_lock(&rwb, 0) == T_OK);
+    port_run(&h);
+    mode = 3;
+    CK(t_rwlock_read_lock(&rwb, 10) == T_ERR && me.current_priority == 5);
+
+    mode = 4;
+    CK(t_rwlock_read_lock(&rwb, 10) == T_DELETED);
+    CK(t_ipc_delete(&mb) == T_OK);
+    port_block_hook = NULL;
+}
+
+static void test_rwlock_handoff(void)
+{
+    t_ipc_t rw;
+
+    /* a writer granted the lock takes over what the queue behind it lends */
+    port_run(&me);
+    CK(t_rwlock_create_static(TO_IPC_FLAG_PRIO, &rw) == T_OK);
+    CK(t_rwlock_write_lock(&rw, 0) == T_OK);
+    port_park(&rw, &a, TO_IPC_WAIT_SEND, NULL);
+    port_park(&rw, &d, TO_IPC_WAIT_SEND, NULL);
+    port_park(&rw, &h, TO_IPC_WAIT_RECV, NULL);
+    rw.u.rwlock.writers_waiting = 2;
+    CK(t_rwlock_write_unlock(&rw) == T_OK && rw.u.rwlock.writer == &a);
+    CK(a.current_priority == 8 && !t_list_isempty(&a.held_list));
+
+    port_run(&a);
+    CK(t_rwlock_write_unlock(&rw) == T_OK && rw.u.rwlock.writer == &d);
+    CK(a.current_priority == 6 && t_list_isempty(&a.held_list));
+    CK(d.current_priority == 8 && h.ipc_status == T_BUSY);
+
+    port_run(&d);
+    CK(t_rwlock_write_unlock(&rw) == T_OK && h.ipc_status == T_OK);
+    CK(d.current_priority == 6 && t_list_isempty(&d.held_list));
+    CK(rw.u.rwlock.readers == 1 && t_list_isempty(&rw.wait_list));
+}
+
+static void test_cond(void)
+{
+    t_ipc_t m, cv;
+
+    port_run(&me);
+    CK(t_mutex_create_static_base(IPC_RECURSIVE_MUTEX, TO_IPC_FLAG_FIFO, &m) == T_OK);
+    CK(t_cond_create_static(TO_IPC_FLAG_FIFO, &cv) == T_OK);
+    CK(t_cond_wait(&cv, &m, 10) == T_ERR); /* not the owner */
+    CK(t_cond_wait(&cv, &cv, 10) == T_INVALID); /* not a mutex */
+    CK(t_mutex_recv_base(&m, 0) == T_OK && t_mutex_recv_base(&m, 0) == T_OK);
+    CK(m.u.sema.recursive == 2);
+    CK(t_cond_wait(&cv, &m, 0) == T_ERR);
+
+    /* the wait drops every recursion level and restores them */
+    signal_cv = &cv;
+    port_block_hook = cond_hook;
+    CK(t_cond_wait(&cv, &m, TO_WAITING_FOREVER) == T_OK);
+    port_block_hook = NULL;
+    CK(m.u.sema.holder == &me && m.u.sema.recursive == 2 && t_list_isempty(&cv.wait_list));
+
+    port_park(&cv, &a, TO_IPC_WAIT_RECV, NULL);
+    port_park(&cv, &b, TO_IPC_WAIT_RECV, NULL);
+    t_cond_signal(&cv);
+    CK(a.ipc_status == T_OK && b.ipc_status == T_BUSY);
+    port_park(&cv, &a, TO_IPC_WAIT_RECV, NULL);
+    t_cond_broadcast(&cv);
+    CK(a.ipc_status == T_OK && b.ipc_status == T_OK && t_list_isempty(&cv.wait_list));
+    CK(t_cond_signal(&m) == T_INVALID);
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&me, 5);
+    port_thread(&a, 6);
+    port_thread(&b, 6);
+    port_thread(&c, 6);
+    port_thread(&d, 6);
+    port_thread(&h, 8);
+
+    test_rwlock();
+    test_rwlock_boost();
+    test_rwlock_handoff();
+    test_cond();
+    return port_report("rwlock/cond");
+}
@@ -0,0 +1,103 @@
+/**
+ * @file test_stamp.c
+ * @brief Queue stamps: age-based drop and latency statistics
+ *        (built with TO_USING_QUEUE_STAMP).
+ */
+
+#include "port.h"
+
+static t_thread_t A, B;
+static t_ipc_t q;
+
+static void at(t_uint32_t tick)
+{
+    port_tick(tick - t_tick_get());
+}
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint32_t v = 55;
+
+    port_run(&B);
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    port_run(self);
+}
+
+int main(void)
+{
+    static t_uint32_t pool[4], ticks[4];
+    static t_queue_stamp_t st;
+    t_queue_stats_t s;
+    t_uint32_t v = 0, i, buf[4];
+    t_uint16_t got;
+    void *p;
+
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_run(&A);
+
+    CK(t_queue_create_static(pool, 4, 4, TO_IPC_FLAG_FIFO, &q) == T_OK);
+    CK(t_queue_stats_get(&q, &s) == T_INVALID);
+    v = 1;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    CK(t_queue_stamp_attach(&q, &st, ticks, 10) == T_BUSY); /* not empty */
+    CK(t_queue_recv(&q, &v, 0) == T_OK);
+    CK(t_queue_stamp_attach(&q, &st, ticks, 10) == T_OK);
+
+    at(100);
+    v = 1;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    at(103);
+    v = 2;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    at(105);
+    CK(t_queue_recv(&q, &v, 0) == T_OK && v == 1); /* latency 5 */
+    at(111);
+    v = 3;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    at(114);
+    CK(t_queue_recv(&q, &v, 0) == T_OK && v == 3); /* 2 expired at age 11; 3 took 3 */
+    CK(t_queue_stats_get(&q, &s) == T_OK);
+    CK(s.count == 2 && s.expired == 1 && s.min == 3 && s.max == 5 && s.sum == 8);
+    CK(s.hist[2] == 1 && s.hist[3] == 1);
+
+    /* everything expired reads as empty */
+    v = 4;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    at(200);
+    CK(t_queue_recv(&q, &v, 0) == T_ERR && q.msg_waiting == 0);
+
+    /* a direct handoff has latency 0 */
+    port_block_hook = block_hook;
+    CK(t_queue_recv(&q, &v, 10) == T_OK && v == 55);
+    port_block_hook = NULL;
+
+    /* batch, wrap, peek */
+    for (i = 0; i < 4; i++)
+        buf[i] = 10 + i;
+    CK(t_queue_send_n(&q, buf, 4, &got, 0) == T_OK && got == 4);
+    at(202);
+    CK(t_queue_peek(&q, &p, 0) == T_OK && *(t_uint32_t *)p == 10);
+    CK(t_queue_release(&q, p) == T_OK);
+    at(204);
+    CK(t_queue_recv_n(&q, buf, 4, 1, &got, 0) == T_OK && got == 3 && buf[0] == 11);
+    v = 9;
+    CK(t_queue_overwrite(&q, &v) == T_OK);
+    CK(t_queue_stats_get(&q, &s) == T_OK);
+    CK(s.count == 7 && s.expired == 2 && s.min == 0 && s.max == 5 && s.hist[0] == 1 && s.hist[11] == 0);
+    at(10000);
+    CK(t_queue_recv(&q, &v, 0) == T_ERR);
+    CK(t_queue_stats_get(&q, &s) == T_OK && s.expired == 3);
+    CK(t_queue_stats_reset(&q) == T_OK && t_queue_stats_get(&q, &s) == T_OK && s.count == 0);
+
+    /* no max_age: a long latency lands in the last bucket */
+    CK(t_queue_stamp_attach(&q, &st, ticks, 0) == T_OK);
+    v = 1;
+    CK(t_queue_send(&q, &v, 0) == T_OK);
+    at(20000);
+    CK(t_queue_recv(&q, &v, 0) == T_OK);
+    CK(t_queue_stats_get(&q, &s) == T_OK && s.hist[11] == 1 && s.max == 10000);
+    CK(t_queue_stamp_attach(&q, NULL, NULL, 0) == T_OK);
+    return port_report("queue stamp");
+}
@@ -0,0 +1,128 @@
+/**
+ * @file test_stream.c
+ * @brief Stream and message buffers: wrap, partial writes, framing, waits.
+ */
+
+#include "port.h"
+#include <string.h>
+
+static t_thread_t R, W;
+static t_stream_t sb;
+static t_stream_t *dyn;
+static int mode, hits;
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint8_t out3[4];
+    t_uint32_t n;
+
+    port_run(&W);
+    switch (mode)
+    {
+    case 1: /* below the trigger level: reader stays parked */
+        CK(t_stream_send(&sb, "ab", 2, &n, 0) == T_OK);
+        CK(TO_THREAD_SUSPEND == self->status);
+        CK(t_stream_send(&sb, "cdef", 4, &n, 0) == T_OK);
+        break;
+    case 2:
+        port_tick(20);
+        break;
+    case 3: /* the reader is woken, but the data is gone before it runs */
+        if (1 == ++hits)
+        {
+            port_tick(10);
+            CK(t_stream_send(&sb, "wxyz", 4, &n, 0) == T_OK && TO_THREAD_READY == self->status);
+            CK(t_stream_recv(&sb, out3, 4, &n, 0) == T_OK && n == 4);
+        }
+        else
+            port_tick(20);
+        break;
+    case 4: /* deleted and freed before the parked reader runs again */
+        CK(t_stream_delete(dyn) == T_OK);
+        break;
+    }
+    port_run(self);
+}
+
+static void test_bytes(void)
+{
+    t_uint8_t buf[16], out[32], in[10];
+    t_uint32_t n;
+    int r, i;
+
+    CK(t_stream_create_static(buf, 16, 4, TO_STREAM_BYTES, &sb) == T_OK);
+    CK(t_stream_recv(&sb, out, 8, &n, 0) == T_ERR && n == 0);
+    for (r = 0; r < 50; r++)
+    {
+        for (i = 0; i < 10; i++)
+            in[i] = r * 10 + i;
+        CK(t_stream_send(&sb, in, 10, &n, 0) == T_OK && n == 10);
+        CK(t_stream_available(&sb) == 10);
+        CK(t_stream_send(&sb, in, 10, &n, 0) == T_ERR && n == 5);
+        CK(t_stream_recv(&sb, out, 32, &n, 0) == T_OK && n == 15);
+        CK(!memcmp(out, in, 10) && !memcmp(out + 10, in, 5));
+    }
+
+    port_block_hook = block_hook;
+    mode = 1;
+    CK(t_stream_recv(&sb, out, 32, &n, 50) == T_OK && n == 6 && !memcmp(out, "abcdef", 6));
+    CK(!port_timer_armed(&R));
+    mode = 2;
+    CK(t_stream_recv(&sb, out, 32, &n, 20) == T_ERR && n == 0);
+    CK(t_tick_get() == 20 && NULL == sb.reader);
+    mode = 3; /* the re-block keeps the first deadline */
+    CK(t_stream_recv(&sb, out, 32, &n, 30) == T_ERR && n == 0);
+    CK(2 == hits && t_tick_get() == 50 && !port_timer_armed(&R));
+    port_block_hook = NULL;
+}
+
+static void test_messages(void)
+{
+    t_stream_t mb;
+    t_stream_t *d;
+    t_uint8_t mbuf[16], out[32];
+    t_uint32_t n;
+    int r;
+
+    CK(t_stream_create_static(mbuf, 16, 0, TO_STREAM_MESSAGE, &mb) == T_OK);
+    CK(t_stream_send(&mb, "abcdefghijklmn", 14, &n, 0) == T_INVALID);
+    for (r = 0; r < 30; r++)
+    {
+        CK(t_stream_send(&mb, "hello", 5, &n, 0) == T_OK);
+        CK(t_stream_send(&mb, "worlds", 6, &n, 0) == T_OK);
+        CK(t_stream_send(&mb, "x", 1, &n, 0) == T_ERR);
+        CK(t_stream_recv(&mb, out, 3, &n, 0) == T_INVALID && n == 5);
+        CK(t_stream_recv(&mb, out, 32, &n, 0) == T_OK && n == 5 && !memcmp(out, "hello", 5));
+        CK(t_stream_recv(&mb, out, 32, &n, 0) == T_OK && n == 6 && !memcmp(out, "worlds", 6));
+        CK(t_stream_recv(&mb, out, 32, &n, 0) == T_ERR);
+    }
+    CK(t_stream_create(8, 2, TO_STREAM_BYTES, &d) == T_OK);
+    CK(t_stream_delete(d) == T_OK);
+}
+
+static void test_delete(void)
+{
+    t_uint8_t out[8];
+    t_uint32_t n;
+
+    /* the woken reader must not read the freed buffer (ASan) */
+    CK(t_stream_create(8, 1, TO_STREAM_BYTES, &dyn) == T_OK);
+    port_block_hook = block_hook;
+    mode = 4;
+    CK(t_stream_recv(dyn, out, 8, &n, 50) == T_DELETED && n == 0);
+    CK(!port_timer_armed(&R));
+    port_block_hook = NULL;
+}
+
+int main(void)
+{
+    port_init();
+    port_thread(&R, 3);
+    port_thread(&W, 3);
+    port_run(&R);
+
+    test_bytes();
+    test_messages();
+    test_delete();
+    return port_report("stream");
+}
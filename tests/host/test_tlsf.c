@@ -0,0 +1,107 @@
+/**
+ * @file test_tlsf.c
+ * @brief TLSF allocator (mem_mang/mem2.c): random alloc/free against a
+ *        physical walk of the pool, coalescing, bad frees, default pool.
+ * @note Includes the allocator source to reach its block layout.
+ */
+
+#include "../../mem_mang/mem2.c"
+#include "port.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Walk the pool: no two adjacent free blocks, PREV_FREE flags agree,
+ * free bytes add up to the pool's counter. */
+static void check_pool(t_tlsf_pool_t *p)
+{
+    t_tlsf_block_t *b = (t_tlsf_block_t *)p->pool_start;
+    size_t free_sum = 0;
+    int prev_free = 0;
+
+    while ((t_uint8_t *)b < p->pool_end)
+    {
+        int is_free = BLOCK_IS_FREE(b) != 0;
+        CK(!(is_free && prev_free));
+        CK(((b->size & T_TLSF_PREV_FREE) != 0) == prev_free);
+        if (is_free)
+            free_sum += BLOCK_SIZE(b);
+        prev_free = is_free;
+        b = BLOCK_NEXT_PHYS(b);
+    }
+    CK((t_uint8_t *)b == p->pool_end && free_sum == p->available);
+}
+
+static t_uint8_t mem[70001], m2[300];
+static t_tlsf_pool_t pool, p2;
+
+int main(void)
+{
+    void *ptr[200] = {0}, *a, *all;
+    size_t sz[200], full;
+    int i, k;
+
+    port_init();
+    CK(t_tlsf_pool_create(&pool, mem + 1, sizeof(mem) - 1) == T_OK); /* odd start */
+    check_pool(&pool);
+    full = t_tlsf_pool_available(&pool);
+    CK(t_tlsf_pool_alloc(&pool, 0) == NULL && t_tlsf_pool_alloc(&pool, full + 1) == NULL);
+
+    srand(1);
+    for (k = 0; k < 200000; k++)
+    {
+        i = rand() % 200;
+        if (ptr[i])
+        {
+            CK(((t_uint8_t *)ptr[i])[0] == (t_uint8_t)i && ((t_uint8_t *)ptr[i])[sz[i] - 1] == (t_uint8_t)i);
+            CK(t_tlsf_pool_free(&pool, ptr[i]) == T_OK);
+            ptr[i] = NULL;
+        }
+        else
+        {
+            sz[i] = (rand() % 4 == 0) ? 1 + rand() % 4000 : 1 + rand() % 100;
+            ptr[i] = t_tlsf_pool_alloc(&pool, sz[i]);
+            if (ptr[i])
+            {
+                CK(((size_t)ptr[i] & T_BYTE_ALIGN_MASK) == 0);
+                memset(ptr[i], i, sz[i]);
+            }
+        }
+        if (k % 997 == 0)
+            check_pool(&pool);
+    }
+    for (i = 0; i < 200; i++)
+        if (ptr[i])
+            CK(t_tlsf_pool_free(&pool, ptr[i]) == T_OK);
+    check_pool(&pool);
+    CK(t_tlsf_pool_available(&pool) == full);
+
+    /* back to one free block: more than half of it fits in one piece */
+    all = t_tlsf_pool_alloc(&pool, full / 2 + 1);
+    CK(all != NULL && t_tlsf_pool_free(&pool, all) == T_OK);
+
+    a = t_tlsf_pool_alloc(&pool, 100);
+    CK(a && t_tlsf_pool_free(&pool, a) == T_OK && t_tlsf_pool_free(&pool, a) == T_INVALID);
+    CK(t_tlsf_pool_free(&pool, m2 + 16) == T_INVALID);
+
+    /* b merges into the free a before it: its second free is still caught */
+    a = t_tlsf_pool_alloc(&pool, 100);
+    ptr[0] = t_tlsf_pool_alloc(&pool, 100);
+    ptr[1] = t_tlsf_pool_alloc(&pool, 100);
+    CK(a && ptr[0] && ptr[1]);
+    CK(t_tlsf_pool_free(&pool, a) == T_OK && t_tlsf_pool_free(&pool, ptr[0]) == T_OK);
+    CK(t_tlsf_pool_free(&pool, ptr[0]) == T_INVALID);
+    check_pool(&pool);
+    CK(t_tlsf_pool_free(&pool, ptr[1]) == T_OK && t_tlsf_pool_available(&pool) == full);
+    CK(t_tlsf_pool_create(&p2, m2, sizeof(m2)) == T_OK);
+    a = t_tlsf_pool_alloc(&p2, 200);
+    CK(a && t_tlsf_pool_free(&pool, a) == T_INVALID && t_tlsf_pool_free(&p2, a) == T_OK);
+    CK(t_tlsf_pool_create(&p2, m2, 20) == T_INVALID);
+    CK(t_tlsf_pool_delete(&p2) == T_OK && t_tlsf_pool_alloc(&p2, 8) == NULL);
+
+    /* default pool behind t_malloc / t_free */
+    a = t_malloc(64);
+    CK(a && t_get_free_mem_size() < TO_DYNAMIC_MEM_SIZE);
+    t_free(a);
+    CK(t_get_free_mem_size() == TO_DYNAMIC_MEM_SIZE - 2 * T_TLSF_HEADER_SIZE);
+    return port_report("tlsf");
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_topic.c
+ * @brief Latest-value topics: per-subscriber generations, wake all readers.
+ */
+
+#include "port.h"
+
+static t_thread_t A, B, C;
+static t_ipc_t tp;
+static int mode;
+
+static void block_hook(t_thread_t *self)
+{
+    t_uint32_t v[2] = {7, 8};
+
+    port_run(&C);
+    switch (mode)
+    {
+    case 1: /* B waits on the topic too: one publish wakes both, one switch */
+        port_park(&tp, &B, TO_IPC_WAIT_RECV, NULL);
+        port_switch_calls = 0;
+        CK(t_topic_publish(&tp, v) == T_OK && port_switch_calls == 1);
+        CK(t_list_isempty(&tp.wait_list) && B.status == TO_THREAD_READY && B.ipc_status == T_BUSY);
+        break;
+    case 2:
+        port_tick(10);
+        break;
+    }
+    port_run(self);
+}
+
+int main(void)
+{
+    static t_uint32_t sample[2];
+    static t_topic_sub_t sa, sb;
+    t_uint32_t v[2] = {0, 0}, d[2];
+    t_uint8_t w = 0;
+    t_ipc_t *dy;
+
+    port_init();
+    port_thread(&A, 3);
+    port_thread(&B, 3);
+    port_thread(&C, 3);
+    port_run(&A);
+    port_block_hook = block_hook;
+
+    CK(T_TOPIC_CREATE_STATIC(sample, 8, &tp) == T_OK);
+    CK(t_topic_subscribe(&tp, &sa) == T_OK && t_topic_subscribe(&tp, &sb) == T_OK);
+    CK(t_topic_read(&sa, d, 0) == T_ERR);
+    v[0] = 1;
+    CK(t_topic_publish(&tp, v) == T_OK);
+    v[0] = 2;
+    CK(t_topic_publish_isr(&tp, v, &w) == T_OK && w == 0);
+    CK(t_topic_read(&sa, d, 0) == T_OK && d[0] == 2);
+    CK(t_topic_read(&sa, d, 0) == T_ERR);
+    CK(t_topic_read(&sb, d, 0) == T_OK && d[0] == 2);
+    mode = 1;
+    CK(t_topic_read(&sa, d, 10) == T_OK && d[0] == 7 && d[1] == 8);
+    mode = 2;
+    CK(t_topic_read(&sa, d, 10) == T_ERR && t_list_isempty(&tp.wait_list));
+    CK(t_topic_read(&sb, d, 0) == T_OK && d[0] == 7);
+
+    /* generation 0 means "never read": the counter skips it on wrap */
+    tp.u.topic.generation = 0xFFFFFFFF;
+    CK(t_topic_publish(&tp, v) == T_OK && tp.u.topic.generation == 1);
+
+    CK(T_TOPIC_CREATE(3, &dy) == T_OK);
+    CK(t_topic_publish(dy, "ab") == T_OK && t_ipc_delete(dy) == T_OK);
+    CK(t_ipc_delete(&tp) == T_OK);
+    CK(t_topic_read(&sa, d, 0) == T_DELETED && t_topic_publish(&tp, v) == T_DELETED);
+    return port_report("topic");
+}
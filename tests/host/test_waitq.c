@@ -0,0 +1,93 @@
+/**
+ * @file test_waitq.c
+ * @brief PRIO wait queues stay sorted, FIFO within a priority, under
+ *        random suspend / requeue / unlink; with the bitmap build the
+ *        per-priority heads and group mask must agree with the list.
+ *        The per-direction waiter counts must match the list in both.
+ */
+
+#include "port.h"
+#include <stdlib.h>
+
+#define N 32
+
+static t_thread_t th[N];
+static int seq[N];
+
+static void verify(t_ipc_t *q)
+{
+    t_list_t *p;
+    t_thread_t *prev = NULL;
+    t_uint32_t group = 0;
+    t_uint16_t count[2] = {0, 0};
+
+    for (p = q->wait_list.next; p != &q->wait_list; p = p->next)
+    {
+        t_thread_t *t = T_LIST_ENTRY(p, t_thread_t, tlist);
+        if (prev)
+        {
+            CK(!T_PRIO_HIGHER(t->current_priority, prev->current_priority));
+            if (prev->current_priority == t->current_priority)
+                CK(seq[prev - th] < seq[t - th]);
+        }
+#if (TO_USING_IPC_PRIO_BITMAP)
+        if (!(group & (1UL << t->current_priority)))
+            CK(q->prio_head[t->current_priority] == p);
+#endif
+        group |= 1UL << t->current_priority;
+        count[t->ipc_flag]++;
+        prev = t;
+    }
+    CK(count[TO_IPC_WAIT_RECV] == q->wait_count[TO_IPC_WAIT_RECV]);
+    CK(count[TO_IPC_WAIT_SEND] == q->wait_count[TO_IPC_WAIT_SEND]);
+#if (TO_USING_IPC_PRIO_BITMAP)
+    CK(group == q->prio_group);
+#endif
+}
+
+int main(void)
+{
+    t_ipc_t q;
+    int i, k, s = 0;
+
+    port_init();
+    for (i = 0; i < N; i++)
+        port_thread(&th[i], 0);
+    srand(7);
+
+    for (k = 0; k < 200; k++)
+    {
+        t_sema_create_static(0xFF, 0, TO_IPC_FLAG_PRIO, &q);
+        for (i = 0; i < N; i++)
+        {
+            th[i].current_priority = rand() % 6 * 5;
+            seq[i] = s++;
+            port_park(&q, &th[i], i & 1 ? TO_IPC_WAIT_SEND : TO_IPC_WAIT_RECV, NULL);
+            verify(&q);
+        }
+        for (i = 0; i < N; i++)
+        {
+            int j = rand() % N;
+            if (!th[j].pend_on)
+                continue;
+            if (rand() % 2)
+            {
+                t_ipc_requeue(&th[j], rand() % TO_THREAD_PRIORITY_MAX);
+                seq[j] = s++;
+            }
+            else
+            {
+                t_ipc_unlink(&th[j]);
+                CK(NULL == th[j].pend_on);
+            }
+            verify(&q);
+        }
+        while (!t_list_isempty(&q.wait_list))
+            t_ipc_unlink(T_LIST_ENTRY(q.wait_list.next, t_thread_t, tlist));
+        CK(0 == q.wait_count[TO_IPC_WAIT_RECV] && 0 == q.wait_count[TO_IPC_WAIT_SEND]);
+#if (TO_USING_IPC_PRIO_BITMAP)
+        CK(0 == q.prio_group);
+#endif
+    }
+    return port_report("wait queue");
+}